@@ -103,6 +103,7 @@ SOURCES += \
     io/dat_io.cpp \
     io/dmp_io.cpp \
     io/export_io.cpp \
+    io/export_sink.cpp \
     io/ff_io.cpp \
     io/ins_io.cpp \
     io/io_utils.cpp \
@@ -123,14 +124,18 @@ SOURCES += \
     main.cpp \
     gui/mainwindow.cpp \
     chip/chip.cpp \
+    chip/mix_kernel.cpp \
     chip/opna.cpp \
     chip/resampler.cpp \
     chip/nuked/ym3438.c \
     bamboo_tracker.cpp \
+    batch_exporter.cpp \
     module/effect.cpp \
     note.cpp \
     playback.cpp \
     song_length_calculator.cpp \
+    stem_renderer.cpp \
+    worker_pool.cpp \
     audio/audio_stream.cpp \
     instrument/instruments_manager.cpp \
     command/command_manager.cpp \
@@ -149,6 +154,7 @@ SOURCES += \
     instrument/envelope_fm.cpp \
     gui/event_guard.cpp \
     audio/audio_stream_rtaudio.cpp \
+    audio/quality_governor.cpp \
     tick_counter.cpp \
     module/module.cpp \
     module/song.cpp \
@@ -290,9 +296,12 @@ HEADERS += \
     gui/mainwindow.hpp \
     chip/nuked/ym3438.h \
     chip/chip.hpp \
+    chip/mix_kernel.hpp \
     chip/opna.hpp \
+    chip/register_write_ring.hpp \
     chip/resampler.hpp \
     bamboo_tracker.hpp \
+    batch_exporter.hpp \
     gui/note_name_manager.hpp \
     gui/swap_tracks_dialog.hpp \
     gui/transpose_song_dialog.hpp \
@@ -307,6 +316,7 @@ HEADERS += \
     io/dat_io.hpp \
     io/dmp_io.hpp \
     io/export_io.hpp \
+    io/export_sink.hpp \
     io/ff_io.hpp \
     io/ins_io.hpp \
     io/io_file_type.hpp \
@@ -329,6 +339,8 @@ HEADERS += \
     note.hpp \
     playback.hpp \
     song_length_calculator.hpp \
+    stem_renderer.hpp \
+    worker_pool.hpp \
     audio/audio_stream.hpp \
     instrument/instruments_manager.hpp \
     command/command_manager.hpp \
@@ -348,6 +360,8 @@ HEADERS += \
     instrument/envelope_fm.hpp \
     gui/event_guard.hpp \
     audio/audio_stream_rtaudio.hpp \
+    audio/quality_governor.hpp \
+    audio/render_ahead_buffer.hpp \
     tick_counter.hpp \
     module/module.hpp \
     module/song.hpp \
@@ -25,19 +25,48 @@
 
 #include "audio_stream.hpp"
 #include <algorithm>
+#include <thread>
 
 const std::string AudioStream::AUDIO_OUT_CLIENT_NAME = "BambooTracker";
 
+namespace
+{
+// The output publishes ticks without locking, so a tick is stored as a single word
+uint64_t packTick(const AudioStream::Tick& tick)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(tick.state)) << 32)
+			| (static_cast<uint64_t>(static_cast<uint16_t>(tick.order)) << 16)
+			| static_cast<uint16_t>(tick.step);
+}
+
+AudioStream::Tick unpackTick(uint64_t packed)
+{
+	return { static_cast<int32_t>(packed >> 32),
+			 static_cast<int16_t>((packed >> 16) & 0xffff),
+			 static_cast<int16_t>(packed & 0xffff) };
+}
+}
+
 AudioStream::AudioStream(QObject *parent)
 	: QObject(parent),
 	  rate_(0),
 	  intrRate_(0),
-	  intrCount_(0),
 	  intrCountRest_(0),
-	  gcb_(nullptr),
-	  gcbPtr_(nullptr),
-	  tuState_(-1),
-	  started_(false),
+	  state_(new CallbackState{ nullptr, nullptr, nullptr, nullptr, false, 0, false }),
+	  activeCallbacks_(0),
+	  isUpdating_(false),
+	  avoidedDropoutCount_(0),
+	  tuTick_(packTick({ -1, -1, -1 })),
+	  busyTime_(0),
+	  generatedTime_(0),
+	  peakLoad_(0),
+	  renderAheadLength_(0),
+	  skipPosition_(0),
+	  lastRequestFrames_(0),
+	  renderAheadUnderrunCount_(0),
+	  renderTuState_(-1),
+	  hasRenderError_(false),
+	  quitRender_(false),
 	  quitNotify_(false),
 	  tickNotifier_([this]() { tickNotifierRun(); })
 {
@@ -45,23 +74,48 @@ AudioStream::AudioStream(QObject *parent)
 
 AudioStream::~AudioStream()
 {
+	stopRenderer();
 	quitNotify_.store(true);
 	tickNotifierSem_.release();
 	tickNotifier_.join();
+	delete state_.load();
 }
 
-void AudioStream::setGenerateCallback(GenerateCallback* cb, void* cbPtr)
+/**
+ * @brief Publish a modified copy of the callback state.
+ *
+ * The previous state is freed after the callbacks using it have returned,
+ * so no callback is running with the old settings when this function returns.
+ */
+template <class Modifier>
+void AudioStream::updateState(Modifier modify)
 {
 	std::lock_guard<std::mutex> lock(mutex_);
-	gcb_ = cb;
-	gcbPtr_ = cbPtr;
+	isUpdating_.store(true);
+
+	auto state = new CallbackState(*state_.load());
+	modify(*state);
+	CallbackState* old = state_.exchange(state);
+	while (activeCallbacks_.load()) std::this_thread::yield();
+	delete old;
+
+	isUpdating_.store(false);
+}
+
+void AudioStream::setGenerateCallback(GenerateCallback* cb, void* cbPtr)
+{
+	updateState([&](CallbackState& state) {
+		state.gcb = cb;
+		state.gcbPtr = cbPtr;
+	});
 }
 
 void AudioStream::setTickUpdateCallback(TickUpdateCallback* cb, void* cbPtr)
 {
-	std::lock_guard<std::mutex> lock(mutex_);
-	tucb_ = cb;
-	tucbPtr_ = cbPtr;
+	updateState([&](CallbackState& state) {
+		state.tucb = cb;
+		state.tucbPtr = cbPtr;
+	});
 }
 
 bool AudioStream::initialize(uint32_t rate, uint32_t duration, uint32_t intrRate,
@@ -72,17 +126,20 @@ bool AudioStream::initialize(uint32_t rate, uint32_t duration, uint32_t intrRate
 	Q_UNUSED(device)
 	Q_UNUSED(errDetail)
 
-	started_ = false;
 	rate_ = rate;
-	setInterruption(intrRate);
+	intrRate_ = intrRate;
+	updateState([&](CallbackState& state) {
+		state.started = false;
+		state.intrCount = rate_ / intrRate_;
+	});
+	resetRenderer();
 	return true;
 }
 
 void AudioStream::setInterruption(uint32_t intrRate)
 {
-	std::lock_guard<std::mutex> lock(mutex_);
 	intrRate_ = intrRate;
-	intrCount_ = rate_ / intrRate_;
+	updateState([&](CallbackState& state) { state.intrCount = rate_ / intrRate_; });
 }
 
 uint32_t AudioStream::getStreamRate() const noexcept
@@ -92,41 +149,169 @@ uint32_t AudioStream::getStreamRate() const noexcept
 
 void AudioStream::start()
 {
-	std::lock_guard<std::mutex> lock(mutex_);
-	started_ = true;
+	updateState([](CallbackState& state) { state.started = true; });
 }
 
 void AudioStream::stop()
 {
-	std::lock_guard<std::mutex> lock(mutex_);
-	started_ = false;
+	updateState([](CallbackState& state) { state.started = false; });
 }
 
-bool AudioStream::generate(int16_t* container, uint32_t nSamples)
+uint64_t AudioStream::getAvoidedDropoutCount() const noexcept
+{
+	return avoidedDropoutCount_.load();
+}
+
+uint64_t AudioStream::getRenderAheadUnderrunCount() const noexcept
+{
+	return renderAheadUnderrunCount_.load();
+}
+
+void AudioStream::skipRenderedAhead()
+{
+	// The audio callback is the consumer of the buffer, so it drops the samples on the next call
+	if (renderer_.joinable()) skipPosition_.store(renderAheadBuf_.getWritePosition());
+}
+
+AudioStream::Load AudioStream::takeLoad()
+{
+	uint64_t busy = busyTime_.exchange(0);
+	uint64_t generated = generatedTime_.exchange(0);
+	uint32_t peak = peakLoad_.exchange(0);
+	return { generated ? static_cast<double>(busy) / generated : 0., peak / 1000. };
+}
+
+void AudioStream::measureLoad(std::chrono::steady_clock::time_point start, size_t nSamples)
+{
+	if (!nSamples || !rate_) return;
+	auto busy = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+										  std::chrono::steady_clock::now() - start).count());
+	uint64_t generated = static_cast<uint64_t>(nSamples) * 1000000000u / rate_;
+	busyTime_.fetch_add(busy, std::memory_order_relaxed);
+	generatedTime_.fetch_add(generated, std::memory_order_relaxed);
+
+	auto load = static_cast<uint32_t>(busy * 1000 / generated);
+	uint32_t peak = peakLoad_.load(std::memory_order_relaxed);
+	while (load > peak && !peakLoad_.compare_exchange_weak(peak, load, std::memory_order_relaxed)) {}
+}
+
+void AudioStream::setRenderAheadLength(uint32_t length)
+{
+	renderAheadLength_ = length;
+	resetRenderer();
+}
+
+/**
+ * @brief Stop the render thread and start it again with the current settings.
+ *
+ * The render thread and the direct generation in the audio callback never run at the same time:
+ * the thread is started after the callbacks switched to reading the buffer,
+ * and the callbacks switch back after the thread is joined.
+ */
+void AudioStream::resetRenderer()
+{
+	stopRenderer();
+	updateState([](CallbackState& state) { state.renderAhead = false; });
+	skipPosition_.store(0);
+	if (!renderAheadLength_ || !rate_) return;
+
+	renderAheadBuf_.reset(static_cast<size_t>(rate_) * renderAheadLength_ / 1000);
+	renderTuState_ = unpackTick(tuTick_.load()).state;
+	hasRenderError_ = false;
+	updateState([](CallbackState& state) { state.renderAhead = true; });
+	quitRender_.store(false);
+	renderer_ = std::thread([this]() { renderAheadRun(); });
+}
+
+void AudioStream::stopRenderer()
+{
+	if (!renderer_.joinable()) return;
+	quitRender_.store(true);
+	renderSem_.release();
+	renderer_.join();
+}
+
+void AudioStream::renderAheadRun()
+{
+	while (!quitRender_.load()) {
+		if (!renderAhead()) renderSem_.tryAcquire(1, 5);
+	}
+}
+
+/// [Return] Number of rendered frames
+size_t AudioStream::renderAhead()
 {
-	GenerateCallback* gcb = nullptr;
-	void* gcbPtr = nullptr;
-	TickUpdateCallback* tucb = nullptr;
-	bool started = false;
-
-	std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
-	if (lock.owns_lock()) {
-		gcb = gcb_;
-		gcbPtr = gcbPtr_;
-		tucb = tucb_;
-		started = started_;
+	CallbackGuard guard(activeCallbacks_);
+	const CallbackState& state = *state_.load();
+	if (!state.gcb || !state.tucb || !state.started || !state.renderAhead) return 0;
+
+	// While the song is stopped, keep only two callbacks ahead
+	// so that jam input is heard as soon as without render-ahead
+	size_t target = renderAheadBuf_.getCapacity();
+	if (renderTuState_ < 0) target = std::min(target, static_cast<size_t>(lastRequestFrames_.load()) << 1);
+	size_t readable = renderAheadBuf_.getReadableFrames();
+	if (readable >= target) return 0;
+
+	auto start = std::chrono::steady_clock::now();
+	if (!intrCountRest_) {	// Interruption
+		if (renderAheadBuf_.isTickQueueFull()) return 0;
+		intrCountRest_ = state.intrCount;
+		Tick tick = state.tucb(state.tucbPtr);
+		renderTuState_ = tick.state;
+		renderAheadBuf_.pushTick(tick);
+	}
+
+	size_t count = std::min(static_cast<size_t>(intrCountRest_), target - readable);
+	renderBuf_.resize(count << 1);
+	if (!state.gcb(renderBuf_.data(), count, state.gcbPtr)) {
+		// Something went wrong in sample generation callback. It is retried, so report it only once
+		if (!hasRenderError_) emit streamErrorInCallback(QVariant());
+		hasRenderError_ = true;
+		return 0;
 	}
+	hasRenderError_ = false;
+	measureLoad(start, count);
+	intrCountRest_ -= count;
+	renderAheadBuf_.write(renderBuf_.data(), count);
+
+	return count;
+}
+
+bool AudioStream::generate(int16_t* container, uint32_t nSamples)
+{
+	CallbackGuard guard(activeCallbacks_);
+
+	if (isUpdating_.load()) avoidedDropoutCount_.fetch_add(1, std::memory_order_relaxed);
+	const CallbackState& state = *state_.load();
+	GenerateCallback* gcb = state.gcb;
+	void* gcbPtr = state.gcbPtr;
 
-	if (!gcb || !tucb || !started) {
+	if (!gcb || !state.tucb || !state.started) {
+		if (state.renderAhead) renderAheadBuf_.discard();
 		std::fill(container, container + (nSamples << 1), 0);
 		return true;
 	}
 
+	if (state.renderAhead) {	// Only copy samples rendered by the render thread
+		auto publish = [this](const Tick& tick) { publishTick(tick); };
+		if (uint64_t skipPos = skipPosition_.exchange(0)) renderAheadBuf_.skip(skipPos, publish);
+		lastRequestFrames_.store(nSamples, std::memory_order_relaxed);
+		size_t count = renderAheadBuf_.read(container, nSamples, publish);
+		if (count < nSamples) {
+			std::fill(container + (count << 1), container + (nSamples << 1), 0);
+			renderAheadUnderrunCount_.fetch_add(1, std::memory_order_relaxed);
+		}
+		renderSem_.release();
+		return true;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	const uint32_t nRequested = nSamples;
 	int16_t* destPtr = container;
 	while (nSamples) {
 		if (!intrCountRest_) {	// Interruption
-			intrCountRest_ = intrCount_;    // Set counts to next interruption
-			generateTick();
+			intrCountRest_ = state.intrCount;    // Set counts to next interruption
+			generateTick(state);
 		}
 
 		size_t count = std::min(intrCountRest_, nSamples);
@@ -142,13 +327,19 @@ bool AudioStream::generate(int16_t* container, uint32_t nSamples)
 
 		destPtr += (count << 1);	// Move head
 	}
+	measureLoad(start, nRequested);
 
 	return true;
 }
 
-void AudioStream::generateTick()
+void AudioStream::generateTick(const CallbackState& state)
+{
+	publishTick(state.tucb(state.tucbPtr));
+}
+
+void AudioStream::publishTick(const Tick& tick)
 {
-	tuState_.store(tucb_(tucbPtr_));
+	tuTick_.store(packTick(tick));
 	tickNotifierSem_.release();
 }
 
@@ -159,6 +350,7 @@ void AudioStream::tickNotifierRun()
 
 		if (quitNotify_.load()) return;
 
-		emit streamInterrupted(tuState_.load());
+		Tick tick = unpackTick(tuTick_.load());
+		emit streamInterrupted(tick.state, tick.order, tick.step);
 	}
 }
@@ -31,9 +31,11 @@
 #include <memory>
 #include <atomic>
 #include <cstdint>
+#include <chrono>
 #include <QSemaphore>
 #include <QString>
 #include <QVariant>
+#include "render_ahead_buffer.hpp"
 
 class AudioStream : public QObject
 {
@@ -46,7 +48,13 @@ public:
 	using GenerateCallback = bool (int16_t*, size_t, void*);
 	void setGenerateCallback(GenerateCallback* cb, void* cbPtr);
 
-	using TickUpdateCallback = int (void*);
+	/// State returned by the tick callback with the playback position reached by the tick.
+	struct Tick
+	{
+		int state;
+		int order, step;	// -1 if stopped
+	};
+	using TickUpdateCallback = Tick (void*);
 	void setTickUpdateCallback(TickUpdateCallback* cb, void* cbPtr);
 
 	// duration: miliseconds
@@ -68,8 +76,31 @@ public:
 	virtual void start();
 	virtual void stop();
 
+	/// Render samples on a dedicated thread up to the given length ahead of playback.
+	/// length: miliseconds, 0 disables it
+	void setRenderAheadLength(uint32_t length);
+	/// Number of callbacks which found the render-ahead buffer short of samples.
+	uint64_t getRenderAheadUnderrunCount() const noexcept;
+	/// Drop the samples rendered ahead so far, so that changes made before this call,
+	/// such as starting or stopping the song, are heard from the next callback.
+	/// The ticks in them are still reported.
+	void skipRenderedAhead();
+
+	/// Number of callbacks which ran while the settings were being changed.
+	/// They used to output silence instead of samples.
+	uint64_t getAvoidedDropoutCount() const noexcept;
+
+	/// Time spent in sample generation relative to the duration of the generated samples.
+	struct Load
+	{
+		double average;
+		double peak;	// Worst single callback or render
+	};
+	/// Return the load since the previous call and start a new measurement.
+	Load takeLoad();
+
 signals:
-	void streamInterrupted(int state);
+	void streamInterrupted(int state, int order, int step);
 	void streamErrorInCallback(const QVariant& data);
 
 protected:
@@ -79,22 +110,66 @@ protected:
 private:
 	uint32_t rate_;
 	uint32_t intrRate_;
-	uint32_t intrCount_;
 	uint32_t intrCountRest_;
 
-	std::mutex mutex_;
-	GenerateCallback* gcb_;
-	void* gcbPtr_;
-	TickUpdateCallback* tucb_;
-	void* tucbPtr_;
-	std::atomic_int tuState_;
-	bool started_;
+	// Settings read by the audio callback.
+	// They are replaced as a whole so that the callback never waits for a lock.
+	struct CallbackState
+	{
+		GenerateCallback* gcb;
+		void* gcbPtr;
+		TickUpdateCallback* tucb;
+		void* tucbPtr;
+		bool started;
+		uint32_t intrCount;
+		bool renderAhead;
+	};
+	std::mutex mutex_;	// Serializes updates of the state
+	std::atomic<CallbackState*> state_;
+	std::atomic_int activeCallbacks_;
+	std::atomic_bool isUpdating_;
+	std::atomic<uint64_t> avoidedDropoutCount_;
+	std::atomic<uint64_t> tuTick_;	// Last tick reached by the output, packed into a word
+
+	// Load measurement, nanoseconds
+	std::atomic<uint64_t> busyTime_, generatedTime_;
+	std::atomic<uint32_t> peakLoad_;	// Permille
+	void measureLoad(std::chrono::steady_clock::time_point start, size_t nSamples);
+
+	template <class Modifier>
+	void updateState(Modifier modify);
+
+	struct CallbackGuard
+	{
+		std::atomic_int& count;
+		explicit CallbackGuard(std::atomic_int& c) : count(c) { ++count; }
+		~CallbackGuard() { --count; }
+	};
+
+	// Render-ahead
+	uint32_t renderAheadLength_;
+	RenderAheadBuffer<Tick> renderAheadBuf_;
+	std::atomic<uint64_t> skipPosition_;	// 0: no request
+	std::atomic<uint32_t> lastRequestFrames_;
+	std::atomic<uint64_t> renderAheadUnderrunCount_;
+	int renderTuState_;
+	bool hasRenderError_;	// Reported once until rendering succeeds again
+	std::vector<int16_t> renderBuf_;
+	std::atomic_bool quitRender_;
+	QSemaphore renderSem_;
+	std::thread renderer_;
+
+	void resetRenderer();
+	void stopRenderer();
+	void renderAheadRun();
+	size_t renderAhead();
 
 	std::atomic_bool quitNotify_;
 	QSemaphore tickNotifierSem_;
 	std::thread tickNotifier_;
 
-	void generateTick();
+	void generateTick(const CallbackState& state);
+	void publishTick(const Tick& tick);
 
 	void tickNotifierRun();
 };
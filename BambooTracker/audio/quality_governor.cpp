@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "quality_governor.hpp"
+#include <algorithm>
+
+namespace
+{
+// Load above which quality is stepped down, and below which it is stepped up
+constexpr double HIGH_LOAD = 0.8;
+constexpr double LOW_LOAD = 0.45;
+// Number of consecutive measurements needed to change the level
+constexpr int HIGH_COUNT = 2;
+constexpr int LOW_COUNT = 10;
+constexpr int MAX_LOW_COUNT = 320;
+
+bool isCheaperThanFastBlipBuf(chip::ResamplerType type)
+{
+	return type == chip::ResamplerType::Linear || type == chip::ResamplerType::FastBlipBuf
+			|| type == chip::ResamplerType::SincFast;
+}
+}
+
+QualityGovernor::QualityGovernor(unsigned int nCores)
+	: nCores_(nCores),
+	  ladder_(1, { chip::ResamplerType::BlipBuf, false, chip::YmfmFidelity::Maximum, 0 }),
+	  level_(0),
+	  highCount_(0),
+	  lowCount_(0),
+	  lowCountNeeded_(LOW_COUNT),
+	  sinceChange_(0),
+	  wasSteppedUp_(false),
+	  lastLoad_(0)
+{
+}
+
+void QualityGovernor::setBaseSettings(const Settings& settings, bool canReduceFidelity)
+{
+	ladder_.assign(1, settings);
+	Settings s = settings;
+
+	if (!isCheaperThanFastBlipBuf(s.resampler)) {
+		s.resampler = chip::ResamplerType::FastBlipBuf;
+		ladder_.push_back(s);
+	}
+	if (!s.ssgPipeline && nCores_ > 1) {
+		s.ssgPipeline = true;
+		ladder_.push_back(s);
+	}
+	// Lower ymfm fidelity generates fewer SSG samples, at the cost of SSG treble
+	if (canReduceFidelity) {
+		for (auto fidelity : { chip::YmfmFidelity::Medium, chip::YmfmFidelity::Minimum }) {
+			if (s.fidelity < fidelity) {
+				s.fidelity = fidelity;
+				ladder_.push_back(s);
+			}
+		}
+	}
+	// Render-ahead is kept as configured. Resizing it restarts the render thread
+	// and drops the samples already rendered, which is the dropout this tries to avoid
+
+	level_ = 0;
+	highCount_ = 0;
+	lowCount_ = 0;
+	lowCountNeeded_ = LOW_COUNT;
+	sinceChange_ = 0;
+	wasSteppedUp_ = false;
+}
+
+bool QualityGovernor::update(double average, double peak)
+{
+	// A render-ahead buffer absorbs single slow buffers, so only the average matters then
+	lastLoad_ = getSettings().renderAheadLength ? average : std::max(average, peak);
+	++sinceChange_;
+
+	if (lastLoad_ > HIGH_LOAD) {
+		lowCount_ = 0;
+		if (++highCount_ >= HIGH_COUNT && level_ + 1 < ladder_.size()) {
+			// Wait longer before the next try if the restored level was too heavy
+			if (wasSteppedUp_ && sinceChange_ <= LOW_COUNT) {
+				lowCountNeeded_ = std::min(lowCountNeeded_ * 2, MAX_LOW_COUNT);
+			}
+			++level_;
+			highCount_ = 0;
+			sinceChange_ = 0;
+			wasSteppedUp_ = false;
+			return true;
+		}
+	}
+	else if (lastLoad_ < LOW_LOAD) {
+		highCount_ = 0;
+		if (++lowCount_ >= lowCountNeeded_ && level_ > 0) {
+			--level_;
+			lowCount_ = 0;
+			sinceChange_ = 0;
+			wasSteppedUp_ = true;
+			return true;
+		}
+	}
+	else {
+		highCount_ = 0;
+		lowCount_ = 0;
+	}
+	return false;
+}
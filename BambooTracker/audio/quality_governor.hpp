@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "chip/resampler.hpp"
+#include "chip/opna.hpp"
+
+/**
+ * @brief Steps playback settings down to cheaper ones while the audio load is high,
+ *        and back up to the configured ones when it drops.
+ */
+class QualityGovernor
+{
+public:
+	struct Settings
+	{
+		chip::ResamplerType resampler;
+		bool ssgPipeline;
+		chip::YmfmFidelity fidelity;	// Never Auto
+		uint32_t renderAheadLength;	// Miliseconds, 0 is disabled. Same at all levels
+
+		bool operator==(const Settings& other) const noexcept
+		{
+			return resampler == other.resampler && ssgPipeline == other.ssgPipeline
+					&& fidelity == other.fidelity && renderAheadLength == other.renderAheadLength;
+		}
+		bool operator!=(const Settings& other) const noexcept { return !(*this == other); }
+	};
+
+	explicit QualityGovernor(unsigned int nCores);
+
+	/**
+	 * @brief Set the configured settings, which are the top level.
+	 * @param canReduceFidelity true if the chip can change ymfm fidelity while playing.
+	 */
+	void setBaseSettings(const Settings& settings, bool canReduceFidelity);
+
+	/**
+	 * @brief Feed the load measured since the previous call.
+	 * @param average Time spent generating relative to the generated duration.
+	 * @param peak Worst single buffer in the same unit.
+	 * @return true if the level changed.
+	 */
+	bool update(double average, double peak);
+
+	const Settings& getSettings() const { return ladder_.at(level_); }
+	size_t getLevel() const noexcept { return level_; }
+	size_t getLevelCount() const noexcept { return ladder_.size(); }
+	double getLastLoad() const noexcept { return lastLoad_; }
+
+private:
+	const unsigned int nCores_;
+	std::vector<Settings> ladder_;	// From the configured settings to the cheapest
+	size_t level_;
+	int highCount_, lowCount_;
+	int lowCountNeeded_;	// Grows when restored quality could not be kept
+	int sinceChange_;
+	bool wasSteppedUp_;
+	double lastLoad_;
+};
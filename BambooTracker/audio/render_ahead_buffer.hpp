@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Single-producer single-consumer FIFO of stereo samples rendered ahead of playback.
+ *
+ * Tick notifications are queued with the position of the first sample after the tick,
+ * so they are delivered when that sample is played rather than when it is rendered.
+ *
+ * @tparam Tick Trivially copyable data reported with each tick.
+ */
+template <class Tick>
+class RenderAheadBuffer
+{
+public:
+	RenderAheadBuffer() : head_(0), tail_(0), tickHead_(0), tickTail_(0) {}
+
+	/// Not thread-safe. Call while neither the producer nor the consumer is running.
+	void reset(size_t frameCapacity)
+	{
+		buf_.assign(frameCapacity << 1, 0);
+		head_.store(0);
+		tail_.store(0);
+		tickHead_.store(0);
+		tickTail_.store(0);
+	}
+
+	size_t getCapacity() const noexcept { return buf_.size() >> 1; }
+
+	size_t getReadableFrames() const noexcept
+	{
+		return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire));
+	}
+
+	/* Producer */
+	size_t getWritableFrames() const noexcept { return getCapacity() - getReadableFrames(); }
+
+	bool isTickQueueFull() const noexcept
+	{
+		return tickTail_.load(std::memory_order_relaxed) - tickHead_.load(std::memory_order_acquire) == TICK_CAPACITY;
+	}
+
+	/// Call only when isTickQueueFull() is false.
+	void pushTick(const Tick& tick) noexcept
+	{
+		uint64_t t = tickTail_.load(std::memory_order_relaxed);
+		ticks_[t & (TICK_CAPACITY - 1)] = { tail_.load(std::memory_order_relaxed), tick };
+		tickTail_.store(t + 1, std::memory_order_release);
+	}
+
+	/// Number of frames written so far. It may be called by any thread.
+	uint64_t getWritePosition() const noexcept { return tail_.load(std::memory_order_acquire); }
+
+	/// Call only with frames less than or equal to getWritableFrames().
+	void write(const int16_t* src, size_t frames) noexcept
+	{
+		uint64_t t = tail_.load(std::memory_order_relaxed);
+		size_t pos = static_cast<size_t>(t % getCapacity());
+		size_t first = std::min(frames, getCapacity() - pos);
+		std::copy(src, src + (first << 1), buf_.begin() + static_cast<std::ptrdiff_t>(pos << 1));
+		std::copy(src + (first << 1), src + (frames << 1), buf_.begin());
+		tail_.store(t + frames, std::memory_order_release);
+	}
+
+	/* Consumer */
+	/**
+	 * @brief Copy samples and report the ticks reached by them.
+	 * @param dest Destination of interleaved stereo samples.
+	 * @param frames Requested number of frames.
+	 * @param handler Called with each tick in order.
+	 * @return Number of copied frames.
+	 */
+	template <class TickHandler>
+	size_t read(int16_t* dest, size_t frames, TickHandler handler)
+	{
+		uint64_t h = head_.load(std::memory_order_relaxed);
+		size_t count = std::min(frames, static_cast<size_t>(tail_.load(std::memory_order_acquire) - h));
+		size_t pos = count ? static_cast<size_t>(h % getCapacity()) : 0;
+		size_t first = std::min(count, getCapacity() - pos);
+		auto begin = buf_.begin() + static_cast<std::ptrdiff_t>(pos << 1);
+		std::copy(begin, begin + static_cast<std::ptrdiff_t>(first << 1), dest);
+		std::copy(buf_.begin(), buf_.begin() + static_cast<std::ptrdiff_t>((count - first) << 1), dest + (first << 1));
+		head_.store(h + count, std::memory_order_release);
+		reportTicks(h + count, handler);
+
+		return count;
+	}
+
+	/**
+	 * @brief Drop the samples written before the given position and report the ticks reached by them.
+	 * @param position Write position taken by getWritePosition().
+	 * @param handler Called with each tick in order.
+	 */
+	template <class TickHandler>
+	void skip(uint64_t position, TickHandler handler)
+	{
+		uint64_t end = std::min(position, tail_.load(std::memory_order_acquire));
+		if (end <= head_.load(std::memory_order_relaxed)) return;
+		head_.store(end, std::memory_order_release);
+		reportTicks(end, handler);
+	}
+
+	/// Drop all queued samples and ticks.
+	void discard() noexcept
+	{
+		head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+		tickHead_.store(tickTail_.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	std::vector<int16_t> buf_;
+	alignas(64) std::atomic<uint64_t> head_;
+	alignas(64) std::atomic<uint64_t> tail_;
+
+	struct TickMark
+	{
+		uint64_t position;
+		Tick tick;
+	};
+	static constexpr size_t TICK_CAPACITY = 0x1000;	// Must be a power of 2
+	std::array<TickMark, TICK_CAPACITY> ticks_;
+	alignas(64) std::atomic<uint64_t> tickHead_;
+	alignas(64) std::atomic<uint64_t> tickTail_;
+
+	template <class TickHandler>
+	void reportTicks(uint64_t end, TickHandler& handler)
+	{
+		uint64_t th = tickHead_.load(std::memory_order_relaxed);
+		uint64_t tt = tickTail_.load(std::memory_order_acquire);
+		for (; th != tt && ticks_[th & (TICK_CAPACITY - 1)].position < end; ++th) {
+			handler(ticks_[th & (TICK_CAPACITY - 1)].tick);
+		}
+		tickHead_.store(th, std::memory_order_release);
+	}
+};
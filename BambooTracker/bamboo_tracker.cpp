@@ -9,7 +9,6 @@
 #include <exception>
 #include <iterator>
 #include <unordered_map>
-#include <unordered_set>
 #include "configuration.hpp"
 #include "opna_controller.hpp"
 #include "playback.hpp"
@@ -19,9 +18,11 @@
 #include "io/module_io.hpp"
 #include "io/instrument_io.hpp"
 #include "io/bank_io.hpp"
+#include "io/export_sink.hpp"
 #include "bank.hpp"
 #include "note.hpp"
-#include "song_length_calculator.hpp"
+#include "stem_renderer.hpp"
+#include "worker_pool.hpp"
 #include "utils.hpp"
 
 namespace
@@ -43,15 +44,19 @@ BambooTracker::BambooTracker(std::weak_ptr<Configuration> config)
 	  curVolume_(127),
 	  mkOrder_(-1),
 	  mkStep_(-1),
-	  isFollowPlay_(true)
+	  isFollowPlay_(true),
+	  playingOrderNum_(-1),
+	  playingStepNum_(-1)
 {
 	opnaCtrl_ = std::make_shared<OPNAController>(
 					static_cast<chip::OpnaEmulator>(config.lock()->getEmulator()),
+					static_cast<chip::YmfmFidelity>(config.lock()->getYmfmFidelity()),
 					CHIP_CLOCK,
 					config.lock()->getSampleRate(),
 					config.lock()->getBufferLength(),
 					config.lock()->getResamplerType());
 	opnaCtrl_->setImmediateWriteMode(config.lock()->getImmediateWriteModeEnabled());
+	opnaCtrl_->setSsgPipelineEnabled(config.lock()->getSsgPipelineEnabled());
 	setMasterVolume(config.lock()->getMixerVolumeMaster());
 	setMasterVolumeFM(config.lock()->getMixerVolumeFM());
 	setMasterVolumeSSG(config.lock()->getMixerVolumeSSG());
@@ -75,6 +80,7 @@ void BambooTracker::changeConfiguration(std::weak_ptr<Configuration> config)
 	setStreamRate(static_cast<int>(config.lock()->getSampleRate()));
 	setStreamDuration(static_cast<int>(config.lock()->getBufferLength()));
 	opnaCtrl_->setImmediateWriteMode(config.lock()->getImmediateWriteModeEnabled());
+	opnaCtrl_->setSsgPipelineEnabled(config.lock()->getSsgPipelineEnabled());
 	opnaCtrl_->setResampler(config.lock()->getResamplerType());
 	setMasterVolume(config.lock()->getMixerVolumeMaster());
 	if (mod_->getMixerType() == MixerType::UNSPECIFIED) {
@@ -891,20 +897,53 @@ void BambooTracker::clearSampleADPCMRawSample(int sampNum)
 
 bool BambooTracker::assignSampleADPCMRawSamples()
 {
-	opnaCtrl_->clearSamplesADPCM();
 	std::vector<int> idcs = storeOnlyUsedSamples_ ? instMan_->getSampleADPCMValidIndices()
 												  : instMan_->getSampleADPCMEntriedIndices();
-	bool storedAll = true;
+
+	// Keep unchanged samples in place and upload only the others
+	opnaCtrl_->clearSamplesADPCM();
+	std::vector<bool> isTarget(128);
 	for (auto sampNum : idcs) {
+		isTarget[static_cast<size_t>(sampNum)] = true;
+		if (instMan_->isSampleADPCMResident(sampNum)) {
+			opnaCtrl_->reserveSampleADPCM(instMan_->getSampleADPCMStartAddress(sampNum),
+										  instMan_->getSampleADPCMStopAddress(sampNum));
+		}
+	}
+	for (int sampNum = 0; sampNum < 128; ++sampNum) {
+		if (!isTarget[static_cast<size_t>(sampNum)]) instMan_->setSampleADPCMResident(sampNum, false);
+	}
+
+	// Return false if the sample is not stored or cut off
+	auto store = [&](int sampNum) {
+		std::vector<uint8_t> sample = instMan_->getSampleADPCMRawSample(sampNum);
 		size_t startAddr, stopAddr;
-		if (opnaCtrl_->storeSampleADPCM(instMan_->getSampleADPCMRawSample(sampNum), startAddr, stopAddr)) {
+		if (opnaCtrl_->storeSampleADPCM(sample, startAddr, stopAddr)) {
 			instMan_->setSampleADPCMStartAddress(sampNum, startAddr);
 			instMan_->setSampleADPCMStopAddress(sampNum, stopAddr);
+			bool isWhole = (stopAddr - startAddr == (sample.size() - 1) >> 5);	// By 32 bytes
+			instMan_->setSampleADPCMResident(sampNum, isWhole);
+			return isWhole;
 		}
-		else {
+		return false;
+	};
+
+	bool storedAll = true;
+	for (auto sampNum : idcs) {
+		if (!instMan_->isSampleADPCMResident(sampNum) && !store(sampNum)) {
 			storedAll = false;
+			break;
 		}
 	}
+	if (storedAll) return true;
+
+	// Compact memory by storing all samples again from the beginning
+	opnaCtrl_->clearSamplesADPCM();
+	instMan_->invalidateSampleADPCMResidency();
+	storedAll = true;
+	for (auto sampNum : idcs) {
+		if (!store(sampNum)) storedAll = false;
+	}
 	return storedAll;
 }
 
@@ -1525,6 +1564,7 @@ bool BambooTracker::assignADPCMBeforeForcedJamKeyOn(
 {
 	size_t start, stop;
 	bool isAssignedAll = false;
+	instMan_->invalidateSampleADPCMResidency();
 	switch (inst->getType()) {
 	case InstrumentType::ADPCM:
 	{
@@ -1623,6 +1663,8 @@ void BambooTracker::startPlay()
 			opnaCtrl_->setMuteState(pair.first, static_cast<int>(i), pair.second[i]);
 		}
 	}
+
+	if (liveEventCb_) liveEventCb_();
 }
 
 void BambooTracker::stopPlaySong()
@@ -1635,6 +1677,10 @@ void BambooTracker::stopPlaySong()
 			opnaCtrl_->setMuteState(pair.first, static_cast<int>(i), false);
 		}
 	}
+
+	playingOrderNum_ = -1;
+	playingStepNum_ = -1;
+	if (liveEventCb_) liveEventCb_();
 }
 
 bool BambooTracker::isPlaySong() const
@@ -1658,12 +1704,9 @@ bool BambooTracker::isMute(int trackNum)
 void BambooTracker::setFollowPlay(bool isFollowed)
 {
 	isFollowPlay_ = isFollowed;
-	if (isFollowed) {
-		int odr = playback_->getPlayingOrderNumber();
-		if (odr >= 0) {
-			curOrderNum_ = odr;
-			curStepNum_ = playback_->getPlayingStepNumber();
-		}
+	if (isFollowed && playingOrderNum_ >= 0) {
+		curOrderNum_ = playingOrderNum_;
+		curStepNum_ = playingStepNum_;
 	}
 }
 
@@ -1674,12 +1717,25 @@ bool BambooTracker::isFollowPlay() const
 
 int BambooTracker::getPlayingOrderNumber() const
 {
-	return playback_->getPlayingOrderNumber();
+	return playingOrderNum_;
 }
 
 int BambooTracker::getPlayingStepNumber() const
 {
-	return playback_->getPlayingStepNumber();
+	return playingStepNum_;
+}
+
+void BambooTracker::setPlayingPosition(int state, int order, int step)
+{
+	// Ticks rendered before stopping may arrive later
+	if (!playback_->isPlaySong()) order = step = -1;
+
+	playingOrderNum_ = order;
+	playingStepNum_ = step;
+	if (!state && isFollowPlay_ && order >= 0 && !playback_->isPlayingStep()) {	// Step
+		curOrderNum_ = order;
+		curStepNum_ = step;
+	}
 }
 
 void BambooTracker::setMarker(int order, int step)
@@ -1705,60 +1761,6 @@ int BambooTracker::getMarkerStep() const
 }
 
 /********** Export **********/
-namespace
-{
-void checkNextPositionOfLastStepAndStepSize(Song& song, int& endOrder, int& endStep)
-{
-	endOrder = 0;
-	endStep = 0;
-
-	std::vector<TrackAttribute> attribs = song.getTrackAttributes();
-	std::unordered_set<int> orderStepMap;
-	int lastOrder = static_cast<int>(song.getOrderSize()) - 1;
-
-	for (int curOrder = 0; !orderStepMap.count(curOrder); curOrder = endOrder) {
-		orderStepMap.insert(curOrder);	// Arrived flag
-		// Default next order
-		endOrder = (endOrder + 1) % (lastOrder + 1);
-		endStep = 0;
-
-		// Check jump effect
-		for (auto attrib : attribs) {
-			Step& step = song.getTrack(attrib.number).getPatternFromOrderNumber(curOrder)
-						 .getStep(static_cast<int>(song.getPatternSizeFromOrderNumber(curOrder)) - 1);
-			for (int i = 0; i < Step::N_EFFECT; ++i) {
-				Effect&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(i));
-				switch (eff.type) {
-				case EffectType::PositionJump:
-					if (eff.value <= lastOrder) {
-						endOrder = eff.value;
-						endStep = 0;
-					}
-					break;
-				case EffectType::SongEnd:
-					endOrder = -1;
-					endStep = -1;
-					return;
-				case EffectType::PatternBreak:
-					if (curOrder == lastOrder
-							&& eff.value < static_cast<int>(song.getPatternSizeFromOrderNumber(0))) {
-						endOrder = 0;
-						endStep = eff.value;
-					}
-					else if (eff.value < static_cast<int>(song.getPatternSizeFromOrderNumber(curOrder + 1))) {
-						endOrder = curOrder + 1;
-						endStep = eff.value;
-					}
-					break;
-				default:
-					break;
-				}
-			}
-		}
-	}
-}
-}
-
 bool BambooTracker::exportToWav(io::WavContainer& container, int loopCnt, ExportCancellCallback checkFunc)
 {
 	int tmpRate = opnaCtrl_->getRate();
@@ -1768,8 +1770,9 @@ bool BambooTracker::exportToWav(io::WavContainer& container, int loopCnt, Export
 	size_t intrCntRest = 0;
 	std::vector<int16_t> buf(sampCnt << 1);
 
-	int endOrder, endStep;
-	checkNextPositionOfLastStepAndStepSize(mod_->getSong(curSongNum_), endOrder, endStep);
+	SongPlaybackTiming timing = getSongPlaybackTiming(curSongNum_, 0);
+	int endOrder = timing.loopOrder;
+	int endStep = timing.loopStep;
 	bool endFlag = false;
 	bool tmpFollow = std::exchange(isFollowPlay_, false);
 	startPlayFromStart();
@@ -1822,9 +1825,92 @@ bool BambooTracker::exportToWav(io::WavContainer& container, int loopCnt, Export
 	return true;
 }
 
+bool BambooTracker::exportStemsToWav(std::vector<io::WavContainer>& containers, uint32_t rate, int loopCnt,
+									 ExportCancellCallback checkFunc, const std::vector<std::vector<int>>& stems)
+{
+	size_t intrCnt = static_cast<size_t>(rate) / mod_->getTickFrequency();
+
+	SongPlaybackTiming timing = getSongPlaybackTiming(curSongNum_, 0);
+	int endOrder = timing.loopOrder;
+	int endStep = timing.loopStep;
+	bool tmpFollow = std::exchange(isFollowPlay_, false);
+
+	// Run the sequencer once and keep its register writes
+	auto logger = std::make_shared<chip::RegisterEventLogger>();
+	opnaCtrl_->setExportContainer(logger);
+	instMan_->invalidateSampleADPCMResidency();	// Log all sample writes
+	assignSampleADPCMRawSamples();
+	startPlayFromStart();
+
+	bool isCanceled = false;
+	while (true) {
+		if (!streamCountUp()) {
+			if (checkFunc()) {	// Update lambda function
+				isCanceled = true;
+				break;
+			}
+
+			int playOrder = playback_->getPlayingOrderNumber();
+			int playStep = playback_->getPlayingStepNumber();
+			if ((playOrder == -1 && playStep == -1)
+					|| (playOrder == endOrder && playStep == endStep && !(loopCnt--))) break;
+		}
+
+		logger->elapse(intrCnt);
+	}
+
+	opnaCtrl_->setExportContainer();
+	stopPlaySong();
+	isFollowPlay_ = tmpFollow;
+	instMan_->invalidateSampleADPCMResidency();	// Samples were stored only in the log
+	if (isCanceled) return false;
+
+	// Replay the writes into a chip per stem
+	std::vector<std::unique_ptr<StemRenderer>> renderers;
+	auto addRenderer = [&](const std::vector<TrackAttribute>& attribs) {
+		renderers.push_back(std::make_unique<StemRenderer>(
+								opnaCtrl_->createChipReplica(static_cast<int>(rate)), songStyle_.type, attribs));
+	};
+	if (stems.empty()) {
+		for (const auto& attrib : songStyle_.trackAttribs) addRenderer({ attrib });
+	}
+	else {
+		for (const std::vector<int>& tracks : stems) {
+			std::vector<TrackAttribute> attribs;
+			for (int track : tracks) attribs.push_back(songStyle_.trackAttribs.at(static_cast<size_t>(track)));
+			addRenderer(attribs);
+		}
+	}
+	containers.assign(renderers.size(), io::WavContainer(rate, 2, 16));
+
+	std::vector<char> results(renderers.size(), false);
+	auto render = [&](size_t i, const std::atomic_bool& cancel) {
+		try {
+			results[i] = renderers[i]->render(logger->getEvents(), logger->getSampleLength(),
+											  containers[i], cancel);
+		}
+		catch (...) {
+			results[i] = false;
+		}
+	};
+	if (!WorkerPool().run(renderers.size(), render, checkFunc)) return false;
+
+	return std::all_of(results.begin(), results.end(), [](char r) { return r; });
+}
+
 bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool gd3TagEnabled,
 								const io::GD3Tag& tag, bool shouldSetMix, double gain,
 								ExportCancellCallback checkFunc)
+{
+	io::MemoryExportSink sink;
+	if (!exportToVgm(sink, target, gd3TagEnabled, tag, shouldSetMix, gain, checkFunc)) return false;
+	sink.copyTo(container);
+	return true;
+}
+
+bool BambooTracker::exportToVgm(io::ExportSink& sink, int target, bool gd3TagEnabled,
+								const io::GD3Tag& tag, bool shouldSetMix, double gain,
+								ExportCancellCallback checkFunc)
 {
 	int tmpRate = opnaCtrl_->getRate();
 	opnaCtrl_->setRate(44100);
@@ -1833,18 +1919,22 @@ bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool
 	double intrCntDiff = dblIntrCnt - intrCnt;
 	double intrCntRest = 0;
 
-	int loopOrder, loopStep;
-	checkNextPositionOfLastStepAndStepSize(mod_->getSong(curSongNum_), loopOrder, loopStep);
+	SongPlaybackTiming timing = getSongPlaybackTiming(curSongNum_, 0);
+	int loopOrder = timing.loopOrder;
+	int loopStep = timing.loopStep;
 	bool loopFlag = (loopOrder != -1);
 	int endCnt = (loopOrder == -1) ? 0 : 1;
 	bool tmpFollow = std::exchange(isFollowPlay_, false);
 	uint32_t loopPoint = 0;
 	uint32_t loopPointSamples = 0;
 
-	auto exCntr = std::make_shared<chip::VgmLogger>(target, mod_->getTickFrequency());
+	sink.appendZeros(io::getVgmHeaderSize(shouldSetMix));
+	auto exCntr = std::make_shared<chip::VgmLogger>(target, mod_->getTickFrequency(), sink);
+	exCntr->setOptimizationEnabled(true);
 
 	// Set ADPCM
 	opnaCtrl_->clearSamplesADPCM();
+	instMan_->invalidateSampleADPCMResidency();
 	std::vector<uint8_t> rom;
 	for (auto sampNum : instMan_->getSampleADPCMValidIndices()) {
 		std::vector<uint8_t>&& sample = instMan_->getSampleADPCMRawSample(sampNum);
@@ -1856,7 +1946,7 @@ bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool
 			std::copy(sample.begin(), sample.end(), rom.begin() + static_cast<int>(startAddr << 5));
 		}
 	}
-	exCntr->setDataBlock(std::move(rom));
+	exCntr->setDataBlock(rom);
 
 	opnaCtrl_->setExportContainer(exCntr);
 	startPlayFromStart();
@@ -1888,6 +1978,8 @@ bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool
 		exCntr->elapse(intrCnt + extraIntrCnt);
 	}
 
+	exCntr->flushWait();
+	lastExportOpt_ = exCntr->getOptimizationStatistics();
 	opnaCtrl_->setExportContainer();
 	stopPlaySong();
 	isFollowPlay_ = tmpFollow;
@@ -1901,9 +1993,8 @@ bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool
 	}
 
 	try {
-		io::writeVgm(container, target, exCntr->getData(), CHIP_CLOCK, mod_->getTickFrequency(),
-					 loopFlag, loopPoint, exCntr->getSampleLength() - loopPointSamples,
-					 exCntr->getSampleLength(), gd3Tag, mix.get());
+		io::writeVgm(sink, target, CHIP_CLOCK, mod_->getTickFrequency(), loopFlag, loopPoint,
+					 exCntr->getSampleLength() - loopPointSamples, exCntr->getSampleLength(), gd3Tag, mix.get());
 		return true;
 	} catch (...) {
 		throw;
@@ -1912,6 +2003,15 @@ bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool
 
 bool BambooTracker::exportToS98(io::BinaryContainer& container, int target, bool tagEnabled,
 								const io::S98Tag& tag, int rate, ExportCancellCallback checkFunc)
+{
+	io::MemoryExportSink sink;
+	if (!exportToS98(sink, target, tagEnabled, tag, rate, checkFunc)) return false;
+	sink.copyTo(container);
+	return true;
+}
+
+bool BambooTracker::exportToS98(io::ExportSink& sink, int target, bool tagEnabled,
+								const io::S98Tag& tag, int rate, ExportCancellCallback checkFunc)
 {
 	int tmpRate = opnaCtrl_->getRate();
 	opnaCtrl_->setRate(rate);
@@ -1920,20 +2020,24 @@ bool BambooTracker::exportToS98(io::BinaryContainer& container, int target, bool
 	double intrCntDiff = dblIntrCnt - intrCnt;
 	double intrCntRest = 0;
 
-	int loopOrder, loopStep;
-	checkNextPositionOfLastStepAndStepSize(mod_->getSong(curSongNum_), loopOrder, loopStep);
+	SongPlaybackTiming timing = getSongPlaybackTiming(curSongNum_, 0);
+	int loopOrder = timing.loopOrder;
+	int loopStep = timing.loopStep;
 	bool loopFlag = (loopOrder != -1);
 	int endCnt = (loopOrder == -1) ? 0 : 1;
 	bool tmpFollow = std::exchange(isFollowPlay_, false);
 	uint32_t loopPoint = 0;
-	auto exCntr = std::make_shared<chip::S98Logger>(target);
+	sink.appendZeros(io::S98_HEADER_SIZE);
+	auto exCntr = std::make_shared<chip::S98Logger>(target, sink);
+	exCntr->setOptimizationEnabled(true);
 	opnaCtrl_->setExportContainer(exCntr);
 	startPlayFromStart();
+	instMan_->invalidateSampleADPCMResidency();	// Log all sample writes
 	assignSampleADPCMRawSamples();
 	exCntr->forceMoveLoopPoint();
 
 	while (true) {
-		exCntr->getData();	// Set wait counts
+		exCntr->splitWait();	// Set wait counts
 		if (!streamCountUp()) {
 			if (checkFunc()) {	// Update lambda function
 				stopPlaySong();
@@ -1957,14 +2061,15 @@ bool BambooTracker::exportToS98(io::BinaryContainer& container, int target, bool
 		exCntr->elapse(intrCnt + extraIntrCnt);
 	}
 
+	exCntr->flushWait();
+	lastExportOpt_ = exCntr->getOptimizationStatistics();
 	opnaCtrl_->setExportContainer();
 	stopPlaySong();
 	isFollowPlay_ = tmpFollow;
 	opnaCtrl_->setRate(tmpRate);
 
 	try {
-		io::writeS98(container, target, exCntr->getData(), CHIP_CLOCK, static_cast<uint32_t>(rate),
-					 loopFlag, loopPoint, tagEnabled, tag);
+		io::writeS98(sink, target, CHIP_CLOCK, static_cast<uint32_t>(rate), loopFlag, loopPoint, tagEnabled, tag);
 		return true;
 	} catch (...) {
 		throw;
@@ -1975,6 +2080,7 @@ bool BambooTracker::exportToS98(io::BinaryContainer& container, int target, bool
 void BambooTracker::connectToRealChip(RealChipInterfaceType type, RealChipInterfaceGeneratorFunc* f)
 {
 	opnaCtrl_->connectToRealChip(type, f);
+	instMan_->invalidateSampleADPCMResidency();	// Need to send all samples to the new chip
 }
 
 RealChipInterfaceType BambooTracker::getRealChipInterfaceType() const
@@ -1990,15 +2096,22 @@ bool BambooTracker::hasConnectedToRealChip() const
 /********** Stream events **********/
 int BambooTracker::streamCountUp()
 {
-	int state = playback_->streamCountUp();
-	if (!state && isFollowPlay_ && !playback_->isPlayingStep()) {	// Step
-		int odr = playback_->getPlayingOrderNumber();
-		if (odr >= 0) {
-			curOrderNum_ = odr;
-			curStepNum_ = playback_->getPlayingStepNumber();
-		}
-	}
-	return state;
+	return playback_->streamCountUp();
+}
+
+int BambooTracker::getStreamOrderNumber() const
+{
+	return playback_->getPlayingOrderNumber();
+}
+
+int BambooTracker::getStreamStepNumber() const
+{
+	return playback_->getPlayingStepNumber();
+}
+
+void BambooTracker::setLiveEventCallback(LiveEventCallback cb)
+{
+	liveEventCb_ = cb;
 }
 
 bool BambooTracker::getStreamSamples(int16_t *container, size_t nSamples)
@@ -2033,6 +2146,31 @@ void BambooTracker::setStreamDuration(int duration)
 	opnaCtrl_->setDuration(duration);
 }
 
+void BambooTracker::setStreamResampler(chip::ResamplerType type)
+{
+	opnaCtrl_->setResampler(type);
+}
+
+void BambooTracker::setSsgPipelineEnabled(bool enabled)
+{
+	opnaCtrl_->setSsgPipelineEnabled(enabled);
+}
+
+bool BambooTracker::isYmfmEmulator() const
+{
+	return opnaCtrl_->isYmfm();
+}
+
+chip::YmfmFidelity BambooTracker::getYmfmFidelity() const
+{
+	return opnaCtrl_->getYmfmFidelity();
+}
+
+void BambooTracker::setYmfmFidelity(chip::YmfmFidelity fidelity)
+{
+	opnaCtrl_->setYmfmFidelity(fidelity);
+}
+
 int BambooTracker::getStreamTempo() const
 {
 	return tickCounter_->getTempo();
@@ -2360,16 +2498,19 @@ void BambooTracker::swapTracks(int songNum, int track1, int track2)
 
 double BambooTracker::estimateSongLength(int songNum) const
 {
-	SongLengthCalculator calc(*mod_.get(), songNum);
-	return calc.approximateLengthBySecond();
+	SongPlaybackTiming timing = getSongPlaybackTiming(songNum, 1);
+	return timing.ticksToSecond(timing.totalTicks);
 }
 
 size_t BambooTracker::getTotalStepCount(int songNum, size_t loopCnt) const
 {
-	size_t introSize, loopSize;
-	SongLengthCalculator calc(*mod_.get(), songNum);
-	calc.totalStepCount(introSize, loopSize);
-	return introSize + loopSize * loopCnt;
+	return getSongPlaybackTiming(songNum, loopCnt).totalSteps;
+}
+
+SongPlaybackTiming BambooTracker::getSongPlaybackTiming(int songNum, size_t loopCnt) const
+{
+	SongLengthCalculator calc(mod_, songNum);
+	return calc.calculateTiming(loopCnt);
 }
 
 /*----- Bookmark -----*/
@@ -17,8 +17,10 @@
 #include "instrument.hpp"
 #include "instrument/sample_repeat.hpp"
 #include "module.hpp"
+#include "song_length_calculator.hpp"
 #include "command/command_manager.hpp"
 #include "chip/real_chip_interface.hpp"
+#include "chip/register_write_logger.hpp"
 #include "io/binary_container.hpp"
 #include "io/export_io.hpp"
 #include "io/wav_container.hpp"
@@ -34,6 +36,12 @@ class PlaybackManager;
 class TickCounter;
 class SampleRepeatRange;
 
+namespace chip
+{
+enum class ResamplerType : int;
+enum class YmfmFidelity : int;
+}
+
 class BambooTracker
 {
 public:
@@ -327,8 +335,14 @@ public:
 	bool isMute(int trackNum);
 	void setFollowPlay(bool isFollowed);
 	bool isFollowPlay() const;
+	/// Position heard at the output. -1 if stopped.
 	int getPlayingOrderNumber() const;
 	int getPlayingStepNumber() const;
+	/**
+	 * @brief Set the position heard at the output. The cursor follows it in follow mode.
+	 * @param state Tick state counted with the position by streamCountUp.
+	 */
+	void setPlayingPosition(int state, int order, int step);
 	void setMarker(int order, int step);
 	int getMarkerOrder() const;
 	int getMarkerStep() const;
@@ -336,10 +350,29 @@ public:
 	// Export
 	using ExportCancellCallback = std::function<bool()>;
 	bool exportToWav(io::WavContainer& container, int loopCnt, ExportCancellCallback checkFunc);
+	/**
+	 * @brief Export tracks of the current song to separate WAVs from a single playback.
+	 * @param containers Filled with one container per stem.
+	 * @param checkFunc Called on the calling thread while tracks are rendered on worker threads.
+	 * @param stems Track numbers mixed into each stem. If it is empty, each track is a stem in order of track number.
+	 */
+	bool exportStemsToWav(std::vector<io::WavContainer>& containers, uint32_t rate, int loopCnt,
+						  ExportCancellCallback checkFunc, const std::vector<std::vector<int>>& stems = {});
 	bool exportToVgm(io::BinaryContainer& container, int target, bool gd3TagEnabled,
 					 const io::GD3Tag& tag, bool shouldSetMix, double gain, ExportCancellCallback checkFunc);
+	/// Stream VGM into the empty sink.
+	bool exportToVgm(io::ExportSink& sink, int target, bool gd3TagEnabled,
+					 const io::GD3Tag& tag, bool shouldSetMix, double gain, ExportCancellCallback checkFunc);
 	bool exportToS98(io::BinaryContainer& container, int target, bool tagEnabled,
 					 const io::S98Tag& tag, int rate, ExportCancellCallback checkFunc);
+	/// Stream S98 into the empty sink.
+	bool exportToS98(io::ExportSink& sink, int target, bool tagEnabled,
+					 const io::S98Tag& tag, int rate, ExportCancellCallback checkFunc);
+	/// Redundant writes and wait bytes removed from the last VGM or S98 export.
+	chip::AbstractRegisterWriteLogger::OptimizationStatistics getLastExportOptimization() const
+	{
+		return lastExportOpt_;
+	}
 
 	// Real chip interface
 	void connectToRealChip(RealChipInterfaceType type, RealChipInterfaceGeneratorFunc* f = nullptr);
@@ -351,6 +384,13 @@ public:
 	///  0: Step
 	/// -1: Stop
 	int streamCountUp();
+	/// Position of the tick counted last, which is ahead of the output when samples are rendered ahead.
+	int getStreamOrderNumber() const;
+	int getStreamStepNumber() const;
+	/// Called after playback starts or stops, so that the samples rendered ahead before it can be dropped.
+	/// Jam keys during playback do not call it, as they do not change the samples already rendered.
+	using LiveEventCallback = std::function<void()>;
+	void setLiveEventCallback(LiveEventCallback cb);
 	/**
 	 * @brief getStreamSamples
 	 * @param container buffer where generated samples are stored.
@@ -365,6 +405,11 @@ public:
 	void setStreamRate(int rate);
 	int getStreamDuration() const;
 	void setStreamDuration(int duration);
+	void setStreamResampler(chip::ResamplerType type);
+	void setSsgPipelineEnabled(bool enabled);
+	bool isYmfmEmulator() const;
+	chip::YmfmFidelity getYmfmFidelity() const;
+	void setYmfmFidelity(chip::YmfmFidelity fidelity);
 	int getStreamTempo() const;
 	int getStreamSpeed() const;
 	bool getStreamGrooveEnabled() const;
@@ -426,6 +471,7 @@ public:
 	void swapTracks(int songNum, int track1, int track2);
 	double estimateSongLength(int songNum) const;
 	size_t getTotalStepCount(int songNum, size_t loopCnt) const;
+	SongPlaybackTiming getSongPlaybackTiming(int songNum, size_t loopCnt) const;
 	/*----- Bookmark -----*/
 	void addBookmark(int songNum, const std::string& name, int order, int step);
 	void changeBookmark(int songNum, int i, const std::string& name, int order, int step);
@@ -544,7 +590,10 @@ private:
 	int mkOrder_, mkStep_;
 
 	bool isFollowPlay_;
+	int playingOrderNum_, playingStepNum_;
+	LiveEventCallback liveEventCb_;
 	bool storeOnlyUsedSamples_;
+	chip::AbstractRegisterWriteLogger::OptimizationStatistics lastExportOpt_;
 
 	// Module details
 	void makeNewModule(bool withInstrument);
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "batch_exporter.hpp"
+#include "bamboo_tracker.hpp"
+#include "io/module_io.hpp"
+
+BatchExporter::BatchExporter(std::weak_ptr<Configuration> config, size_t threadCount)
+	: config_(config), pool_(threadCount)
+{
+}
+
+BatchExporter::ModuleSnapshot BatchExporter::takeSnapshot(BambooTracker& bt)
+{
+	io::BinaryContainer container;
+	bt.saveModule(container);
+	return makeSnapshot(std::move(container));
+}
+
+BatchExporter::ModuleSnapshot BatchExporter::makeSnapshot(io::BinaryContainer&& module)
+{
+	return std::make_shared<const io::BinaryContainer>(std::move(module));
+}
+
+void BatchExporter::addJob(ModuleSnapshot snapshot, int songNum, ExportTask task)
+{
+	jobs_.push_back({ std::move(snapshot), songNum, std::move(task) });
+}
+
+void BatchExporter::clearJobs()
+{
+	jobs_.clear();
+}
+
+std::vector<bool> BatchExporter::run(ExportCancellCallback checkFunc,
+									 std::function<void(size_t)> progressFunc)
+{
+	// Create the lazily initialized loader before the workers race for it
+	io::ModuleIO::getInstance();
+
+	std::vector<char> results(jobs_.size(), false);
+	auto work = [&](size_t i, const std::atomic_bool& isCanceled) {
+		const Job& job = jobs_[i];
+		try {
+			BambooTracker bt(config_);
+			// Read the shared snapshot through a view so that it is never copied or modified
+			io::BinaryContainer container = io::BinaryContainer::view(job.snapshot->data(),
+																	   job.snapshot->size());
+			bt.loadModule(container);
+			if (job.songNum >= 0 && static_cast<size_t>(job.songNum) < bt.getSongCount()) {
+				bt.setCurrentSongNumber(job.songNum);
+				bt.assignSampleADPCMRawSamples();
+				results[i] = job.task(bt, [&isCanceled] { return isCanceled.load(); });
+			}
+		}
+		catch (...) {
+			results[i] = false;
+		}
+	};
+	pool_.run(jobs_.size(), work, checkFunc, progressFunc);
+
+	return std::vector<bool>(results.begin(), results.end());
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "worker_pool.hpp"
+#include "io/binary_container.hpp"
+
+class BambooTracker;
+class Configuration;
+
+/**
+ * @brief Export engine which runs several export jobs concurrently.
+ *
+ * Each job owns a separate BambooTracker, and thus its own OPNAController,
+ * PlaybackManager and TickCounter, built from a read-only module snapshot.
+ * Jobs never touch the tracker the snapshot was taken from, so live playback
+ * keeps running while a batch is exported.
+ */
+class BatchExporter
+{
+public:
+	using ModuleSnapshot = std::shared_ptr<const io::BinaryContainer>;
+	using ExportCancellCallback = std::function<bool()>;
+	/// Export the current song of the given tracker. It is called on a worker thread.
+	using ExportTask = std::function<bool(BambooTracker&, ExportCancellCallback)>;
+
+	/// @param threadCount The number of worker threads. 0 uses the number of hardware threads.
+	explicit BatchExporter(std::weak_ptr<Configuration> config, size_t threadCount = 0);
+
+	static ModuleSnapshot takeSnapshot(BambooTracker& bt);
+	static ModuleSnapshot makeSnapshot(io::BinaryContainer&& module);
+
+	void addJob(ModuleSnapshot snapshot, int songNum, ExportTask task);
+	inline size_t getJobCount() const noexcept { return jobs_.size(); }
+	void clearJobs();
+
+	/**
+	 * @brief Run all jobs and wait for them.
+	 * @param checkFunc Called periodically on the calling thread. Return true to cancel the jobs.
+	 * @param progressFunc Called on the calling thread with the number of finished jobs.
+	 * @return Results of the jobs in the order they were added.
+	 */
+	std::vector<bool> run(ExportCancellCallback checkFunc,
+						  std::function<void(size_t)> progressFunc = nullptr);
+
+private:
+	std::weak_ptr<Configuration> config_;
+	WorkerPool pool_;
+
+	struct Job
+	{
+		ModuleSnapshot snapshot;
+		int songNum;
+		ExportTask task;
+	};
+	std::vector<Job> jobs_;
+};
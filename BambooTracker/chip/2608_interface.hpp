@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include "chip_defs.h"
 
@@ -17,7 +18,15 @@ public:
 	virtual void writeDataToPortA(uint8_t data) = 0;
 	virtual void writeDataToPortB(uint8_t data) = 0;
 	virtual uint8_t readData() = 0;
+	/// Write an SSG register without going through the FM part,
+	/// so that it does not race with updateStream running on another thread.
+	virtual void writeSsgRegister(uint8_t address, uint8_t data) = 0;
+	/// While separated, SSG writes through the ports keep their timing on the FM part
+	/// but do not reach the SSG, which is written by writeSsgRegister instead.
+	virtual void setSsgSeparated(bool separated) = 0;
+	virtual void writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size) = 0;
 	virtual void updateStream(sample** outputs, int nSamples) = 0;
-	virtual void updateSsgStream(sample** outputs, int nSamples) = 0;
+	/// SSG is mono, and it is panned to the center in OPNA::mix.
+	virtual void updateSsgStream(sample* output, int nSamples) = 0;
 };
 }
@@ -108,6 +108,8 @@ void Chip::updateVolumeRatio(int i)
 
 void Chip::setMaxDuration(size_t maxDuration)
 {
+	std::lock_guard<std::mutex> lg(mutex_);
+
 	maxDuration_ = maxDuration;
 	for (int snd = 0; snd < 2; ++snd) {
 		resampler_[snd]->setMaxDuration(maxDuration);
@@ -121,6 +123,7 @@ void Chip::setRegisterWriteLogger(std::shared_ptr<AbstractRegisterWriteLogger> l
 
 void Chip::setMasterVolume(int percentage)
 {
+	std::lock_guard<std::mutex> lg(volumeMutex_);
 	masterVolumeRatio_ = percentage / 100.0;
 	updateVolumeRatio();
 }
@@ -27,6 +27,7 @@
 
 #include "chip_defs.h"
 #include <cstdint>
+#include <atomic>
 #include <memory>
 #include <mutex>
 
@@ -65,6 +66,8 @@ public:
 
 protected:
 	const int id_;
+	// Held while the device and the resamplers are used.
+	// Register writers do not take it while mix is running, only configuration changes do
 	std::mutex mutex_;
 
 	int rate_, clock_;
@@ -72,9 +75,10 @@ protected:
 	int internalRate_[2];
 	size_t maxDuration_;
 
+	std::mutex volumeMutex_;	// Serializes volume updates. mix never takes it
 	double masterVolumeRatio_;
 	double busVolumeRatio_[2];
-	double volumeRatio_[2];
+	std::atomic<double> volumeRatio_[2];	// Read by mix without locking
 
 	sample* buffer_[2][2];
 	std::unique_ptr<AbstractResampler> resampler_[2];
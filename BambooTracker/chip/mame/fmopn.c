@@ -2728,12 +2728,18 @@ static const int step_inc[8] = { -1*16, -1*16, -1*16, -1*16, 2*16, 5*16, 7*16, 9
 
 /* speedup purposes only */
 static int jedi_table[ 49*16 ];
+static UINT8 adpcmaTableInit = 0;
 
 
 static void Init_ADPCMATable(void)
 {
 	int step, nib;
 
+	/* chips read the table while others are created */
+	if (adpcmaTableInit)
+		return;
+	adpcmaTableInit = 1;
+
 	for (step = 0; step < 49; step++)
 	{
 		/* loop over all nibbles and compute the difference */
@@ -3175,6 +3181,13 @@ static void YM2608_deltat_status_reset(void *chip, UINT8 changebits)
 	YM2608 *F2608 = (YM2608 *)chip;
 	FM_STATUS_RESET(&(F2608->OPN.ST), changebits);
 }
+/* build the tables shared by all chips */
+void ym2608_init_tables(void)
+{
+	init_tables();
+	Init_ADPCMATable();
+}
+
 /* YM2608(OPNA) */
 void * ym2608_init(void *param, UINT32 clock, UINT32 rate,
 				FM_TIMERHANDLER timer_handler,FM_IRQHANDLER IRQHandler)
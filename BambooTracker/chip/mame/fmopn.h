@@ -120,6 +120,8 @@ void ym2203_set_mutemask(void *chip, UINT32 MuteMask);
 
 #if BUILD_YM2608
 /* -------------------- YM2608(OPNA) Interface -------------------- */
+/* Call it once before creating chips, which may then be created on several threads */
+void ym2608_init_tables(void);
 void * ym2608_init(void *param, UINT32 baseclock, UINT32 rate,
 				FM_TIMERHANDLER TimerHandler,FM_IRQHANDLER IRQHandler);
 void ym2608_link_ssg(void *chip, const ssg_callbacks *ssg, void *ssg_param);
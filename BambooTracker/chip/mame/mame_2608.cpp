@@ -25,6 +25,7 @@
 
 #include "mame_2608.hpp"
 #include <algorithm>
+#include <mutex>
 
 extern "C"
 {
@@ -44,7 +45,7 @@ void setSsgClock(void* param, uint32_t clock)
 void writeSsg(void* param, uint8_t address, uint8_t data)
 {
 	auto state = reinterpret_cast<Mame2608State*>(param);
-	if (state->ssg) PSG_writeIO(state->ssg, address, data);
+	if (state->ssg && !state->isSsgSeparated) PSG_writeIO(state->ssg, address, data);
 }
 
 uint8_t readSsg(void* param)
@@ -68,6 +69,12 @@ const ssg_callbacks SSG_INTF =
 };
 }
 
+namespace
+{
+// Tables shared by all chips are built once, before any chip reads them in another thread
+std::once_flag tablesInitFlag;
+}
+
 Mame2608::~Mame2608()
 {
 	stopDevice();
@@ -82,6 +89,7 @@ int Mame2608::startDevice(int clock, int& rateSsg, uint32_t dramSize)
 	PSG_setVolumeMode(state_.ssg, 1);	// YM2149 volume mode
 
 	int rate = clock / 144;	// FM synthesis rate is clock / 2 / 72
+	std::call_once(tablesInitFlag, ym2608_init_tables);
 	state_.chip = ym2608_init(&state_, clock, rate, nullptr, nullptr);
 	if (!state_.chip) return 0;
 	ym2608_link_ssg(state_.chip, &SSG_INTF, &state_);
@@ -133,25 +141,38 @@ uint8_t Mame2608::readData()
 	return ym2608_read(state_.chip, 1);
 }
 
+void Mame2608::writeSsgRegister(uint8_t address, uint8_t data)
+{
+	if (state_.ssg) {
+		PSG_writeIO(state_.ssg, 0, address);
+		PSG_writeIO(state_.ssg, 1, data);
+	}
+}
+
+void Mame2608::setSsgSeparated(bool separated)
+{
+	state_.isSsgSeparated = separated;
+}
+
+void Mame2608::writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size)
+{
+	ym2608_write_pcmromb(state_.chip, address, static_cast<uint32_t>(size), data);
+}
+
 void Mame2608::updateStream(sample** outputs, int nSamples)
 {
 	ym2608_update_one(state_.chip, nSamples, outputs);
 }
 
-void Mame2608::updateSsgStream(sample** outputs, int nSamples)
+void Mame2608::updateSsgStream(sample* output, int nSamples)
 {
 	if (state_.ssg) {
-		sample* bufl = outputs[STEREO_LEFT];
-		sample* bufr = outputs[STEREO_RIGHT];
 		for (int i = 0; i < nSamples; ++i) {
-			int16_t s = PSG_calc(state_.ssg) << 1;
-			*bufl++ = s;
-			*bufr++ = s;
+			*output++ = PSG_calc(state_.ssg) << 1;
 		}
 	}
 	else {
-		std::fill_n(outputs[STEREO_LEFT], nSamples, 0);
-		std::fill_n(outputs[STEREO_RIGHT], nSamples, 0);
+		std::fill_n(output, nSamples, 0);
 	}
 }
 }
@@ -34,6 +34,7 @@ struct Mame2608State
 {
 	void* chip = nullptr;
 	PSG* ssg = nullptr;
+	bool isSsgSeparated = false;
 };
 
 class Mame2608 final : public Ym2608Interface
@@ -48,8 +49,11 @@ public:
 	void writeDataToPortA(uint8_t data) override;
 	void writeDataToPortB(uint8_t data) override;
 	uint8_t readData() override;
+	void writeSsgRegister(uint8_t address, uint8_t data) override;
+	void setSsgSeparated(bool separated) override;
+	void writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size) override;
 	void updateStream(sample** outputs, int nSamples) override;
-	void updateSsgStream(sample** outputs, int nSamples) override;
+	void updateSsgStream(sample* output, int nSamples) override;
 
 private:
 	Mame2608State state_;
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "mix_kernel.hpp"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BT_MIX_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define BT_MIX_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BT_TARGET_AVX2
+#else
+#define BT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+namespace chip
+{
+namespace
+{
+using GainFunc = void (*)(sample*, size_t, float);
+using MixFunc = void (*)(int16_t*, const sample*, const sample*, const sample*, size_t, float);
+
+/********** Portable **********/
+void gainSamplesScalar(sample* samples, size_t nSamples, float gain)
+{
+	std::transform(samples, samples + nSamples, samples,
+				   [gain](sample s) { return static_cast<sample>(s * gain); });
+}
+
+inline int16_t saturate(float value)
+{
+	return static_cast<int16_t>(std::min(std::max(value, -32768.f), 32767.f));
+}
+
+void mixSamplesScalar(int16_t* dest, const sample* fmL, const sample* fmR, const sample* ssg,
+					  size_t nSamples, float scale)
+{
+	for (size_t i = 0; i < nSamples; ++i) {
+		*dest++ = saturate((fmL[i] + ssg[i]) * scale);
+		*dest++ = saturate((fmR[i] + ssg[i]) * scale);
+	}
+}
+
+#ifdef BT_MIX_SSE2
+/********** SSE2 **********/
+void gainSamplesSse2(sample* samples, size_t nSamples, float gain)
+{
+	const __m128 g = _mm_set1_ps(gain);
+	size_t i = 0;
+	for (; i + 4 <= nSamples; i += 4) {
+		__m128i* p = reinterpret_cast<__m128i*>(samples + i);
+		__m128 v = _mm_cvtepi32_ps(_mm_loadu_si128(p));
+		_mm_storeu_si128(p, _mm_cvttps_epi32(_mm_mul_ps(v, g)));
+	}
+	gainSamplesScalar(samples + i, nSamples - i, gain);
+}
+
+void mixSamplesSse2(int16_t* dest, const sample* fmL, const sample* fmR, const sample* ssg,
+					size_t nSamples, float scale)
+{
+	const __m128 s = _mm_set1_ps(scale);
+	const __m128 lo = _mm_set1_ps(-32768.f);
+	const __m128 hi = _mm_set1_ps(32767.f);
+	auto convert = [&](const sample* fm, __m128i ssgv) {
+		__m128i sum = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(fm)), ssgv);
+		__m128 v = _mm_mul_ps(_mm_cvtepi32_ps(sum), s);
+		return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, lo), hi));
+	};
+
+	size_t i = 0;
+	for (; i + 4 <= nSamples; i += 4) {
+		__m128i ssgv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ssg + i));
+		__m128i l = convert(fmL + i, ssgv);
+		__m128i r = convert(fmR + i, ssgv);
+		// L0 R0 L1 R1 L2 R2 L3 R3
+		__m128i lr = _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 2), lr);
+	}
+	mixSamplesScalar(dest + i * 2, fmL + i, fmR + i, ssg + i, nSamples - i, scale);
+}
+#endif
+
+#ifdef BT_MIX_AVX2
+/********** AVX2 **********/
+BT_TARGET_AVX2 void gainSamplesAvx2(sample* samples, size_t nSamples, float gain)
+{
+	const __m256 g = _mm256_set1_ps(gain);
+	size_t i = 0;
+	for (; i + 8 <= nSamples; i += 8) {
+		__m256i* p = reinterpret_cast<__m256i*>(samples + i);
+		__m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(p));
+		_mm256_storeu_si256(p, _mm256_cvttps_epi32(_mm256_mul_ps(v, g)));
+	}
+	gainSamplesScalar(samples + i, nSamples - i, gain);
+}
+
+BT_TARGET_AVX2 void mixSamplesAvx2(int16_t* dest, const sample* fmL, const sample* fmR, const sample* ssg,
+								   size_t nSamples, float scale)
+{
+	const __m256 s = _mm256_set1_ps(scale);
+	const __m256 lo = _mm256_set1_ps(-32768.f);
+	const __m256 hi = _mm256_set1_ps(32767.f);
+
+	size_t i = 0;
+	for (; i + 8 <= nSamples; i += 8) {
+		__m256i ssgv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ssg + i));
+		__m256i l = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(fmL + i)), ssgv);
+		__m256i r = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(fmR + i)), ssgv);
+		l = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(l), s), lo), hi));
+		r = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(r), s), lo), hi));
+		// Unpack and pack work within 128-bit lanes, which keeps frames 0-3 and 4-7 in order
+		__m256i lr = _mm256_packs_epi32(_mm256_unpacklo_epi32(l, r), _mm256_unpackhi_epi32(l, r));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 2), lr);
+	}
+	mixSamplesSse2(dest + i * 2, fmL + i, fmR + i, ssg + i, nSamples - i, scale);
+}
+
+bool hasAvx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	// OSXSAVE and AVX, then the OS must save YMM registers
+	if ((info[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 6) != 6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & 0x20) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+struct Kernels
+{
+	GainFunc gain;
+	MixFunc mix;
+};
+
+Kernels selectKernels()
+{
+#ifdef BT_MIX_AVX2
+	if (hasAvx2()) return { gainSamplesAvx2, mixSamplesAvx2 };
+#endif
+#ifdef BT_MIX_SSE2
+	return { gainSamplesSse2, mixSamplesSse2 };
+#else
+	return { gainSamplesScalar, mixSamplesScalar };
+#endif
+}
+
+const Kernels& kernels()
+{
+	static const Kernels k = selectKernels();
+	return k;
+}
+}
+
+void gainSamples(sample* samples, size_t nSamples, float gain)
+{
+	kernels().gain(samples, nSamples, gain);
+}
+
+void mixSamples(int16_t* dest, const sample* fmL, const sample* fmR, const sample* ssg,
+				size_t nSamples, float scale)
+{
+	kernels().mix(dest, fmL, fmR, ssg, nSamples, scale);
+}
+}
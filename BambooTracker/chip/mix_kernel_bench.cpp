@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Microbenchmark of the gain and mix stages of OPNA::mix.
+// "before" is the double precision loop used before the kernels, "after" is the kernels.
+// Usage: mix_kernel_bench [frames per buffer] [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include "mix_kernel.hpp"
+
+namespace
+{
+constexpr float VOLUME_RATIO_MOD = 0.5f;
+
+inline double clamp(double value, double low, double high)
+{
+	return std::min<double>(std::max<double>(value, low), high);
+}
+
+void gainSamplesBefore(sample* samples, size_t nSamples, double gain)
+{
+	std::transform(samples, samples + nSamples, samples,
+				   [gain](sample s) { return static_cast<sample>(s * gain); });
+}
+
+void mixSamplesBefore(int16_t* dest, const sample* fmL, const sample* fmR, const sample* ssg, size_t nSamples)
+{
+	for (size_t i = 0; i < nSamples; ++i) {
+		*dest++ = static_cast<int16_t>(clamp((fmL[i] + ssg[i]) * VOLUME_RATIO_MOD, -32768, 32767));
+		*dest++ = static_cast<int16_t>(clamp((fmR[i] + ssg[i]) * VOLUME_RATIO_MOD, -32768, 32767));
+	}
+}
+
+struct Buffers
+{
+	std::vector<sample> fmL, fmR, ssg;
+	std::vector<int16_t> out;
+};
+
+template <class Func>
+double measure(const Buffers& src, Buffers& work, size_t iterations, Func func)
+{
+	auto begin = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; ++i) {
+		// Restore input because the gain stage works in place
+		std::copy(src.fmL.begin(), src.fmL.end(), work.fmL.begin());
+		std::copy(src.fmR.begin(), src.fmR.end(), work.fmR.begin());
+		std::copy(src.ssg.begin(), src.ssg.end(), work.ssg.begin());
+		func(work);
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(end - begin).count() / iterations;
+}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t nFrames = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 2048;
+	const size_t iterations = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20000;
+	if (!nFrames || !iterations) {
+		std::fprintf(stderr, "Usage: %s [frames per buffer] [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	// Emulator output range
+	std::mt19937 rng(1);
+	std::uniform_int_distribution<sample> dist(-40000, 40000);
+	Buffers src;
+	for (auto* buf : { &src.fmL, &src.fmR, &src.ssg }) {
+		buf->resize(nFrames);
+		std::generate(buf->begin(), buf->end(), [&] { return dist(rng); });
+	}
+	src.out.resize(nFrames * 2);
+	Buffers before = src, after = src;
+
+	const double gainFm = 0.8, gainSsg = 0.6;
+	// Subtract the cost of restoring input
+	double copy = measure(src, before, iterations, [](Buffers&) {});
+	double tBefore = measure(src, before, iterations, [&](Buffers& b) {
+		gainSamplesBefore(b.fmL.data(), nFrames, gainFm);
+		gainSamplesBefore(b.fmR.data(), nFrames, gainFm);
+		gainSamplesBefore(b.ssg.data(), nFrames, gainSsg);
+		mixSamplesBefore(b.out.data(), b.fmL.data(), b.fmR.data(), b.ssg.data(), nFrames);
+	});
+	double tAfter = measure(src, after, iterations, [&](Buffers& b) {
+		chip::gainSamples(b.fmL.data(), nFrames, static_cast<float>(gainFm));
+		chip::gainSamples(b.fmR.data(), nFrames, static_cast<float>(gainFm));
+		chip::gainSamples(b.ssg.data(), nFrames, static_cast<float>(gainSsg));
+		chip::mixSamples(b.out.data(), b.fmL.data(), b.fmR.data(), b.ssg.data(), nFrames, VOLUME_RATIO_MOD);
+	});
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < src.out.size(); ++i) {
+		if (before.out[i] != after.out[i]) ++mismatches;
+	}
+
+	std::printf("%zu frames, %zu iterations\n", nFrames, iterations);
+	std::printf("before: %.3f us per buffer\n", tBefore - copy);
+	std::printf("after:  %.3f us per buffer\n", tAfter - copy);
+	std::printf("mismatched samples: %zu\n", mismatches);
+	return mismatches ? 1 : 0;
+}
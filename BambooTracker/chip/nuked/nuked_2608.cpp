@@ -40,7 +40,7 @@ void setSsgClock(void *param, int clock)
 void writeSsg(void *param, int address, int data)
 {
 	auto state = reinterpret_cast<Nuked2608State*>(param);
-	if (state->ssg) PSG_writeIO(state->ssg, address, data);
+	if (state->ssg && !state->isSsgSeparated) PSG_writeIO(state->ssg, address, data);
 }
 
 int readSsg(void *param)
@@ -85,6 +85,7 @@ int Nuked2608::startDevice(int clock, int& rateSsg, uint32_t dramSize)
 
 	state_.clock = clock;
 	state_.dramSize = dramSize;
+	state_.isSsgSeparated = false;
 	OPN2_Reset(state_.chip, clock, &SSG_INTF, &state_, dramSize);
 
 	return clock / 144;	// FM synthesis rate is clock / 2 / 72
@@ -135,6 +136,26 @@ uint8_t Nuked2608::readData()
 	return OPN2_Read(state_.chip, 1);
 }
 
+void Nuked2608::writeSsgRegister(uint8_t address, uint8_t data)
+{
+	if (state_.ssg) {
+		PSG_writeIO(state_.ssg, 0, address);
+		PSG_writeIO(state_.ssg, 1, data);
+	}
+}
+
+void Nuked2608::setSsgSeparated(bool separated)
+{
+	state_.isSsgSeparated = separated;
+}
+
+void Nuked2608::writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size)
+{
+	YM_DELTAT& deltaT = state_.chip->deltaT;
+	if (address >= deltaT.memory_size) return;
+	std::copy_n(data, std::min<size_t>(size, deltaT.memory_size - address), deltaT.memory + address);
+}
+
 void Nuked2608::updateStream(sample** outputs, int nSamples)
 {
 	sample* bufl = outputs[STEREO_LEFT];
@@ -148,20 +169,15 @@ void Nuked2608::updateStream(sample** outputs, int nSamples)
 	}
 }
 
-void Nuked2608::updateSsgStream(sample** outputs, int nSamples)
+void Nuked2608::updateSsgStream(sample* output, int nSamples)
 {
 	if (state_.ssg) {
-		sample* bufl = outputs[STEREO_LEFT];
-		sample* bufr = outputs[STEREO_RIGHT];
 		for (int i = 0; i < nSamples; ++i) {
-			int16_t s = PSG_calc(state_.ssg) << 1;
-			*bufl++ = s;
-			*bufr++ = s;
+			*output++ = PSG_calc(state_.ssg) << 1;
 		}
 	}
 	else {
-		std::fill_n(outputs[STEREO_LEFT], nSamples, 0);
-		std::fill_n(outputs[STEREO_RIGHT], nSamples, 0);
+		std::fill_n(output, nSamples, 0);
 	}
 }
 }
@@ -42,6 +42,7 @@ struct Nuked2608State
 	PSG* ssg;
 	int clock;
 	uint32_t dramSize;
+	bool isSsgSeparated;
 };
 
 class Nuked2608 final : public Ym2608Interface
@@ -56,8 +57,11 @@ public:
 	void writeDataToPortA(uint8_t data) override;
 	void writeDataToPortB(uint8_t data) override;
 	uint8_t readData() override;
+	void writeSsgRegister(uint8_t address, uint8_t data) override;
+	void setSsgSeparated(bool separated) override;
+	void writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size) override;
 	void updateStream(sample** outputs, int nSamples) override;
-	void updateSsgStream(sample** outputs, int nSamples) override;
+	void updateSsgStream(sample* output, int nSamples) override;
 
 private:
 	Nuked2608State state_;
@@ -28,6 +28,7 @@
 #include <cmath>
 #include <algorithm>
 #include "register_write_logger.hpp"
+#include "mix_kernel.hpp"
 #include "mame/mame_2608.hpp"
 #include "nuked/nuked_2608.hpp"
 #include "ymfm/ymfm_2608.hpp"
@@ -46,39 +47,69 @@ constexpr double VOL_REDUC_ = 7.5;
 // 55466Hz: FM internal rate
 constexpr int DEFAULT_AUTO_RATE = 55466;
 
+// Capacity of each register write ring
+constexpr size_t REG_WRITE_RING_SIZE = 0x4000;
+
 enum SoundSourceIndex : int { FM = 0, SSG = 1 };
 
 enum WriteMode : int { WAIT_MODE = 0, IMMEDIATE_MODE = 1 };
 
-inline double clamp(double value, double low, double high)
+// 0x00-0x0F of port A
+inline bool isSsgRegister(uint32_t offset)
 {
-	return std::min<double>(std::max<double>(value, low), high);
+	return offset < 0x10;
 }
 
-void gainSamples(sample** samples, size_t nSamples, double gain)
+// 0x2D-0x2F of port A change the clocks of both FM and SSG
+inline bool isPrescalerRegister(uint32_t offset)
 {
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::transform(samples[pan], samples[pan] + nSamples, samples[pan],
-					   [gain](sample s) { return static_cast<sample>(s * gain); });
+	return 0x2d <= offset && offset <= 0x2f;
+}
+
+YmfmFidelity resolveYmfmFidelity(YmfmFidelity fidelity, int clock, int rate)
+{
+	if (fidelity != YmfmFidelity::Auto) return fidelity;
+	if (rate <= clock / 144) return YmfmFidelity::Minimum;
+	if (rate <= clock / 96) return YmfmFidelity::Medium;
+	return YmfmFidelity::Maximum;
+}
+
+ymfm::opn_fidelity toYmfmFidelity(YmfmFidelity fidelity)
+{
+	switch (fidelity) {
+	default:
+	case YmfmFidelity::Maximum:	return ymfm::OPN_FIDELITY_MAX;
+	case YmfmFidelity::Medium:	return ymfm::OPN_FIDELITY_MED;
+	case YmfmFidelity::Minimum:	return ymfm::OPN_FIDELITY_MIN;
 	}
 }
+
 }
 
-size_t OPNA::count_ = 0;
+std::atomic_size_t OPNA::count_(0);
 
-OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dramSize,
+OPNA::OPNA(OpnaEmulator emu, YmfmFidelity fidelity, int clock, int rate, size_t maxDuration, size_t dramSize,
 		   std::unique_ptr<AbstractResampler> fmResampler, std::unique_ptr<AbstractResampler> ssgResampler,
 		   std::shared_ptr<AbstractRegisterWriteLogger> logger)
 	: Chip(count_++, clock, rate, DEFAULT_AUTO_RATE, maxDuration,
 		   std::move(fmResampler), std::move(ssgResampler),
 		   logger),
+	  ymfm_(nullptr),
+	  fidelity_(resolveYmfmFidelity(fidelity, clock, rate ? rate : DEFAULT_AUTO_RATE)),
 	  volumeFm_(0),
 	  volumeSsg_(0),
 	  dramSize_(dramSize),
 	  rcIntf_(std::make_unique<SimpleRealChipInterface>()),
 	  isForcedRegWrite_(false),
+	  regWrites_(REG_WRITE_RING_SIZE),
+	  forcedRegWrites_(REG_WRITE_RING_SIZE),
+	  mixedSampleCount_(0),
 	  waitRestFm_(0),
 	  waitRestSsg2_(0),
+	  isSsgPipelined_(false),
+	  ssgJob_{ false, 0, 0 },
+	  hasSsgJob_(false),
+	  quitSsgWorker_(false),
 	  writeFuncs {
 		  // Wait mode
 { &OPNA::enqueueData, &OPNA::storeBufferForWait },
@@ -87,9 +118,7 @@ OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dra
 },
 	  writeFunc(&writeFuncs[WAIT_MODE])
 {
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		tmpBuf_[pan] = new sample[CHIP_SMPL_BUF_SIZE_];
-	}
+	funcSetRate(rate);
 
 	switch (emu) {
 	default:
@@ -104,16 +133,19 @@ OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dra
 		intf_ = std::make_unique<Nuked2608>();
 		break;
 	case OpnaEmulator::Ymfm:
+	{
 		fprintf(stderr, "Using emulator: ymfm\n");
-		intf_ = std::make_unique<Ymfm2608>();
+		auto ymfm = std::make_unique<Ymfm2608>(toYmfmFidelity(fidelity_));
+		ymfm_ = ymfm.get();
+		intf_ = std::move(ymfm);
 		break;
 	}
-
-	funcSetRate(rate);
+	}
 
 	internalRate_[FM] = intf_->startDevice(clock, internalRate_[SSG], dramSize);
-	rate2_ = static_cast<size_t>((internalRate_[SSG] << 1) / internalRate_[FM]);	// Should be "9"
+	rate2_ = static_cast<size_t>((internalRate_[SSG] << 1) / internalRate_[FM]);	// "9", or "3" and "2" in reduced ymfm fidelity
 
+	resampler_[SSG]->setChannelCount(1);
 	initResampler();
 
 	setVolumeFM(0);
@@ -124,12 +156,9 @@ OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dra
 
 OPNA::~OPNA()
 {
+	setSsgPipelineEnabled(false);
 	intf_->stopDevice();
 	--count_;
-
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		delete[] tmpBuf_[pan];
-	}
 }
 
 void OPNA::resetSpecific()
@@ -151,34 +180,78 @@ void OPNA::setImmediateWriteMode(bool enabled) noexcept
 
 bool OPNA::isImmediateWriteMode() const noexcept
 {
-	return writeFunc == &writeFuncs[IMMEDIATE_MODE];
+	return writeFunc.load() == &writeFuncs[IMMEDIATE_MODE];
 }
 
 void OPNA::setRegister(uint32_t offset, uint8_t value)
 {
-	std::lock_guard<std::mutex> lg(mutex_);
+	std::lock_guard<std::mutex> lg(producerMutex_);
 
 	if (logger_) {
+		logger_->setImmediateWriteMode(isImmediateWriteMode());
 		logger_->recordRegisterChange(offset, value);
 	}
 	else {
-		(this->*writeFunc->setRegister)(offset, value);
+		// The write lands at the output position where it is issued, then waits for the bus in wait mode
+		(this->*writeFunc.load()->setRegister)(getMixedSampleCount(), offset, value);
 	}
 
 	rcIntf_->setRegister(offset, value);
 }
 
-void OPNA::enqueueData(uint32_t offset, uint8_t value)
+void OPNA::enqueueData(uint64_t position, uint32_t offset, uint8_t value)
+{
+	pushData({ position, offset, value, false, nullptr, 0 });
+}
+
+void OPNA::writeDataImmediately(uint64_t position, uint32_t offset, uint8_t value)
 {
-	if (isForcedRegWrite_) {
-		forcedRegWrites_.push_back({ offset & 0x0ff, value, !(offset & 0x100) });
+	// The write lands at the start of the next buffer, same as when it waited for the running mix
+	pushData({ position, offset, value, true, nullptr, 0 });
+}
+
+void OPNA::pushData(const RegisterWriteRing::Entry& entry)
+{
+	RegisterWriteRing& ring = isForcedRegWrite_ ? forcedRegWrites_ : regWrites_;
+	while (!ring.push(entry)) {
+		// Ring is full: wait for mix to pop entries.
+		// If nothing is mixed, such as when the stream is stopped or mix runs on this thread,
+		// write the oldest entry here. mix waits for it instead of the writer waiting forever
+		std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			std::this_thread::yield();
+			continue;
+		}
+		if (const RegisterWriteRing::Entry* unit = ring.front()) {
+			writeEntry(*unit);
+			ring.pop();
+		}
 	}
-	else {
-		regWrites_.push_back({ offset & 0x0ff, value, !(offset & 0x100) });
+}
+
+void OPNA::flushData()
+{
+	for (RegisterWriteRing* ring : { &forcedRegWrites_, &regWrites_ }) {
+		while (const RegisterWriteRing::Entry* unit = ring->front()) {
+			writeEntry(*unit);
+			ring->pop();
+		}
 	}
 }
 
-void OPNA::writeDataImmediately(uint32_t offset, uint8_t value)
+void OPNA::writeEntry(const RegisterWriteRing::Entry& entry)
+{
+	if (entry.block) intf_->writeDRAMBlock(entry.offset, entry.block, entry.blockSize);
+	else writeToDevice(entry.offset, entry.value);
+}
+
+void OPNA::writeToDevice(uint32_t offset, uint8_t value)
+{
+	writeToPorts(offset, value);
+	if (isSsgPipelined_ && isSsgRegister(offset)) intf_->writeSsgRegister(offset & 0xff, value);
+}
+
+void OPNA::writeToPorts(uint32_t offset, uint8_t value)
 {
 	if (offset & 0x100) {
 		intf_->writeAddressToPortB(offset & 0xff);
@@ -199,7 +272,7 @@ uint8_t OPNA::getRegister(uint32_t offset) const
 
 void OPNA::setVolumeFM(double dB)
 {
-	std::lock_guard<std::mutex> lg(mutex_);
+	std::lock_guard<std::mutex> lg(volumeMutex_);
 	volumeFm_ = dB;
 	busVolumeRatio_[FM] = std::pow(10.0, (dB - VOL_REDUC_) / 20.0) / VOLUME_RATIO_MOD_;
 	updateVolumeRatio(FM);
@@ -207,7 +280,7 @@ void OPNA::setVolumeFM(double dB)
 
 void OPNA::setVolumeSSG(double dB)
 {
-	std::lock_guard<std::mutex> lg(mutex_);
+	std::lock_guard<std::mutex> lg(volumeMutex_);
 	volumeSsg_ = dB;
 	busVolumeRatio_[SSG] = std::pow(10.0, (dB - VOL_REDUC_) / 20.0) / VOLUME_RATIO_MOD_;
 	updateVolumeRatio(SSG);
@@ -220,72 +293,62 @@ size_t OPNA::getDRAMSize() const noexcept
 	return dramSize_;
 }
 
+void OPNA::writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size)
+{
+	std::lock_guard<std::mutex> lg(producerMutex_);
+
+	if (logger_) {
+		logger_->setImmediateWriteMode(isImmediateWriteMode());
+		for (size_t i = 0; i < size; ++i) logger_->recordRegisterChange(0x108, data[i]);
+	}
+	else {
+		// Free the uploads already written by mix
+		while (!dramUploads_.empty() && dramUploads_.front().ring->hasPopped(dramUploads_.front().index)) {
+			dramUploads_.pop_front();
+		}
+
+		// Pass a copy through the ring so that mix writes it without a lock
+		auto copy = std::make_unique<uint8_t[]>(size);
+		std::copy_n(data, size, copy.get());
+		const RegisterWriteRing& ring = isForcedRegWrite_ ? forcedRegWrites_ : regWrites_;
+		dramUploads_.push_back({ &ring, ring.getPushIndex(), std::move(copy) });
+		pushData({ getMixedSampleCount(), address, 0, true, dramUploads_.back().data.get(), size });
+	}
+
+	if (rcIntf_->hasConnected()) {
+		for (size_t i = 0; i < size; ++i) rcIntf_->setRegister(0x108, data[i]);
+	}
+}
+
 bool OPNA::mix(int16_t* stream, size_t nSamples)
 {
+	// Register writers do not hold it while mix is running, so only a configuration change can make it wait
 	std::lock_guard<std::mutex> lg(mutex_);
 
 	size_t pointFm = 0;
 	size_t pointSsg = 0;
 
 	// Store samples to internal buffer
-	bool result = (this->*writeFunc->storeBuffer)(nSamples, pointFm, pointSsg);
+	bool result = (this->*writeFunc.load()->storeBuffer)(nSamples, pointFm, pointSsg);
 	if (!result) return false;
 
 	// Gain volume
-	gainSamples(buffer_[FM], pointFm, volumeRatio_[FM]);
-	gainSamples(buffer_[SSG], pointSsg, volumeRatio_[SSG]);
+	const auto gainFm = static_cast<float>(volumeRatio_[FM].load());
+	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
+		gainSamples(buffer_[FM][pan], pointFm, gainFm);
+	}
+	gainSamples(buffer_[SSG][STEREO_LEFT], pointSsg, static_cast<float>(volumeRatio_[SSG].load()));
 
 	// Resampling
 	sample** bufFM = resampler_[FM]->interpolate(buffer_[FM], nSamples, pointFm);
 	sample** bufSSG = resampler_[SSG]->interpolate(buffer_[SSG], nSamples, pointSsg);
 
-	// Mix
-	int16_t* p = stream;
-	for (size_t i = 0; i < nSamples; ++i) {
-		for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-			*p++ = static_cast<int16_t>(clamp((bufFM[pan][i] + bufSSG[pan][i]) * VOLUME_RATIO_MOD_, -32768, 32767));
-		}
-	}
+	// Mix (SSG is mono and panned to the center)
+	mixSamples(stream, bufFM[STEREO_LEFT], bufFM[STEREO_RIGHT], bufSSG[STEREO_LEFT], nSamples, VOLUME_RATIO_MOD_);
 
-	return true;
-}
-
-/**
- * @brief OPNA::dequeueData
- * @return wait count as FM internal sample rate
- */
-size_t OPNA::dequeueData()
-{
-	size_t waitCount = 0;
-
-	if (!forcedRegWrites_.empty()) {
-		auto& unit = forcedRegWrites_.front();
-		if (unit.isPortA_) {
-			intf_->writeAddressToPortA(unit.address & 0xff);
-			intf_->writeDataToPortA(unit.data & 0xff);
-		}
-		else {
-			intf_->writeAddressToPortB(unit.address & 0xff);
-			intf_->writeDataToPortB(unit.data & 0xff);
-		}
-		waitCount = unit.address == 0x10 ? 4 : 1;
-		forcedRegWrites_.pop_front();
-	}
-	else if (!regWrites_.empty()) {
-		auto& unit = regWrites_.front();
-		if (unit.isPortA_) {
-			intf_->writeAddressToPortA(unit.address & 0xff);
-			intf_->writeDataToPortA(unit.data & 0xff);
-		}
-		else {
-			intf_->writeAddressToPortB(unit.address & 0xff);
-			intf_->writeDataToPortB(unit.data & 0xff);
-		}
-		waitCount = unit.address == 0x10 ? 4 : 1;
-		regWrites_.pop_front();
-	}
+	mixedSampleCount_.fetch_add(nSamples, std::memory_order_release);
 
-	return waitCount;
+	return true;
 }
 
 bool OPNA::storeBufferForImmediate(size_t nSamples, size_t& pointFm, size_t& pointSsg)
@@ -293,43 +356,51 @@ bool OPNA::storeBufferForImmediate(size_t nSamples, size_t& pointFm, size_t& poi
 	bool ok = false;
 	size_t intrSizeFm = resampler_[FM]->calculateInternalSampleSize(nSamples, ok);
 	if (!ok) return false;
-	intf_->updateStream(tmpBuf_, intrSizeFm);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], intrSizeFm, buffer_[FM][pan] + pointFm);
-	}
-	pointFm += intrSizeFm;
-
 	size_t intrSizeSsg = resampler_[SSG]->calculateInternalSampleSize(nSamples, ok);
 	if (!ok) return false;
-	intf_->updateSsgStream(tmpBuf_, intrSizeSsg);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], intrSizeSsg, buffer_[SSG][pan] + pointSsg);
+
+	flushData();
+
+	if (isSsgPipelined_) {
+		startSsgJob({ false, pointSsg, intrSizeSsg });
+		generateFm(pointFm, intrSizeFm);
+		waitSsgJob();
 	}
+	else {
+		generateFm(pointFm, intrSizeFm);
+		generateSsg(pointSsg, intrSizeSsg);
+	}
+	pointFm += intrSizeFm;
 	pointSsg += intrSizeSsg;
 
 	return true;
 }
 
-void OPNA::flushWait(size_t& pointFm, size_t maxFm, size_t& pointSsg2, size_t maxSsg2)
+void OPNA::generateFm(size_t point, size_t size)
+{
+	sample* outputs[2] = { buffer_[FM][STEREO_LEFT] + point, buffer_[FM][STEREO_RIGHT] + point };
+	intf_->updateStream(outputs, static_cast<int>(size));
+}
+
+void OPNA::generateSsg(size_t point, size_t size)
+{
+	intf_->updateSsgStream(buffer_[SSG][STEREO_LEFT] + point, static_cast<int>(size));
+}
+
+void OPNA::planWait(size_t& pointFm, size_t maxFm, size_t& pointSsg2, size_t maxSsg2)
 {
 	size_t sizeFm = std::min(waitRestFm_, maxFm - pointFm);
-	intf_->updateStream(tmpBuf_, sizeFm);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], sizeFm, buffer_[FM][pan] + pointFm);
-	}
 	waitRestFm_ -= sizeFm;
 	pointFm += sizeFm;
 
 	size_t pointSsg = pointSsg2 >> 1;
 	size_t endPointSsg2 = std::min(pointSsg2 + waitRestSsg2_, maxSsg2);
 	size_t sizeSsg = (endPointSsg2 >> 1) - pointSsg;
-	intf_->updateSsgStream(tmpBuf_, sizeSsg);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], sizeSsg, buffer_[SSG][pan] + pointSsg);
-	}
 	size_t sizeSsg2 = endPointSsg2 - pointSsg2;
 	waitRestSsg2_ -= sizeSsg2;
 	pointSsg2 += sizeSsg2;
+
+	waitSteps_.push_back({ sizeFm, sizeSsg, false, 0, 0 });
 }
 
 bool OPNA::storeBufferForWait(size_t nSamples, size_t& pointFm, size_t& pointSsg)
@@ -340,44 +411,155 @@ bool OPNA::storeBufferForWait(size_t nSamples, size_t& pointFm, size_t& pointSsg
 	size_t intrSizeSsg2 = resampler_[SSG]->calculateInternalSampleSize(nSamples, ok) << 1;
 	if (!ok) return false;
 
+	const size_t startFm = pointFm;
+	const size_t startSsg = pointSsg;
 	size_t pointSsg2 = pointSsg << 1;
+	bool hasPrescalerWrite = false;
+	waitSteps_.clear();
 
 	// Flush previous wait
-	flushWait(pointFm, intrSizeFm, pointSsg2, intrSizeSsg2);
+	planWait(pointFm, intrSizeFm, pointSsg2, intrSizeSsg2);
 
-	// Wait and generate
+	// Wait and write
+	const uint64_t basePosition = mixedSampleCount_.load(std::memory_order_relaxed);
 	while (pointFm < intrSizeFm || pointSsg2 < intrSizeSsg2) {
-		size_t waitCount = dequeueData();
-		if (!waitCount) break;
+		RegisterWriteRing& ring = forcedRegWrites_.front() ? forcedRegWrites_ : regWrites_;
+		const RegisterWriteRing::Entry* unit = ring.front();
+		if (!unit) break;
+
+		// Wait until the position where the write lands
+		if (!unit->isImmediate && unit->position > basePosition) {
+			uint64_t offset = unit->position - basePosition;
+			if (offset >= nSamples) break;	// Write in later buffers
+			size_t targetFm = static_cast<size_t>(offset * intrSizeFm / nSamples);
+			size_t targetSsg2 = static_cast<size_t>(offset * intrSizeSsg2 / nSamples);
+			if (pointFm + waitRestFm_ < targetFm) waitRestFm_ = targetFm - pointFm;
+			if (pointSsg2 + waitRestSsg2_ < targetSsg2) waitRestSsg2_ = targetSsg2 - pointSsg2;
+			planWait(pointFm, intrSizeFm, pointSsg2, intrSizeSsg2);
+		}
+
+		if (unit->block) {
+			// DRAM is written before the plan runs, as the data is freed after it is popped.
+			// ADPCM is stopped while samples are uploaded, so it is not heard
+			intf_->writeDRAMBlock(unit->offset, unit->block, unit->blockSize);
+			ring.pop();
+			continue;
+		}
+
+		waitSteps_.push_back({ 0, 0, true, unit->offset, unit->value });
+		hasPrescalerWrite |= isPrescalerRegister(unit->offset);
+		size_t waitCount = ((unit->offset & 0xff) == 0x10) ? 4 : 1;
+		bool isImmediate = unit->isImmediate;
+		ring.pop();
+		if (isImmediate) continue;	// Queued in immediate-write mode
 
 		// Add wait count
 		waitRestFm_ += waitCount;
 		waitRestSsg2_ += rate2_ * waitCount;
-		flushWait(pointFm, intrSizeFm, pointSsg2, intrSizeSsg2);
+		planWait(pointFm, intrSizeFm, pointSsg2, intrSizeSsg2);
 	}
 
 	// Generate rest samples
 	size_t sizeFm = intrSizeFm - pointFm;
-	intf_->updateStream(tmpBuf_, sizeFm);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], sizeFm, buffer_[FM][pan] + pointFm);
-	}
 	if (sizeFm <= waitRestFm_) waitRestFm_ -= sizeFm;
 	pointFm += sizeFm;
 
-	pointSsg = pointSsg2 >> 1;
-	size_t sizeSsg = (intrSizeSsg2 >> 1) - pointSsg;
-	intf_->updateSsgStream(tmpBuf_, sizeSsg);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], sizeSsg, buffer_[SSG][pan] + pointSsg);
-	}
+	size_t sizeSsg = (intrSizeSsg2 >> 1) - (pointSsg2 >> 1);
 	size_t sizeSsg2 = intrSizeSsg2 - pointSsg2;
 	if (sizeSsg2 <= waitRestSsg2_) waitRestSsg2_ -= sizeSsg2;
 	pointSsg = (pointSsg2 + sizeSsg2) >> 1;
 
+	waitSteps_.push_back({ sizeFm, sizeSsg, false, 0, 0 });
+
+	// Run the plan
+	if (isSsgPipelined_ && !hasPrescalerWrite) {
+		startSsgJob({ true, startSsg, 0 });
+		runWaitSteps(startFm, 0, true, false);
+		waitSsgJob();
+	}
+	else {
+		runWaitSteps(startFm, startSsg, true, true);
+	}
+
 	return true;
 }
 
+void OPNA::runWaitSteps(size_t pointFm, size_t pointSsg, bool runsFm, bool runsSsg)
+{
+	for (const WaitStep& step : waitSteps_) {
+		if (step.isWrite) {
+			if (runsFm) writeToPorts(step.offset, step.value);
+			if (runsSsg && isSsgPipelined_ && isSsgRegister(step.offset)) {
+				intf_->writeSsgRegister(step.offset & 0xff, step.value);
+			}
+			continue;
+		}
+		if (runsFm) {
+			generateFm(pointFm, step.sizeFm);
+			pointFm += step.sizeFm;
+		}
+		if (runsSsg) {
+			generateSsg(pointSsg, step.sizeSsg);
+			pointSsg += step.sizeSsg;
+		}
+	}
+}
+
+void OPNA::setSsgPipelineEnabled(bool enabled)
+{
+	std::lock_guard<std::mutex> lg(mutex_);
+	if (enabled == ssgWorker_.joinable()) return;
+
+	if (enabled) {
+		quitSsgWorker_ = false;
+		ssgWorker_ = std::thread([this] { ssgWorkerRun(); });
+	}
+	else {
+		{
+			std::lock_guard<std::mutex> lock(ssgMutex_);
+			quitSsgWorker_ = true;
+		}
+		ssgCond_.notify_all();
+		ssgWorker_.join();
+	}
+	isSsgPipelined_ = enabled;
+	intf_->setSsgSeparated(enabled);
+}
+
+void OPNA::startSsgJob(const SsgJob& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(ssgMutex_);
+		ssgJob_ = job;
+		hasSsgJob_ = true;
+	}
+	ssgCond_.notify_all();
+}
+
+void OPNA::waitSsgJob()
+{
+	std::unique_lock<std::mutex> lock(ssgMutex_);
+	ssgCond_.wait(lock, [this] { return !hasSsgJob_; });
+}
+
+void OPNA::ssgWorkerRun()
+{
+	std::unique_lock<std::mutex> lock(ssgMutex_);
+	while (true) {
+		ssgCond_.wait(lock, [this] { return hasSsgJob_ || quitSsgWorker_; });
+		if (quitSsgWorker_) return;
+
+		SsgJob job = ssgJob_;
+		lock.unlock();
+		if (job.isWaitSteps) runWaitSteps(0, job.point, false, true);
+		else generateSsg(job.point, job.size);
+		lock.lock();
+
+		hasSsgJob_ = false;
+		ssgCond_.notify_all();
+	}
+}
+
 void OPNA::setFmResampler(std::unique_ptr<AbstractResampler> resampler)
 {
 	std::lock_guard<std::mutex> lg(mutex_);
@@ -389,6 +571,19 @@ void OPNA::setSsgResampler(std::unique_ptr<AbstractResampler> resampler)
 {
 	std::lock_guard<std::mutex> lg(mutex_);
 	resampler_[SSG] = std::move(resampler);
+	resampler_[SSG]->setChannelCount(1);
+	initResampler();
+}
+
+void OPNA::setYmfmFidelity(YmfmFidelity fidelity)
+{
+	if (!ymfm_ || fidelity == YmfmFidelity::Auto) return;
+
+	std::lock_guard<std::mutex> lg(mutex_);
+	internalRate_[SSG] = ymfm_->setFidelity(toYmfmFidelity(fidelity));
+	size_t prevRate2 = rate2_;
+	rate2_ = static_cast<size_t>((internalRate_[SSG] << 1) / internalRate_[FM]);
+	waitRestSsg2_ = waitRestSsg2_ * rate2_ / prevRate2;	// Keep the pending wait at the new rate
 	initResampler();
 }
 
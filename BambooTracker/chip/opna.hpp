@@ -27,13 +27,21 @@
 
 #include "chip.hpp"
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
 #include <deque>
 #include "resampler.hpp"
+#include "register_write_ring.hpp"
 #include "2608_interface.hpp"
 #include "real_chip_interface.hpp"
 
 namespace chip
 {
+class Ymfm2608;
+
 enum class OpnaEmulator
 {
 	Mame,
@@ -43,12 +51,21 @@ enum class OpnaEmulator
 	Last = Ymfm,
 };
 
+/// Rate at which ymfm generates SSG. Other emulators always use clock / 32.
+enum class YmfmFidelity : int
+{
+	Maximum = 0,	// clock / 32, the native SSG rate
+	Medium,			// clock / 96
+	Minimum,		// clock / 144, same as FM
+	Auto			// The lowest one not below the output rate at creation
+};
+
 class OPNA final : public Chip
 {
 public:
 	// [rate]
 	// 0 = rate is 55466 (FM synthesis rate when clock is 3993600 * 2)
-	OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dramSize,
+	OPNA(OpnaEmulator emu, YmfmFidelity fidelity, int clock, int rate, size_t maxDuration, size_t dramSize,
 		 std::unique_ptr<AbstractResampler> fmResampler = std::make_unique<BlipResampler>(),
 		 std::unique_ptr<AbstractResampler> ssgResampler = std::make_unique<BlipResampler>(),
 		 std::shared_ptr<AbstractRegisterWriteLogger> logger = nullptr);
@@ -58,6 +75,7 @@ public:
 	bool isImmediateWriteMode() const noexcept;
 	void setForcedWriteMode(bool enabled) noexcept { isForcedRegWrite_ = enabled; }
 	void setRegister(uint32_t offset, uint8_t value) override;
+	uint64_t getMixedSampleCount() const noexcept { return mixedSampleCount_.load(std::memory_order_acquire); }
 	uint8_t getRegister(uint32_t offset) const override;
 	void setVolumeFM(double dB);
 	double getVolumeFM() const noexcept { return volumeFm_; }
@@ -65,6 +83,17 @@ public:
 	double getVolumeSSG() const noexcept { return volumeSsg_; }
 	size_t getDRAMSize() const noexcept;
 
+	/**
+	 * @brief write a block of ADPCM data to DRAM.
+	 * @param address byte address in DRAM.
+	 * @param data data to write.
+	 * @param size data size.
+	 * @note The emulator memory is written at once at the start of the next buffer.
+	 *       Loggers and real chips are fed through register 0x108,
+	 *       so the ADPCM start address must have been set to @p address beforehand.
+	 */
+	void writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size);
+
 	/**
 	 * @brief mix samples.
 	 * @param stream buffer where mixed samples are stored.
@@ -80,11 +109,30 @@ public:
 	RealChipInterfaceType getRealChipInterfaceType() const;
 	bool hasConnectedToRealChip() const;
 
+	/**
+	 * @brief Generate SSG on a worker thread while FM is generated on the thread calling mix.
+	 * @note SSG registers are written to the SSG part directly in this mode.
+	 *       The writes land at the same sample positions as in serial generation.
+	 */
+	void setSsgPipelineEnabled(bool enabled);
+	bool isSsgPipelineEnabled() const noexcept { return isSsgPipelined_; }
+
+	/// ymfm fidelity resolved at creation. It is never Auto.
+	YmfmFidelity getYmfmFidelity() const noexcept { return fidelity_; }
+	bool isYmfm() const noexcept { return ymfm_ != nullptr; }
+	/**
+	 * @brief Change the ymfm fidelity while playing, without restarting the chip.
+	 * @note It does nothing with other emulators. getYmfmFidelity keeps returning the one at creation.
+	 */
+	void setYmfmFidelity(YmfmFidelity fidelity);
+
 private:
-	static size_t count_;
+	static std::atomic_size_t count_;
 
 	std::unique_ptr<Ym2608Interface> intf_;
-	double volumeFm_, volumeSsg_;
+	Ymfm2608* ymfm_;	// intf_ if it is ymfm, otherwise null
+	const YmfmFidelity fidelity_;
+	std::atomic<double> volumeFm_, volumeSsg_;
 	constexpr static int VOLUME_RATIO_MOD_ = 2;
 	size_t dramSize_;
 
@@ -92,33 +140,71 @@ private:
 
 	void resetSpecific() override;
 
-	struct RegisterWrite
-	{
-		uint32_t address;
-		uint8_t data;
-		bool isPortA_;
-	};
-
+	// Register writes are pushed by the threads calling setRegister and popped by the thread calling mix,
+	// also in immediate-write mode. Writers are serialized by producerMutex_, so mix never waits for them.
+	// A writer finding a full ring waits for mix to pop entries.
 	bool isForcedRegWrite_;
-	std::deque<RegisterWrite> regWrites_, forcedRegWrites_;
+	RegisterWriteRing regWrites_, forcedRegWrites_;
+	std::mutex producerMutex_;
+	std::atomic<uint64_t> mixedSampleCount_;
 
-	void enqueueData(uint32_t offset, uint8_t value);
-	void writeDataImmediately(uint32_t offset, uint8_t value);
+	// DRAM data referred by ring entries, freed by the writer after mix pops them
+	struct DramUpload
+	{
+		const RegisterWriteRing* ring;
+		size_t index;
+		std::unique_ptr<uint8_t[]> data;
+	};
+	std::deque<DramUpload> dramUploads_;
 
-	size_t dequeueData();
+	void enqueueData(uint64_t position, uint32_t offset, uint8_t value);
+	void writeDataImmediately(uint64_t position, uint32_t offset, uint8_t value);
+	void pushData(const RegisterWriteRing::Entry& entry);
+	void flushData();
+	void writeEntry(const RegisterWriteRing::Entry& entry);
+	void writeToDevice(uint32_t offset, uint8_t value);
+	void writeToPorts(uint32_t offset, uint8_t value);
 
 	size_t waitRestFm_, waitRestSsg2_;
 	size_t rate2_;
-	sample* tmpBuf_[2];
 	bool storeBufferForImmediate(size_t nSamples, size_t& pointFm, size_t& pointSsg);
 	bool storeBufferForWait(size_t nSamples, size_t& pointFm, size_t& pointSsg);
-	void flushWait(size_t& pointFm, size_t maxFm, size_t& pointSsg2, size_t maxSsg2);
+	void generateFm(size_t point, size_t size);
+	void generateSsg(size_t point, size_t size);
+
+	// Wait mode generation is planned before running it, so that FM and SSG can follow the plan separately.
+	// A step either generates samples or writes a register.
+	struct WaitStep
+	{
+		size_t sizeFm, sizeSsg;
+		bool isWrite;
+		uint32_t offset;
+		uint8_t value;
+	};
+	std::vector<WaitStep> waitSteps_;
+	void planWait(size_t& pointFm, size_t maxFm, size_t& pointSsg2, size_t maxSsg2);
+	void runWaitSteps(size_t pointFm, size_t pointSsg, bool runsFm, bool runsSsg);
+
+	// SSG pipeline
+	bool isSsgPipelined_;
+	struct SsgJob
+	{
+		bool isWaitSteps;
+		size_t point, size;
+	} ssgJob_;
+	bool hasSsgJob_, quitSsgWorker_;
+	std::mutex ssgMutex_;
+	std::condition_variable ssgCond_;
+	std::thread ssgWorker_;
+	void startSsgJob(const SsgJob& job);
+	void waitSsgJob();
+	void ssgWorkerRun();
 
 	struct WriteModeFuncs
 	{
-		void (OPNA::*setRegister)(uint32_t, uint8_t);
+		void (OPNA::*setRegister)(uint64_t, uint32_t, uint8_t);
 		bool (OPNA::*storeBuffer)(size_t, size_t&, size_t&);
 	} writeFuncs[2];
-	WriteModeFuncs* writeFunc;
+	std::atomic<WriteModeFuncs*> writeFunc;
 };
 }
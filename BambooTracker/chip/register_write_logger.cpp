@@ -25,44 +25,284 @@
 
 #include "register_write_logger.hpp"
 #include "io/export_io.hpp"
+#include "io/export_sink.hpp"
 #include <algorithm>
-#include <iterator>
+#include <cstdint>
 
 namespace chip
 {
-AbstractRegisterWriteLogger::AbstractRegisterWriteLogger(int target)
+namespace
+{
+/// Writes to these registers act on the chip even if the value does not change.
+bool hasSideEffect(uint32_t offset)
+{
+	switch (offset) {
+	case 0x0d:	// SSG envelope shape restarts the envelope
+	case 0x0e:	// I/O port A
+	case 0x0f:	// I/O port B
+	case 0x10:	// Rhythm key on/dump
+	case 0x27:	// Timer control and flag reset
+	case 0x28:	// FM key on/off
+	case 0x2d:	// Prescaler
+	case 0x2e:
+	case 0x2f:
+	case 0x100:	// ADPCM control starts and resets playback
+	case 0x108:	// ADPCM data goes through FIFO
+	case 0x10e:	// DAC data
+	case 0x10f:
+	case 0x110:	// Flag control
+		return true;
+	default:
+		return false;
+	}
+}
+
+/// Block and F-number 2, which is latched until the F-number 1 is written.
+inline bool isFnumLatchRegister(uint32_t reg)
+{
+	return (0xa4 <= reg && reg <= 0xa6) || (0xac <= reg && reg <= 0xae);
+}
+
+inline bool isFnumRegister(uint32_t reg)
+{
+	return (0xa0 <= reg && reg <= 0xa2) || (0xa8 <= reg && reg <= 0xaa);
+}
+
+/// Wait commands which fit the interrupt rate, written without optimization.
+template <class Put>
+void writeVgmWaitByRate(uint64_t wait, uint32_t intrRate, Put put)
+{
+	while (wait) {
+		uint32_t sub;
+
+		if (intrRate == 50) {
+			if (wait > 65535) {
+				uint32_t tmp = static_cast<uint32_t>(wait - 65535);
+				if (tmp <= 882) {
+					//65535 - (882 - tmp)
+					sub = 64653 + tmp;
+				}
+				else if (tmp <= 1764) {
+					//65535 - (1764 - tmp)
+					sub = 63771 + tmp;
+				}
+				else if (tmp <= 2646) {
+					//65535 - (2646 - tmp)
+					sub = 62889 + tmp;
+				}
+				else {
+					sub = 65535;
+				}
+				put(0x61);
+				put(sub & 0x00ff);
+				put(static_cast<uint8_t>(sub >> 8));
+			}
+			else {
+				if (wait <= 16) {
+					put(static_cast<uint8_t>(0x70 | (wait - 1)));
+				}
+				else if (wait > 2646) {
+					put(0x61);
+					put(wait & 0x00ff);
+					put(static_cast<uint8_t>(wait >> 8));
+				}
+				else if (wait == 2646) {
+					put(0x63);
+					put(0x63);
+					put(0x63);
+				}
+				else if (1764 <= wait && wait <= 1780) {
+					uint32_t tmp = static_cast<uint32_t>(wait - 1764);
+					put(0x63);
+					put(0x63);
+					if (tmp) put(0x70 | (tmp - 1));
+				}
+				else if (882 <= wait && wait <= 898) {
+					uint32_t tmp = static_cast<uint32_t>(wait - 882);
+					put(0x63);
+					if (tmp) put(0x70 | (tmp - 1));
+				}
+				else {
+					put(0x61);
+					put(wait & 0x00ff);
+					put(static_cast<uint8_t>(wait >> 8));
+				}
+				sub = static_cast<uint32_t>(wait);
+			}
+		}
+		else if (intrRate == 60) {
+			if (wait > 65535) {
+				uint32_t tmp = static_cast<uint32_t>(wait - 65535);
+				if (tmp <= 735) {
+					//65535 - (735 - tmp)
+					sub = 64800 + tmp;
+				}
+				else if (tmp <= 1470) {
+					//65535 - (1470 - tmp)
+					sub = 64065 + tmp;
+				}
+				else if (tmp <= 2205) {
+					//65535 - (2205 - tmp)
+					sub = 63330 + tmp;
+				}
+				else {
+					sub = 65535;
+				}
+				put(0x61);
+				put(sub & 0x00ff);
+				put(sub >> 8);
+			}
+			else {
+				if (wait <= 16) {
+					put(static_cast<uint8_t>(0x70 | (wait - 1)));
+				}
+				else if (wait > 2205) {
+					put(0x61);
+					put(wait & 0x00ff);
+					put(static_cast<uint8_t>(wait >> 8));
+				}
+				else if (wait == 2205) {
+					put(0x62);
+					put(0x62);
+					put(0x62);
+				}
+				else if (1470 <= wait && wait <= 1486) {
+					uint32_t tmp = static_cast<uint32_t>(wait - 1470);
+					put(0x62);
+					put(0x62);
+					if (tmp) put(0x70 | (tmp - 1));
+				}
+				else if (735 <= wait && wait <= 751) {
+					uint32_t tmp = static_cast<uint32_t>(wait - 735);
+					put(0x62);
+					if (tmp) put(0x70 | (tmp - 1));
+				}
+				else {
+					put(0x61);
+					put(wait & 0x00ff);
+					put(static_cast<uint8_t>(wait >> 8));
+				}
+				sub = static_cast<uint32_t>(wait);
+			}
+		}
+		else {
+			if (wait > 65535) {
+				sub = 65535;
+				put(0x61);
+				put(sub & 0x00ff);
+				put(sub >> 8);
+			}
+			else {
+				put(0x61);
+				put(wait & 0x00ff);
+				put(static_cast<uint8_t>(wait >> 8));
+				sub = static_cast<uint32_t>(wait);
+			}
+		}
+
+		wait -= sub;
+	}
+}
+
+constexpr uint32_t MAX_VGM_SHORT_WAIT = 0xffff + 32;
+
+/// Bytes of 0x7n commands for the wait.
+constexpr size_t getVgmTinyWaitSize(uint32_t wait)
+{
+	return (wait + 15) / 16;
+}
+
+/// Shortest commands of 0x61, 0x62 (735 samples), 0x63 (882 samples) and 0x7n for the wait.
+template <class Put>
+void writeShortestVgmWait(uint32_t wait, Put put)
+{
+	// Split one 0x61 command and a remainder of up to 32 samples
+	auto restSize = [](uint32_t rest) -> size_t {
+		if (rest <= 32) return getVgmTinyWaitSize(rest);
+		if (rest <= 0xffff) return 3;
+		return 3 + getVgmTinyWaitSize(rest - 0xffff);
+	};
+
+	size_t bestSize = SIZE_MAX;
+	uint32_t best62 = 0, best63 = 0;
+	for (uint32_t n63 = 0; n63 <= 3; ++n63) {
+		for (uint32_t n62 = 0; n62 <= 3; ++n62) {
+			uint32_t sub = 735 * n62 + 882 * n63;
+			if (wait < sub) continue;
+			size_t size = n62 + n63 + restSize(wait - sub);
+			if (size < bestSize) {
+				bestSize = size;
+				best62 = n62;
+				best63 = n63;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < best62; ++i) put(0x62);
+	for (uint32_t i = 0; i < best63; ++i) put(0x63);
+	uint32_t rest = wait - 735 * best62 - 882 * best63;
+	if (rest > 32) {
+		uint32_t sub = std::min<uint32_t>(rest, 0xffff);
+		put(0x61);
+		put(sub & 0xff);
+		put(static_cast<uint8_t>(sub >> 8));
+		rest -= sub;
+	}
+	for (; rest > 16; rest -= 16) put(0x7f);
+	if (rest) put(static_cast<uint8_t>(0x70 | (rest - 1)));
+}
+
+/// Bytes of S98 sync commands.
+size_t getS98WaitSize(uint64_t wait)
+{
+	if (wait == 1) return 1;
+	size_t size = 2;
+	for (wait -= 2; wait >>= 7;) ++size;
+	return size;
+}
+}
+
+AbstractRegisterWriteLogger::AbstractRegisterWriteLogger(int target, io::ExportSink* sink)
 	: target_(target),
+	  sink_(sink),
+	  base_(sink ? sink->size() : 0),
 	  lastWait_(0),
 	  isSetLoop_(false),
 	  loopPoint_(0),
-	  totalSampCnt_(0)
+	  isImmediate_(false),
+	  isOptimized_(false),
+	  totalSampCnt_(0),
+	  droppedWrites_(0),
+	  legacyWait_(0),
+	  legacyWaitBytes_(0),
+	  waitBytes_(0),
+	  shadow_{},
+	  isFnumLatched_{ false, false }
 {
 }
 
 void AbstractRegisterWriteLogger::elapse(size_t count) noexcept
 {
 	lastWait_ += count;
+	legacyWait_ += count;
 	totalSampCnt_ += count;
 }
 
 bool AbstractRegisterWriteLogger::empty() const noexcept
 {
-	return (buf_.empty() || lastWait_ != 0);
+	return (!getCommandsSize() || lastWait_ != 0);
 }
 
-void AbstractRegisterWriteLogger::clear() noexcept
+void AbstractRegisterWriteLogger::flushWait()
 {
-	buf_.clear();
-	lastWait_ = 0;
-	totalSampCnt_ = 0;
-	isSetLoop_ = false;
-	loopPoint_ = 0;
+	splitLegacyWait();
+	if (lastWait_) writeWait();
 }
 
-std::vector<uint8_t> AbstractRegisterWriteLogger::getData()
+void AbstractRegisterWriteLogger::splitWait()
 {
-	if (lastWait_) setWait();
-	return buf_;
+	if (isOptimized_) splitLegacyWait();
+	else if (lastWait_) setWait();
 }
 
 size_t AbstractRegisterWriteLogger::getSampleLength() const noexcept
@@ -72,24 +312,99 @@ size_t AbstractRegisterWriteLogger::getSampleLength() const noexcept
 
 size_t AbstractRegisterWriteLogger::setLoopPoint()
 {
-	if (lastWait_) setWait();
+	splitLegacyWait();
+	if (lastWait_) writeWait();
 	isSetLoop_ = true;
+	// Registers may have other values when the playback jumps back here
+	isKnown_.reset();
+	isFnumLatched_[0] = isFnumLatched_[1] = false;
 	return loopPoint_;
 }
 
 size_t AbstractRegisterWriteLogger::forceMoveLoopPoint() noexcept
 {
-	loopPoint_ = buf_.size();
+	loopPoint_ = getCommandsSize();
 	return loopPoint_;
 }
 
+void AbstractRegisterWriteLogger::put(uint8_t v)
+{
+	sink_->appendUint8(v);
+}
+
+size_t AbstractRegisterWriteLogger::getCommandsSize() const noexcept
+{
+	return sink_ ? (sink_->size() - base_) : 0;
+}
+
+AbstractRegisterWriteLogger::OptimizationStatistics AbstractRegisterWriteLogger::getOptimizationStatistics() const
+{
+	OptimizationStatistics stats;
+	stats.droppedWrites = droppedWrites_;
+	size_t legacyWaitBytes = legacyWaitBytes_ + (legacyWait_ ? getLegacyWaitSize(legacyWait_) : 0);
+	stats.savedBytes = droppedWrites_ * 3 + legacyWaitBytes - waitBytes_;
+	return stats;
+}
+
+void AbstractRegisterWriteLogger::recordCommand(uint8_t cmd, uint32_t offset, uint8_t value)
+{
+	if (!shouldRecord(offset, value)) return;
+	if (lastWait_) writeWait();
+	put(cmd);
+	put(offset & 0xff);
+	put(value);
+}
+
+void AbstractRegisterWriteLogger::writeWait()
+{
+	if (isOptimized_) {
+		size_t size = getCommandsSize();
+		setWait();
+		waitBytes_ += getCommandsSize() - size;
+	}
+	else {
+		setWait();
+	}
+}
+
+void AbstractRegisterWriteLogger::splitLegacyWait()
+{
+	if (isOptimized_ && legacyWait_) legacyWaitBytes_ += getLegacyWaitSize(legacyWait_);
+	legacyWait_ = 0;
+}
+
+bool AbstractRegisterWriteLogger::shouldRecord(uint32_t offset, uint8_t value)
+{
+	if (!isOptimized_) return true;
+
+	offset &= 0x1ff;
+	const uint32_t reg = offset & 0xff;
+	const bool isFm = reg >= 0x30;	// Both ports
+	if (hasSideEffect(offset)) return true;
+
+	if (isFm && isFnumLatchRegister(reg)) {
+		isFnumLatched_[offset >> 8] = true;
+	}
+	else if (isFm && isFnumRegister(reg) && isFnumLatched_[offset >> 8]) {
+		isFnumLatched_[offset >> 8] = false;	// Apply the latch
+	}
+	else if (isKnown_[offset] && shadow_[offset] == value) {
+		++droppedWrites_;
+		return false;
+	}
+
+	shadow_[offset] = value;
+	isKnown_.set(offset);
+	return true;
+}
+
 //******************************//
-VgmLogger::VgmLogger(int target, uint32_t intrRate)
-	: AbstractRegisterWriteLogger(target), intrRate_(intrRate) {}
+VgmLogger::VgmLogger(int target, uint32_t intrRate, io::ExportSink& sink)
+	: AbstractRegisterWriteLogger(target, &sink), intrRate_(intrRate) {}
 
 void VgmLogger::recordRegisterChange(uint32_t offset, uint8_t value)
 {
-	if (lastWait_) setWait();
+	splitWait();
 
 	const int fm = target_ & io::Export_FmMask;
 	const int ssg = target_ & io::Export_SsgMask;
@@ -113,9 +428,7 @@ void VgmLogger::recordRegisterChange(uint32_t offset, uint8_t value)
 																							   : 0x00;
 
 	if (cmdSsg && offset < 0x10) {
-		buf_.push_back(cmdSsg);
-		buf_.push_back(static_cast<uint8_t>(offset));
-		buf_.push_back(value);
+		recordCommand(cmdSsg, offset, value);
 	}
 	else if (cmdFmPortA && (offset & 0x100) == 0) {
 		bool compatible = true;
@@ -130,9 +443,7 @@ void VgmLogger::recordRegisterChange(uint32_t offset, uint8_t value)
 			compatible = fm == io::Export_YM2608;
 
 		if (compatible) {
-			buf_.push_back(cmdFmPortA);
-			buf_.push_back(offset & 0xff);
-			buf_.push_back(value);
+			recordCommand(cmdFmPortA, offset, value);
 		}
 	}
 	else if (cmdFmPortB && (offset & 0x100) != 0) {
@@ -142,173 +453,75 @@ void VgmLogger::recordRegisterChange(uint32_t offset, uint8_t value)
 			compatible = fm == io::Export_YM2608;
 
 		if (compatible) {
-			buf_.push_back(cmdFmPortB);
-			buf_.push_back(offset & 0xff);
-			buf_.push_back(value);
+			recordCommand(cmdFmPortB, offset, value);
 		}
 	}
 }
 
-void VgmLogger::setDataBlock(std::vector<uint8_t> data)
+void VgmLogger::setDataBlock(const std::vector<uint8_t>& data)
 {
-	buf_.push_back(0x67);
-	buf_.push_back(0x66);
-	buf_.push_back(0x81);
+	put(0x67);
+	put(0x66);
+	put(0x81);
 	size_t blockSize = data.size() + 8;
-	buf_.push_back(blockSize & 0xff);
-	buf_.push_back((blockSize >> 8) & 0xff);
-	buf_.push_back((blockSize >> 16) & 0xff);
-	buf_.push_back(blockSize >> 24);
-	buf_.push_back(data.size() & 0xff);
-	buf_.push_back((data.size() >> 8) & 0xff);
-	buf_.push_back((data.size() >> 16) & 0xff);
-	buf_.push_back(data.size() >> 24);
-	buf_.resize(buf_.size() + 4);	// Start address is 0
-	std::copy(data.begin(), data.end(), std::back_inserter(buf_));
+	put(blockSize & 0xff);
+	put((blockSize >> 8) & 0xff);
+	put((blockSize >> 16) & 0xff);
+	put(blockSize >> 24);
+	put(data.size() & 0xff);
+	put((data.size() >> 8) & 0xff);
+	put((data.size() >> 16) & 0xff);
+	put(data.size() >> 24);
+	sink_->appendZeros(4);	// Start address is 0
+	sink_->append(data.data(), data.size());
 }
 
 void VgmLogger::setWait()
 {
-	while (lastWait_) {
-		uint32_t sub;
-
-		if (intrRate_ == 50) {
-			if (lastWait_ > 65535) {
-				uint32_t tmp = static_cast<uint32_t>(lastWait_ - 65535);
-				if (tmp <= 882) {
-					//65535 - (882 - tmp)
-					sub = 64653 + tmp;
-				}
-				else if (tmp <= 1764) {
-					//65535 - (1764 - tmp)
-					sub = 63771 + tmp;
-				}
-				else if (tmp <= 2646) {
-					//65535 - (2646 - tmp)
-					sub = 62889 + tmp;
-				}
-				else {
-					sub = 65535;
-				}
-				buf_.push_back(0x61);
-				buf_.push_back(sub & 0x00ff);
-				buf_.push_back(static_cast<uint8_t>(sub >> 8));
-			}
-			else {
-				if (lastWait_ <= 16) {
-					buf_.push_back(static_cast<uint8_t>(0x70 | (lastWait_ - 1)));
-				}
-				else if (lastWait_ > 2646) {
-					buf_.push_back(0x61);
-					buf_.push_back(lastWait_ & 0x00ff);
-					buf_.push_back(static_cast<uint8_t>(lastWait_ >> 8));
-				}
-				else if (lastWait_ == 2646) {
-					buf_.push_back(0x63);
-					buf_.push_back(0x63);
-					buf_.push_back(0x63);
-				}
-				else if (1764 <= lastWait_ && lastWait_ <= 1780) {
-					uint32_t tmp = static_cast<uint32_t>(lastWait_ - 1764);
-					buf_.push_back(0x63);
-					buf_.push_back(0x63);
-					if (tmp) buf_.push_back(0x70 | (tmp - 1));
-				}
-				else if (882 <= lastWait_ && lastWait_ <= 898) {
-					uint32_t tmp = static_cast<uint32_t>(lastWait_ - 882);
-					buf_.push_back(0x63);
-					if (tmp) buf_.push_back(0x70 | (tmp - 1));
-				}
-				else {
-					buf_.push_back(0x61);
-					buf_.push_back(lastWait_ & 0x00ff);
-					buf_.push_back(static_cast<uint8_t>(lastWait_ >> 8));
-				}
-				sub = static_cast<uint32_t>(lastWait_);
-			}
+	if (isOptimized_) {
+		// Split too long wait, then choose the shortest combination
+		for (; lastWait_ > MAX_VGM_SHORT_WAIT; lastWait_ -= 0xffff) {
+			put(0x61);
+			put(0xff);
+			put(0xff);
 		}
-		else if (intrRate_ == 60) {
-			if (lastWait_ > 65535) {
-				uint32_t tmp = static_cast<uint32_t>(lastWait_ - 65535);
-				if (tmp <= 735) {
-					//65535 - (735 - tmp)
-					sub = 64800 + tmp;
-				}
-				else if (tmp <= 1470) {
-					//65535 - (1470 - tmp)
-					sub = 64065 + tmp;
-				}
-				else if (tmp <= 2205) {
-					//65535 - (2205 - tmp)
-					sub = 63330 + tmp;
-				}
-				else {
-					sub = 65535;
-				}
-				buf_.push_back(0x61);
-				buf_.push_back(sub & 0x00ff);
-				buf_.push_back(sub >> 8);
-			}
-			else {
-				if (lastWait_ <= 16) {
-					buf_.push_back(static_cast<uint8_t>(0x70 | (lastWait_ - 1)));
-				}
-				else if (lastWait_ > 2205) {
-					buf_.push_back(0x61);
-					buf_.push_back(lastWait_ & 0x00ff);
-					buf_.push_back(static_cast<uint8_t>(lastWait_ >> 8));
-				}
-				else if (lastWait_ == 2205) {
-					buf_.push_back(0x62);
-					buf_.push_back(0x62);
-					buf_.push_back(0x62);
-				}
-				else if (1470 <= lastWait_ && lastWait_ <= 1486) {
-					uint32_t tmp = static_cast<uint32_t>(lastWait_ - 1470);
-					buf_.push_back(0x62);
-					buf_.push_back(0x62);
-					if (tmp) buf_.push_back(0x70 | (tmp - 1));
-				}
-				else if (735 <= lastWait_ && lastWait_ <= 751) {
-					uint32_t tmp = static_cast<uint32_t>(lastWait_ - 735);
-					buf_.push_back(0x62);
-					if (tmp) buf_.push_back(0x70 | (tmp - 1));
-				}
-				else {
-					buf_.push_back(0x61);
-					buf_.push_back(lastWait_ & 0x00ff);
-					buf_.push_back(static_cast<uint8_t>(lastWait_ >> 8));
-				}
-				sub = static_cast<uint32_t>(lastWait_);
-			}
-		}
-		else {
-			if (lastWait_ > 65535) {
-				sub = 65535;
-				buf_.push_back(0x61);
-				buf_.push_back(sub & 0x00ff);
-				buf_.push_back(sub >> 8);
-			}
-			else {
-				buf_.push_back(0x61);
-				buf_.push_back(lastWait_ & 0x00ff);
-				buf_.push_back(static_cast<uint8_t>(lastWait_ >> 8));
-			}
-			sub = static_cast<uint32_t>(lastWait_);
-		}
-
-		lastWait_ -= sub;
+		writeShortestVgmWait(static_cast<uint32_t>(lastWait_), [this](uint8_t v) { put(v); });
 	}
+	else {
+		writeVgmWaitByRate(lastWait_, intrRate_, [this](uint8_t v) { put(v); });
+	}
+	lastWait_ = 0;
+
+	if (!isSetLoop_) loopPoint_ = getCommandsSize();
+}
 
-	if (!isSetLoop_) loopPoint_ = buf_.size();
+size_t VgmLogger::getLegacyWaitSize(uint64_t wait) const
+{
+	size_t size = 0;
+	writeVgmWaitByRate(wait, intrRate_, [&size](uint8_t) { ++size; });
+	return size;
 }
 
 //******************************//
-S98Logger::S98Logger(int target) : AbstractRegisterWriteLogger(target) {}
+RegisterEventLogger::RegisterEventLogger() : AbstractRegisterWriteLogger(0, nullptr) {}
+
+void RegisterEventLogger::recordRegisterChange(uint32_t offset, uint8_t value)
+{
+	lastWait_ = 0;
+	events_.push_back({ getSampleLength(), offset, value, isImmediate_ });
+}
+
+void RegisterEventLogger::setWait()
+{
+	lastWait_ = 0;
+}
+
+//******************************//
+S98Logger::S98Logger(int target, io::ExportSink& sink) : AbstractRegisterWriteLogger(target, &sink) {}
 
 void S98Logger::recordRegisterChange(uint32_t offset, uint8_t value)
 {
-	if (lastWait_) setWait();
+	splitWait();
 
 	const int fm = target_ & io::Export_FmMask;
 	const int ssg = target_ & io::Export_SsgMask;
@@ -324,9 +537,7 @@ void S98Logger::recordRegisterChange(uint32_t offset, uint8_t value)
 			(fm == io::Export_YM2608 || fm == io::Export_YM2612) ? 0x01 : 0xff;
 
 	if (cmdSsg != 0xff && offset < 0x10) {
-		buf_.push_back(cmdSsg);
-		buf_.push_back(offset);
-		buf_.push_back(value);
+		recordCommand(cmdSsg, offset, value);
 	}
 	else if (cmdFmPortA != 0xff && (offset & 0x100) == 0) {
 		bool compatible = true;
@@ -341,9 +552,7 @@ void S98Logger::recordRegisterChange(uint32_t offset, uint8_t value)
 			compatible = fm == io::Export_YM2608;
 
 		if (compatible) {
-			buf_.push_back(cmdFmPortA);
-			buf_.push_back(offset & 0xff);
-			buf_.push_back(value);
+			recordCommand(cmdFmPortA, offset, value);
 		}
 	}
 	else if (cmdFmPortB != 0xff && (offset & 0x100) != 0) {
@@ -353,9 +562,7 @@ void S98Logger::recordRegisterChange(uint32_t offset, uint8_t value)
 			compatible = fm == io::Export_YM2608;
 
 		if (compatible) {
-			buf_.push_back(cmdFmPortB);
-			buf_.push_back(offset & 0xff);
-			buf_.push_back(value);
+			recordCommand(cmdFmPortB, offset, value);
 		}
 	}
 }
@@ -363,19 +570,24 @@ void S98Logger::recordRegisterChange(uint32_t offset, uint8_t value)
 void S98Logger::setWait()
 {
 	if (lastWait_ == 1) {
-		buf_.push_back(0xff);
+		put(0xff);
 	}
 	else {
-		buf_.push_back(0xfe);
+		put(0xfe);
 		lastWait_ -= 2;
 		do {
 			uint8_t b = lastWait_ & 0x7f;
 			lastWait_ >>= 7;
 			if (lastWait_ > 0) b |= 0x80;
-			buf_.push_back(b);
+			put(b);
 		} while (lastWait_ > 0);
 	}
-	if (!isSetLoop_) loopPoint_ = buf_.size();
+	if (!isSetLoop_) loopPoint_ = getCommandsSize();
 	lastWait_ = 0;
 }
+
+size_t S98Logger::getLegacyWaitSize(uint64_t wait) const
+{
+	return getS98WaitSize(wait);
+}
 }
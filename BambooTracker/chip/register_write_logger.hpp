@@ -28,56 +28,136 @@
 #include <cstdint>
 #include <cstddef>
 #include <vector>
+#include <array>
+#include <bitset>
+
+namespace io
+{
+class ExportSink;
+}
 
 namespace chip
 {
+/**
+ * @brief Streams register changes as commands into a sink.
+ *
+ * Commands are appended after the data which the sink already has,
+ * and offsets such as the loop point are relative to the first command.
+ */
 class AbstractRegisterWriteLogger
 {
 public:
-	explicit AbstractRegisterWriteLogger(int target);
+	AbstractRegisterWriteLogger(int target, io::ExportSink* sink);
 	virtual ~AbstractRegisterWriteLogger() = default;
 	virtual void recordRegisterChange(uint32_t offset, uint8_t value) = 0;
+	/// Set whether the chip writes following changes immediately or with waits.
+	void setImmediateWriteMode(bool enabled) noexcept { isImmediate_ = enabled; }
 	void elapse(size_t count) noexcept;
 	bool empty() const noexcept;
-	void clear() noexcept;
-	std::vector<uint8_t> getData();
+	/// Write the elapsed samples as wait commands.
+	void flushWait();
+	/**
+	 * @brief Mark a boundary of waits such as a tick.
+	 *        The elapsed samples are written here without optimization,
+	 *        and merged until the next command with it.
+	 */
+	void splitWait();
 	size_t getSampleLength() const noexcept;
 	size_t setLoopPoint();
 	size_t forceMoveLoopPoint() noexcept;
 
+	struct OptimizationStatistics
+	{
+		size_t droppedWrites = 0;
+		size_t savedBytes = 0;	// Dropped writes and shorter waits
+	};
+
+	/**
+	 * @brief Drop writes which do not change a register and encode waits in the fewest bytes.
+	 * @note Writes with side effects (key-on, SSG envelope shape, ADPCM control and data, etc.)
+	 *       are always kept. Registers are treated as unknown again at the loop point.
+	 */
+	void setOptimizationEnabled(bool enabled) noexcept { isOptimized_ = enabled; }
+	bool isOptimizationEnabled() const noexcept { return isOptimized_; }
+	OptimizationStatistics getOptimizationStatistics() const;
+
 protected:
 	int target_;
-	std::vector<uint8_t> buf_;
+	io::ExportSink* sink_;
+	const size_t base_;
 	uint64_t lastWait_;
 	bool isSetLoop_;
 	uint32_t loopPoint_;
+	bool isImmediate_;
+	bool isOptimized_;
 
 	virtual void setWait() = 0;
+	/// Size of the wait commands which setWait writes without optimization.
+	virtual size_t getLegacyWaitSize(uint64_t wait) const = 0;
+	void put(uint8_t v);
+	size_t getCommandsSize() const noexcept;
+	/// Write a 3-byte register write command unless it is redundant.
+	void recordCommand(uint8_t cmd, uint32_t offset, uint8_t value);
 
 private:
 	uint64_t totalSampCnt_;
+	size_t droppedWrites_;
+	uint64_t legacyWait_;
+	size_t legacyWaitBytes_, waitBytes_;
+	std::array<uint8_t, 0x200> shadow_;
+	std::bitset<0x200> isKnown_;
+	bool isFnumLatched_[2];
+
+	void writeWait();
+	void splitLegacyWait();
+	bool shouldRecord(uint32_t offset, uint8_t value);
 };
 
 class VgmLogger final : public AbstractRegisterWriteLogger
 {
 public:
-	VgmLogger(int target, uint32_t intrRate);
+	VgmLogger(int target, uint32_t intrRate, io::ExportSink& sink);
 	void recordRegisterChange(uint32_t offset, uint8_t value) override;
-	void setDataBlock(std::vector<uint8_t> data);
+	void setDataBlock(const std::vector<uint8_t>& data);
 
 private:
 	uint32_t intrRate_;
 
 	void setWait() override;
+	size_t getLegacyWaitSize(uint64_t wait) const override;
+};
+
+/// Keeps register writes with their sample positions to replay them into other chips.
+class RegisterEventLogger final : public AbstractRegisterWriteLogger
+{
+public:
+	struct Event
+	{
+		size_t sample;
+		uint32_t offset;
+		uint8_t value;
+		bool isImmediate;
+	};
+
+	RegisterEventLogger();
+	void recordRegisterChange(uint32_t offset, uint8_t value) override;
+	const std::vector<Event>& getEvents() const noexcept { return events_; }
+
+private:
+	std::vector<Event> events_;
+
+	void setWait() override;
+	size_t getLegacyWaitSize(uint64_t) const override { return 0; }
 };
 
 class S98Logger final : public AbstractRegisterWriteLogger
 {
 public:
-	explicit S98Logger(int target);
+	S98Logger(int target, io::ExportSink& sink);
 	void recordRegisterChange(uint32_t offset, uint8_t value) override;
 
 private:
 	void setWait() override;
+	size_t getLegacyWaitSize(uint64_t wait) const override;
 };
 }
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+
+namespace chip
+{
+/**
+ * @brief Lock-free single-producer single-consumer queue of register writes.
+ *
+ * Only one thread may push and only one thread may pop at a time.
+ * The buffer has a fixed capacity and never allocates after construction.
+ */
+class RegisterWriteRing
+{
+public:
+	struct Entry
+	{
+		uint64_t position;	// Output sample position where the write should land
+		uint32_t offset;	// DRAM address if block is not nullptr
+		uint8_t value;
+		bool isImmediate;	// Written without waiting for the position and the bus
+		const uint8_t* block;	// DRAM data written at once instead of a register
+		size_t blockSize;
+	};
+
+	/// @param capacity The number of entries. It must be a power of 2.
+	explicit RegisterWriteRing(size_t capacity)
+		: buf_(std::make_unique<Entry[]>(capacity)), mask_(capacity - 1), head_(0), tail_(0) {}
+
+	/// [Return] false if the ring is full
+	bool push(const Entry& entry) noexcept
+	{
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) > mask_) return false;
+		buf_[tail & mask_] = entry;
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// [Return] nullptr if the ring is empty
+	const Entry* front() const noexcept
+	{
+		size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire)) return nullptr;
+		return &buf_[head & mask_];
+	}
+
+	void pop() noexcept
+	{
+		head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/// Index given to the entry pushed next. It must be called by the producer.
+	size_t getPushIndex() const noexcept { return tail_.load(std::memory_order_relaxed); }
+	/// [Return] true if the entry pushed at the index has been popped or cleared
+	bool hasPopped(size_t index) const noexcept { return head_.load(std::memory_order_acquire) > index; }
+
+	/// Discard all entries. It must be called by the consumer.
+	void clear() noexcept
+	{
+		head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	std::unique_ptr<Entry[]> buf_;
+	const size_t mask_;
+	// Keep the indices of the producer and the consumer on separate cache lines
+	alignas(64) std::atomic_size_t head_;
+	alignas(64) std::atomic_size_t tail_;
+};
+}
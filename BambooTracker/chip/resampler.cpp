@@ -28,9 +28,15 @@
 #include <iterator>
 #include "./blip_buf/blip_buf.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BT_SINC_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace chip
 {
 AbstractResampler::AbstractResampler()
+	: nChannels_(2)
 {
 	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
 		destBuf_[pan] = new sample[CHIP_SMPL_BUF_SIZE_]();
@@ -63,7 +69,7 @@ sample** LinearResampler::interpolate(sample** src, size_t nSamples, size_t)
 	if (srcRate_ == destRate_) return src;
 
 	// Linear interplation
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
+	for (int pan = STEREO_LEFT; pan < nChannels_; ++pan) {
 		for (size_t n = 0; n < nSamples; ++n) {
 			float curnf = n * rateRatio_;
 			int curni = static_cast<int>(curnf);
@@ -103,8 +109,8 @@ void BlipResampler::init(int srcRate, int destRate, size_t maxDuration)
 
 	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
 		auto& ch = ch_[pan];
-		blip_clear(ch.blipBuf_);
 		blip_set_rates(ch.blipBuf_, srcRate, destRate);
+		blip_clear(ch.blipBuf_);	// Its offset depends on the rates
 		ch.prevSample_ = 0;
 	}
 }
@@ -134,7 +140,7 @@ sample** BlipResampler::interpolate(sample** src, size_t nSamples, size_t intrSi
 	if (srcRate_ == destRate_) return src;
 
 	short tmpBuf[CHIP_SMPL_BUF_SIZE_];
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
+	for (int pan = STEREO_LEFT; pan < nChannels_; ++pan) {
 		auto& ch = ch_[pan];
 		if (ch.blipBuf_ == nullptr) continue;
 
@@ -152,4 +158,183 @@ sample** BlipResampler::interpolate(sample** src, size_t nSamples, size_t intrSi
 
 	return destBuf_;
 }
+
+/****************************************/
+namespace
+{
+constexpr double PI = 3.14159265358979323846;
+
+struct SincPreset
+{
+	int zeroCrossings;	// On each side, in destination samples
+	double beta;		// Kaiser window
+	double rolloff;		// Cutoff relative to the Nyquist frequency
+	uint32_t nPhases;
+	bool interpolatesPhase;
+};
+
+const SincPreset SINC_PRESETS[] = {
+	{ 8, 6.0, 0.90, 256, false },	// Fast
+	{ 16, 8.0, 0.93, 64, true },	// Medium
+	{ 32, 10.0, 0.95, 128, true }	// Best
+};
+
+// Zeroth order modified Bessel function of the first kind
+double besselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		double t = x / (2.0 * k);
+		term *= t * t;
+		sum += term;
+		if (term < sum * 1e-12) break;
+	}
+	return sum;
+}
+
+// Number of taps must be multiple of 4
+float dot(const float* a, const float* b, size_t n)
+{
+#ifdef BT_SINC_SSE2
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	if (i < n) acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+	acc0 = _mm_add_ps(acc0, acc1);
+	acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+	acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+	return _mm_cvtss_f32(acc0);
+#else
+	float acc[4] = { 0.f, 0.f, 0.f, 0.f };
+	for (size_t i = 0; i < n; i += 4) {
+		for (int j = 0; j < 4; ++j) acc[j] += a[i + j] * b[i + j];
+	}
+	return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+}
+
+inline sample roundToSample(float value)
+{
+	return static_cast<sample>(value < 0.f ? value - 0.5f : value + 0.5f);
+}
+}
+
+SincResampler::SincResampler(Quality quality)
+	: quality_(quality),
+	  nTaps_(0),
+	  nPhases_(1),
+	  interpolatesPhase_(false),
+	  pos_(0),
+	  step_(0),
+	  historySize_(0)
+{
+}
+
+void SincResampler::init(int srcRate, int destRate, size_t maxDuration)
+{
+	AbstractResampler::init(srcRate, destRate, maxDuration);
+
+	const SincPreset& preset = SINC_PRESETS[static_cast<int>(quality_)];
+	const double ratio = std::max(1.0, static_cast<double>(srcRate) / destRate);
+	nTaps_ = static_cast<size_t>(std::ceil(2 * preset.zeroCrossings * ratio / 4)) * 4;
+	nPhases_ = preset.nPhases;
+	interpolatesPhase_ = preset.interpolatesPhase;
+
+	// Cutoff in cycles per source sample
+	const double fc = 0.5 * preset.rolloff / ratio;
+	const double halfWidth = nTaps_ / 2.0;
+	const double i0Beta = besselI0(preset.beta);
+	coefs_.assign((nPhases_ + 1) * nTaps_, 0.f);
+	std::vector<double> tmp(nTaps_);
+	for (uint32_t p = 0; p <= nPhases_; ++p) {
+		float* row = &coefs_[p * nTaps_];
+		double sum = 0;
+		for (size_t i = 0; i < nTaps_; ++i) {
+			double x = i - (halfWidth - 1) - static_cast<double>(p) / nPhases_;
+			double w = x / halfWidth;
+			double window = (std::abs(w) < 1.0) ? besselI0(preset.beta * std::sqrt(1.0 - w * w)) / i0Beta : 0.0;
+			double arg = PI * 2.0 * fc * x;
+			double sinc = (x == 0.0) ? 1.0 : std::sin(arg) / arg;
+			tmp[i] = sinc * window;
+			sum += tmp[i];
+		}
+		// Normalize DC gain of each phase
+		for (size_t i = 0; i < nTaps_; ++i) row[i] = static_cast<float>(tmp[i] / sum);
+	}
+
+	step_ = (static_cast<uint64_t>(srcRate) << 32) / static_cast<uint64_t>(destRate);
+	for (auto& history : history_) history.assign(nTaps_ + CHIP_SMPL_BUF_SIZE_, 0.f);
+	reset();
+}
+
+void SincResampler::reset()
+{
+	pos_ = 0;
+	// Start with silence in the left half of the filter
+	historySize_ = nTaps_ ? nTaps_ / 2 - 1 : 0;
+	for (auto& history : history_) std::fill(history.begin(), history.end(), 0.f);
+}
+
+size_t SincResampler::calculateInternalSampleSize(size_t nSamples, bool& ok)
+{
+	ok = true;
+	if (srcRate_ == destRate_) return nSamples;
+	if (!nSamples) return 0;
+
+	size_t last = static_cast<size_t>((pos_ + step_ * (nSamples - 1)) >> 32);
+	size_t required = last + nTaps_;
+	return (required > historySize_) ? required - historySize_ : 0;
+}
+
+sample** SincResampler::interpolate(sample** src, size_t nSamples, size_t intrSize)
+{
+	if (srcRate_ == destRate_) return src;
+
+	intrSize = std::min(intrSize, history_[0].size() - historySize_);
+	const size_t newSize = historySize_ + intrSize;
+	uint64_t pos = pos_;
+
+	for (int pan = STEREO_LEFT; pan < nChannels_; ++pan) {
+		float* history = history_[pan].data();
+		std::transform(src[pan], src[pan] + intrSize, history + historySize_,
+					   [](sample s) { return static_cast<float>(s); });
+
+		pos = pos_;
+		sample* dest = destBuf_[pan];
+		sample prev = 0;
+		for (size_t n = 0; n < nSamples; ++n, pos += step_) {
+			size_t index = static_cast<size_t>(pos >> 32);
+			if (index + nTaps_ > newSize) {
+				// Not enough samples were generated
+				std::fill(dest + n, dest + nSamples, prev);
+				break;
+			}
+			const float* in = history + index;
+			uint64_t phase = (pos & 0xffffffffu) * nPhases_;
+			const float* row = &coefs_[(phase >> 32) * nTaps_];
+			float out = dot(in, row, nTaps_);
+			if (interpolatesPhase_) {
+				float sub = static_cast<float>(phase & 0xffffffffu) * (1.f / 4294967296.f);
+				out += (dot(in, row + nTaps_, nTaps_) - out) * sub;
+			}
+			dest[n] = prev = roundToSample(out);
+		}
+	}
+
+	pos = pos_ + step_ * nSamples;
+	size_t consumed = std::min(static_cast<size_t>(pos >> 32), newSize);
+	for (int pan = STEREO_LEFT; pan < nChannels_; ++pan) {
+		float* history = history_[pan].data();
+		std::copy(history + consumed, history + newSize, history);
+	}
+	pos_ = pos - (static_cast<uint64_t>(consumed) << 32);
+	historySize_ = newSize - consumed;
+
+	return destBuf_;
+}
 }
@@ -28,6 +28,8 @@
 #include "chip_defs.h"
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 struct blip_t;
 
@@ -38,6 +40,9 @@ enum class ResamplerType : int
 	Linear = 0,
 	BlipBuf,
 	FastBlipBuf,
+	SincFast,
+	SincMedium,
+	SincBest,
 };
 
 class AbstractResampler
@@ -54,6 +59,14 @@ public:
 	}
 
 	virtual void setMaxDuration(size_t maxDuration) noexcept;
+
+	/**
+	 * @brief Set the number of channels to resample.
+	 * @param nChannels 1 resamples only the left channel, 2 resamples both.
+	 */
+	void setChannelCount(int nChannels) noexcept { nChannels_ = nChannels; }
+	int getChannelCount() const noexcept { return nChannels_; }
+
 	virtual sample** interpolate(sample** src, size_t nSamples, size_t intrSize) = 0;
 
 	/**
@@ -71,6 +84,7 @@ public:
 protected:
 	int srcRate_, destRate_;
 	size_t maxDuration_;
+	int nChannels_;
 	float rateRatio_;
 	sample* destBuf_[2];
 
@@ -111,4 +125,44 @@ private:
 
 	void (*addDelta)(blip_t*, unsigned int, int);
 };
+
+/**
+ * @brief Polyphase FIR resampler using a Kaiser-windowed sinc.
+ * @note The filter is widened by the decimation ratio, so that its transition band
+ *       stays at the destination Nyquist frequency even for SSG (clock / 32).
+ */
+class SincResampler final : public AbstractResampler
+{
+public:
+	enum class Quality : int
+	{
+		Fast,	// Short filter, nearest phase
+		Medium,	// Interpolated phases
+		Best	// Long filter, interpolated phases
+	};
+
+	explicit SincResampler(Quality quality);
+	void init(int srcRate, int destRate, size_t maxDuration) override;
+	void reset() override;
+
+	void setDestributionRate(int destRate) override
+	{
+		init(srcRate_, destRate, maxDuration_);
+	}
+
+	size_t calculateInternalSampleSize(size_t nSamples, bool& ok) override;
+	sample** interpolate(sample** src, size_t nSamples, size_t intrSize) override;
+
+private:
+	const Quality quality_;
+	size_t nTaps_;
+	uint32_t nPhases_;
+	bool interpolatesPhase_;
+	std::vector<float> coefs_;	// (nPhases_ + 1) rows of nTaps_ coefficients
+
+	// Position of the first tap in history_, 32.32 fixed point in source samples
+	uint64_t pos_, step_;
+	std::vector<float> history_[2];
+	size_t historySize_;
+};
 }
@@ -24,6 +24,7 @@
  */
 
 #include "ymfm_2608.hpp"
+#include <algorithm>
 
 extern const unsigned char YM2608_ADPCM_ROM[0x2000];
 
@@ -50,7 +51,15 @@ void Ymfm2608::YmfmInterface::ymfm_external_write(ymfm::access_class type, uint3
 	}
 }
 
+void Ymfm2608::YmfmInterface::writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size)
+{
+	if (address >= dram_.size()) return;
+	std::copy_n(data, std::min<size_t>(size, dram_.size() - address), dram_.begin() + address);
+}
+
 //**************************************************
+Ymfm2608::Ymfm2608(ymfm::opn_fidelity fidelity) : fidelity_(fidelity) {}
+
 Ymfm2608::~Ymfm2608()
 {
 	stopDevice();
@@ -61,15 +70,33 @@ int Ymfm2608::startDevice(int clock, int& rateSsg, uint32_t dramSize)
 	ymfmIntf_ = std::make_unique<YmfmInterface>(dramSize);
 	ymfm_ = std::make_unique<ymfm::ym2608>(*ymfmIntf_);
 	// Prescale = 6
-	// Set FM output rate
-	ymfm_->set_fidelity(ymfm::opn_fidelity::OPN_FIDELITY_MIN);
-	rateSsg = clock / 32;
+	// FM output rate is fixed, and fidelity selects SSG output rate
+	clock_ = clock;
+	ymfm_->set_fidelity(fidelity_);
+	rateSsg = getSsgRate();
 
 	ymfm_->reset();
 
 	return clock / 144;	// FM synthesis rate is clock / 2 / 72
 }
 
+int Ymfm2608::getSsgRate() const
+{
+	switch (fidelity_) {
+	default:
+	case ymfm::OPN_FIDELITY_MAX:	return clock_ / 32;
+	case ymfm::OPN_FIDELITY_MED:	return clock_ / 96;
+	case ymfm::OPN_FIDELITY_MIN:	return clock_ / 144;
+	}
+}
+
+int Ymfm2608::setFidelity(ymfm::opn_fidelity fidelity)
+{
+	fidelity_ = fidelity;
+	ymfm_->set_fidelity(fidelity_);
+	return getSsgRate();
+}
+
 void Ymfm2608::stopDevice()
 {
 	ymfm_.reset();
@@ -82,6 +109,7 @@ void Ymfm2608::resetDevice()
 
 void Ymfm2608::writeAddressToPortA(uint8_t address)
 {
+	addressA_ = address;
 	ymfm_->write_address(address);
 }
 
@@ -92,6 +120,7 @@ void Ymfm2608::writeAddressToPortB(uint8_t address)
 
 void Ymfm2608::writeDataToPortA(uint8_t data)
 {
+	if (isSsgSeparated_ && addressA_ < 0x10) return;
 	ymfm_->write_data(data);
 }
 
@@ -105,6 +134,21 @@ uint8_t Ymfm2608::readData()
 	return ymfm_->read_data();
 }
 
+void Ymfm2608::writeSsgRegister(uint8_t address, uint8_t data)
+{
+	ymfm_->write_ssg(address, data);
+}
+
+void Ymfm2608::setSsgSeparated(bool separated)
+{
+	isSsgSeparated_ = separated;
+}
+
+void Ymfm2608::writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size)
+{
+	ymfmIntf_->writeDRAMBlock(address, data, size);
+}
+
 void Ymfm2608::updateStream(sample** outputs, int nSamples)
 {
 	sample* bufl = outputs[STEREO_LEFT];
@@ -119,18 +163,13 @@ void Ymfm2608::updateStream(sample** outputs, int nSamples)
 	}
 }
 
-void Ymfm2608::updateSsgStream(sample** outputs, int nSamples)
+void Ymfm2608::updateSsgStream(sample* output, int nSamples)
 {
-	sample* bufl = outputs[STEREO_LEFT];
-	sample* bufr = outputs[STEREO_RIGHT];
-
 	ymfm::ym2608::output_data data;
 	for (int i = 0; i < nSamples; ++i) {
 		ymfm_->generate_ssg(&data);
 		// Modify volume
-		int32_t s = data.data[2] * 3 / 4;
-		*bufl++ = s;
-		*bufr++ = s;
+		*output++ = data.data[2] * 3 / 4;
 	}
 }
 }
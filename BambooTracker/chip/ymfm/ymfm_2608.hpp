@@ -36,6 +36,11 @@ namespace chip
 class Ymfm2608 final : public Ym2608Interface
 {
 public:
+	/**
+	 * @param fidelity Rate of SSG output.
+	 *        Maximum is clock / 32, medium is clock / 96 and minimum is clock / 144.
+	 */
+	explicit Ymfm2608(ymfm::opn_fidelity fidelity = ymfm::OPN_FIDELITY_MAX);
 	~Ymfm2608() override;
 	int startDevice(int clock, int& rateSsg, uint32_t dramSize) override;
 	void stopDevice() override;
@@ -45,8 +50,17 @@ public:
 	void writeDataToPortA(uint8_t data) override;
 	void writeDataToPortB(uint8_t data) override;
 	uint8_t readData() override;
+	void writeSsgRegister(uint8_t address, uint8_t data) override;
+	void setSsgSeparated(bool separated) override;
+	void writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size) override;
 	void updateStream(sample** outputs, int nSamples) override;
-	void updateSsgStream(sample** outputs, int nSamples) override;
+	void updateSsgStream(sample* output, int nSamples) override;
+
+	/**
+	 * @brief Change the fidelity while the device is running.
+	 * @return New rate of SSG output.
+	 */
+	int setFidelity(ymfm::opn_fidelity fidelity);
 
 private:
 	class YmfmInterface final : public ymfm::ymfm_interface
@@ -55,12 +69,19 @@ private:
 		YmfmInterface(uint32_t dramSize);
 		uint8_t ymfm_external_read(ymfm::access_class type, uint32_t address) override;
 		void ymfm_external_write(ymfm::access_class type, uint32_t address, uint8_t data) override;
+		void writeDRAMBlock(uint32_t address, const uint8_t* data, size_t size);
 
 	private:
 		std::vector<uint8_t> dram_;
 	};
 
+	ymfm::opn_fidelity fidelity_;
+	int clock_ = 0;
 	std::unique_ptr<ymfm::ym2608> ymfm_;
 	std::unique_ptr<YmfmInterface> ymfmIntf_;
+	uint8_t addressA_ = 0;
+	bool isSsgSeparated_ = false;
+
+	int getSsgRate() const;
 };
 }
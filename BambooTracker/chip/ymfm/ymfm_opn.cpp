@@ -1352,16 +1352,14 @@ void ym2608::generate_fm_adpcm(output_data *output, uint32_t numsamples)
 //-------------------------------------------------
 //  generate_ssg - generate one sample of sound
 //  for SSG
-//  This only work correctly when prescale is set to 6,
-//  and output is not resampled.
+//  This only work correctly when prescale is set to 6.
 //-------------------------------------------------
 
 
 /* [BambooTracker]
- * We use only prescale = 6 and do not resample SSG */
+ * We use only prescale = 6 and resample SSG to the rate selected by fidelity */
 void ym2608::generate_ssg(output_data *output, uint32_t numsamples)
 {
-	// TODO: resample the SSG as configured
 	m_ssg_resampler.resample(output, numsamples);
 }
 
@@ -1385,16 +1383,16 @@ void ym2608::update_prescale(uint8_t prescale)
 
 	// compute the number of FM samples per output sample, and select the
 	// resampler function
+	/* [BambooTracker]
+	 * We use only prescale = 6 and match output rate to FM synthesis rate.
+	 * Fidelity selects SSG output rate, which is resampled separately:
+	 *   maximum: clock/32 (1:1), medium: clock/96 (1:3), minimum: clock/144 (2:9) */
 	if (m_fidelity == OPN_FIDELITY_MIN)
 	{
 		switch (prescale)
 		{
 			default:
-			/* [BambooTracker]
-			 * We use only prescale = 6, match output rate to FM synthesis rate
-			 * and do not resample SSG */
-			// Skip to apply resampler to output separately
-			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(1, 1);	break;
+			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(2, 9);	break;
 			// case 6:	m_fm_samples_per_output = 3;	m_ssg_resampler.configure(2, 3);	break;
 			case 3: m_fm_samples_per_output = 0;	m_ssg_resampler.configure(1, 3);	break;
 			case 2: m_fm_samples_per_output = 1;	m_ssg_resampler.configure(1, 6);	break;
@@ -1405,7 +1403,8 @@ void ym2608::update_prescale(uint8_t prescale)
 		switch (prescale)
 		{
 			default:
-			case 6:	m_fm_samples_per_output = 6;	m_ssg_resampler.configure(4, 3);	break;
+			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(1, 3);	break;
+			// case 6:	m_fm_samples_per_output = 6;	m_ssg_resampler.configure(4, 3);	break;
 			case 3: m_fm_samples_per_output = 3;	m_ssg_resampler.configure(2, 3);	break;
 			case 2: m_fm_samples_per_output = 2;	m_ssg_resampler.configure(1, 3);	break;
 		}
@@ -1415,7 +1414,8 @@ void ym2608::update_prescale(uint8_t prescale)
 		switch (prescale)
 		{
 			default:
-			case 6:	m_fm_samples_per_output = 18;	m_ssg_resampler.configure(4, 1);	break;
+			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(1, 1);	break;
+			// case 6:	m_fm_samples_per_output = 18;	m_ssg_resampler.configure(4, 1);	break;
 			case 3: m_fm_samples_per_output = 9;	m_ssg_resampler.configure(2, 1);	break;
 			case 2: m_fm_samples_per_output = 6;	m_ssg_resampler.configure(1, 1);	break;
 		}
@@ -542,6 +542,8 @@ public:
 	void write_address_hi(uint8_t data);
 	void write_data_hi(uint8_t data);
 	void write(uint32_t offset, uint8_t data);
+	/* [BambooTracker] Write SSG directly without changing the address register */
+	void write_ssg(uint8_t address, uint8_t data) { m_ssg.write(address & 0x0f, data); }
 
 	// generate one sample of sound
 	/* [BambooTracker] Separate sample generate with FM and SSG */
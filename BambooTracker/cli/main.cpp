@@ -0,0 +1,447 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Headless renderer which exports a module to WAV, VGM or S98 without the GUI.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bamboo_tracker.hpp"
+#include "batch_exporter.hpp"
+#include "configuration.hpp"
+#include "chip/opna.hpp"
+#include "io/binary_container.hpp"
+#include "io/wav_container.hpp"
+#include "io/export_io.hpp"
+#include "io/export_sink.hpp"
+
+namespace
+{
+enum class OutputFormat
+{
+	Unknown, Wav, Vgm, S98
+};
+
+struct Options
+{
+	std::string inputPath, outputPath;
+	OutputFormat format = OutputFormat::Unknown;
+	int song = 0;	// -1 means all songs
+	int loopCount = 1;
+	uint32_t rate = 44100;
+	int emulator = static_cast<int>(chip::OpnaEmulator::Nuked);
+	int fidelity = static_cast<int>(chip::YmfmFidelity::Maximum);
+	int target = io::Export_YM2608;
+	int resolution = 1000;
+	int jobs = 0;
+	bool stems = false;
+	bool printLength = false;
+};
+
+void printUsage(const char* name)
+{
+	std::fprintf(stderr,
+				 "Usage: %s [options] <module> <output>\n"
+				 "       %s --length [options] <module>\n"
+				 "Options:\n"
+				 "  -f, --format <wav|vgm|s98>          Output format (default: output file extension)\n"
+				 "  -s, --song <number|all>             Song number, or all songs rendered in parallel\n"
+				 "                                      to <output name>_<number>.<ext> (default: 0)\n"
+				 "  -l, --loop <count>                  Loop count for WAV and length, 1 or more (default: 1)\n"
+				 "  -r, --rate <Hz>                     Sample rate for WAV (default: 44100)\n"
+				 "  -e, --emulator <mame|nuked|ymfm>    Emulator core (default: nuked)\n"
+				 "      --fidelity <max|med|min>        SSG fidelity of ymfm (default: max)\n"
+				 "  -t, --target <ym2608|ym2612|ym2203|ym2610b>\n"
+				 "                                      Chip of VGM or S98 (default: ym2608)\n"
+				 "      --resolution <ticks>            S98 timer resolution (default: 1000)\n"
+				 "  -j, --jobs <count>                  Number of parallel jobs (default: CPU threads)\n"
+				 "      --stems                         Render each track of WAV to <output name>_<track>.wav\n"
+				 "      --length                        Print song length and order timestamps without rendering\n"
+				 "  -h, --help                          Show this help\n",
+				 name, name);
+}
+
+OutputFormat parseFormat(std::string str)
+{
+	for (auto& c : str) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	if (str == "wav") return OutputFormat::Wav;
+	if (str == "vgm") return OutputFormat::Vgm;
+	if (str == "s98") return OutputFormat::S98;
+	return OutputFormat::Unknown;
+}
+
+bool parseInt(const std::string& str, int& value)
+{
+	char* end;
+	long v = std::strtol(str.c_str(), &end, 10);
+	if (str.empty() || *end != '\0' || v < 0) return false;
+	value = static_cast<int>(v);
+	return true;
+}
+
+/// [Return] true if options are valid
+bool parseOptions(int argc, char* argv[], Options& opts)
+{
+	std::vector<std::string> positionals;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg.empty() || arg.front() != '-' || arg == "-") {
+			positionals.push_back(arg);
+			continue;
+		}
+		if (arg == "-h" || arg == "--help") return false;
+		if (arg == "--stems") {
+			opts.stems = true;
+			continue;
+		}
+		if (arg == "--length") {
+			opts.printLength = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			std::fprintf(stderr, "Missing value of %s\n", arg.c_str());
+			return false;
+		}
+
+		std::string value = argv[++i];
+		int n;
+		if (arg == "-f" || arg == "--format") {
+			if ((opts.format = parseFormat(value)) == OutputFormat::Unknown) {
+				std::fprintf(stderr, "Unknown format: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else if (arg == "-s" || arg == "--song") {
+			if (value == "all") opts.song = -1;
+			else if (!parseInt(value, opts.song)) {
+				std::fprintf(stderr, "Invalid song number: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else if (arg == "-l" || arg == "--loop") {
+			if (!parseInt(value, opts.loopCount) || opts.loopCount == 0) {
+				std::fprintf(stderr, "Invalid loop count: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else if (arg == "-r" || arg == "--rate") {
+			if (!parseInt(value, n) || n == 0) {
+				std::fprintf(stderr, "Invalid sample rate: %s\n", value.c_str());
+				return false;
+			}
+			opts.rate = static_cast<uint32_t>(n);
+		}
+		else if (arg == "-e" || arg == "--emulator") {
+			if (value == "mame") opts.emulator = static_cast<int>(chip::OpnaEmulator::Mame);
+			else if (value == "nuked") opts.emulator = static_cast<int>(chip::OpnaEmulator::Nuked);
+			else if (value == "ymfm") opts.emulator = static_cast<int>(chip::OpnaEmulator::Ymfm);
+			else {
+				std::fprintf(stderr, "Unknown emulator: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else if (arg == "--fidelity") {
+			if (value == "max") opts.fidelity = static_cast<int>(chip::YmfmFidelity::Maximum);
+			else if (value == "med") opts.fidelity = static_cast<int>(chip::YmfmFidelity::Medium);
+			else if (value == "min") opts.fidelity = static_cast<int>(chip::YmfmFidelity::Minimum);
+			else {
+				std::fprintf(stderr, "Unknown fidelity: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else if (arg == "-t" || arg == "--target") {
+			if (value == "ym2608") opts.target = io::Export_YM2608;
+			else if (value == "ym2612") opts.target = io::Export_YM2612;
+			else if (value == "ym2203") opts.target = io::Export_YM2203;
+			else if (value == "ym2610b") opts.target = io::Export_YM2610B;
+			else {
+				std::fprintf(stderr, "Unknown target: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else if (arg == "--resolution") {
+			if (!parseInt(value, opts.resolution) || opts.resolution == 0) {
+				std::fprintf(stderr, "Invalid resolution: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else if (arg == "-j" || arg == "--jobs") {
+			if (!parseInt(value, opts.jobs)) {
+				std::fprintf(stderr, "Invalid job count: %s\n", value.c_str());
+				return false;
+			}
+		}
+		else {
+			std::fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+			return false;
+		}
+	}
+
+	if (opts.printLength) {
+		if (positionals.size() != 1) return false;
+		opts.inputPath = positionals[0];
+		return true;
+	}
+
+	if (positionals.size() != 2) return false;
+	opts.inputPath = positionals[0];
+	opts.outputPath = positionals[1];
+
+	if (opts.format == OutputFormat::Unknown) {
+		size_t dot = opts.outputPath.find_last_of('.');
+		if (dot != std::string::npos) opts.format = parseFormat(opts.outputPath.substr(dot + 1));
+		if (opts.format == OutputFormat::Unknown) {
+			std::fprintf(stderr, "Cannot determine the output format of %s\n", opts.outputPath.c_str());
+			return false;
+		}
+	}
+	if (opts.stems && opts.format != OutputFormat::Wav) {
+		std::fprintf(stderr, "Stems can be rendered only to WAV\n");
+		return false;
+	}
+
+	return true;
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& buf)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs) return false;
+	buf.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+	return !ifs.bad();
+}
+
+std::string addOutputPathSuffix(const std::string& path, const std::string& suffix)
+{
+	size_t dot = path.find_last_of('.');
+	size_t sep = path.find_last_of("/\\");
+	if (dot == std::string::npos || (sep != std::string::npos && dot < sep)) return path + "_" + suffix;
+	return path.substr(0, dot) + "_" + suffix + path.substr(dot);
+}
+
+std::string makeSongOutputPath(const std::string& path, int song)
+{
+	char num[16];
+	std::snprintf(num, sizeof(num), "%02d", song);
+	return addOutputPathSuffix(path, num);
+}
+
+std::string getTrackName(SongType type, const TrackAttribute& attrib)
+{
+	int ch = attrib.channelInSource;
+	switch (attrib.source) {
+	case SoundSource::FM:
+		if (type == SongType::FM3chExpanded) {
+			switch (ch) {
+			case 2:	return "fm3op1";
+			case 6:	return "fm3op2";
+			case 7:	return "fm3op3";
+			case 8:	return "fm3op4";
+			default:	break;
+			}
+		}
+		return "fm" + std::to_string(ch + 1);
+	case SoundSource::SSG:
+		return "ssg" + std::to_string(ch + 1);
+	case SoundSource::RHYTHM:
+	{
+		static const char* const NAMES[] = { "bd", "sd", "top", "hh", "tom", "rim" };
+		return NAMES[ch];
+	}
+	case SoundSource::ADPCM:
+		return "adpcm";
+	default:
+		return std::to_string(attrib.number);
+	}
+}
+
+void printOptimization(const std::string& path, const chip::AbstractRegisterWriteLogger::OptimizationStatistics& stats)
+{
+	std::fprintf(stderr, "%s: dropped %zu redundant register writes, saved %zu bytes\n",
+				 path.c_str(), stats.droppedWrites, stats.savedBytes);
+}
+
+std::string formatTime(const SongPlaybackTiming& timing, size_t ticks)
+{
+	auto ms = static_cast<unsigned long long>(timing.ticksToSecond(ticks) * 1000. + .5);
+	char str[32];
+	std::snprintf(str, sizeof(str), "%llu:%02llu.%03llu", ms / 60000, ms / 1000 % 60, ms % 1000);
+	return str;
+}
+
+void printLength(int song, const SongPlaybackTiming& timing)
+{
+	std::printf("Song %02d: %s (%zu ticks, %zu steps)\n", song,
+				formatTime(timing, timing.totalTicks).c_str(), timing.totalTicks, timing.totalSteps);
+	if (timing.hasLoop()) {
+		std::printf("  Loop: order %02X step %02X at %s\n", timing.loopOrder, timing.loopStep,
+					formatTime(timing, timing.introTicks).c_str());
+	}
+	else {
+		std::printf("  No loop\n");
+	}
+	for (size_t i = 0; i < timing.orderTicks.size(); ++i) {
+		if (timing.orderTicks[i] == SongPlaybackTiming::NOT_REACHED)
+			std::printf("  Order %02zX: not played\n", i);
+		else
+			std::printf("  Order %02zX: %s\n", i, formatTime(timing, timing.orderTicks[i]).c_str());
+	}
+}
+
+bool writeFile(const std::string& path, const uint8_t* data, size_t size)
+{
+	std::ofstream ofs(path, std::ios::binary);
+	if (!ofs) return false;
+	ofs.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	return static_cast<bool>(ofs);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	Options opts;
+	if (!parseOptions(argc, argv, opts)) {
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	try {
+		auto config = std::make_shared<Configuration>();
+		config->setEmulator(opts.emulator);
+		config->setYmfmFidelity(opts.fidelity);
+		config->setSampleRate(opts.rate);
+
+		std::vector<uint8_t> file;
+		if (!readFile(opts.inputPath, file)) {
+			std::fprintf(stderr, "Failed to read %s\n", opts.inputPath.c_str());
+			return 1;
+		}
+		auto snapshot = BatchExporter::makeSnapshot(io::BinaryContainer(std::move(file)));
+
+		size_t songCount;
+		{
+			BambooTracker bt(config);
+			io::BinaryContainer container = io::BinaryContainer::view(snapshot->data(), snapshot->size());
+			bt.loadModule(container);
+			songCount = bt.getSongCount();
+			if (opts.song >= 0 && static_cast<size_t>(opts.song) >= songCount) {
+				std::fprintf(stderr, "Song %d does not exist\n", opts.song);
+				return 1;
+			}
+
+			if (opts.printLength) {
+				for (size_t i = 0; i < songCount; ++i) {
+					int song = static_cast<int>(i);
+					if (opts.song < 0 || opts.song == song)
+						printLength(song, bt.getSongPlaybackTiming(song, static_cast<size_t>(opts.loopCount)));
+				}
+				return 0;
+			}
+		}
+
+		auto makeTask = [&opts](const std::string& path) -> BatchExporter::ExportTask {
+			return [opts, path](BambooTracker& bt, BatchExporter::ExportCancellCallback checkFunc) {
+				bt.setModulePath(opts.inputPath);
+				switch (opts.format) {
+				case OutputFormat::Wav:
+					if (opts.stems) {
+						std::vector<io::WavContainer> containers;
+						if (!bt.exportStemsToWav(containers, opts.rate, opts.loopCount, checkFunc)) return false;
+						SongStyle style = bt.getSongStyle(bt.getCurrentSongNumber());
+						for (size_t i = 0; i < containers.size(); ++i) {
+							std::string stemPath = addOutputPathSuffix(path, getTrackName(style.type, style.trackAttribs[i]));
+							if (!writeFile(stemPath, containers[i].data(), containers[i].size())) return false;
+						}
+						return true;
+					}
+					else {
+						io::WavContainer container(opts.rate, 2, 16);
+						return bt.exportToWav(container, opts.loopCount, checkFunc)
+								&& writeFile(path, container.data(), container.size());
+					}
+				case OutputFormat::Vgm:
+				{
+					io::FileExportSink sink(path);
+					if (!sink.good()) return false;
+					if (bt.exportToVgm(sink, opts.target, false, io::GD3Tag(), false, 0., checkFunc) && sink.close()) {
+						printOptimization(path, bt.getLastExportOptimization());
+						return true;
+					}
+					sink.close();
+					std::remove(path.c_str());	// Do not leave a truncated file
+					return false;
+				}
+				case OutputFormat::S98:
+				{
+					io::FileExportSink sink(path);
+					if (!sink.good()) return false;
+					if (bt.exportToS98(sink, opts.target, false, io::S98Tag(), opts.resolution, checkFunc) && sink.close()) {
+						printOptimization(path, bt.getLastExportOptimization());
+						return true;
+					}
+					sink.close();
+					std::remove(path.c_str());	// Do not leave a truncated file
+					return false;
+				}
+				default:
+					return false;
+				}
+			};
+		};
+
+		BatchExporter exporter(config, static_cast<size_t>(opts.jobs));
+		std::vector<std::string> outputPaths;
+		if (opts.song < 0) {
+			for (size_t i = 0; i < songCount; ++i) {
+				outputPaths.push_back(makeSongOutputPath(opts.outputPath, static_cast<int>(i)));
+				exporter.addJob(snapshot, static_cast<int>(i), makeTask(outputPaths.back()));
+			}
+		}
+		else {
+			outputPaths.push_back(opts.outputPath);
+			exporter.addJob(snapshot, opts.song, makeTask(outputPaths.back()));
+		}
+
+		std::vector<bool> results = exporter.run([] { return false; });
+		int ret = 0;
+		for (size_t i = 0; i < results.size(); ++i) {
+			if (!results[i]) {
+				std::fprintf(stderr, "Failed to export %s\n", outputPaths[i].c_str());
+				ret = 1;
+			}
+		}
+		return ret;
+	}
+	catch (std::exception& e) {
+		std::fprintf(stderr, "Error: %s\n", e.what());
+		return 1;
+	}
+}
@@ -38,13 +38,14 @@ void SwapInstrumentsCommand::swapInstrumentsInPatterns()
 		Song& song = mod_.lock()->getSong(static_cast<int>(n));
 		for (const auto& attrib : song.getStyle().trackAttribs) {
 			Track& track = song.getTrack(attrib.number);
-			for (int i = 0; i < 256; ++i) {	// Used track size
+			for (int i : track.getEditedPatternIndices()) {	// Unallocated patterns have no instruments
 				Pattern& pat = track.getPattern(i);
 				for (size_t j = 0; j < pat.getSize(); ++j) {
 					Step& step = pat.getStep(static_cast<int>(j));
 					if (step.getInstrumentNumber() == inst1Num_) step.setInstrumentNumber(inst2Num_);
 					else if (step.getInstrumentNumber() == inst2Num_) step.setInstrumentNumber(inst1Num_);
 				}
+				pat.invalidateCache();
 			}
 		}
 	}
@@ -67,7 +67,7 @@ bool ChangeValuesInPatternCommand::redo()
 		auto valit = it->begin();
 		while (true) {
 			Track& tr = sng.getTrack(track);
-			Step& st = tr.getPatternFromOrderNumber(order_).getStep(step);
+			Step& st = command_utils::getStep(sng, track, order_, step);
 			switch (col) {
 			case 1:
 				if (st.hasInstrument())
@@ -48,6 +48,7 @@ bool InterpolatePatternCommand::redo()
 			Pattern& pattern = command_utils::getPattern(song, trackIndex, order_);
 			Step& firstStep = pattern.getStep(bStep_);
 			Step& lastStep = pattern.getStep(eStep_);
+			pattern.invalidateCache();
 
 			switch (columnIndex) {
 			case 0: {
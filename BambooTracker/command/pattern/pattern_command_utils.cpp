@@ -107,7 +107,9 @@ void restorePattern(Song& song, const Vector2d<std::string>& cells, int beginTra
 				}
 			}
 
-			Step& step = song.getTrack(trackIndex).getPatternFromOrderNumber(beginOrder).getStep(stepIndex);
+			Pattern& pattern = song.getTrack(trackIndex).getPatternFromOrderNumber(beginOrder);
+			Step& step = pattern.getStep(stepIndex);
+			pattern.invalidateCache();
 			switch (columnIndex) {
 			case 0:
 				step.setNoteNumber(std::stoi(cell));
@@ -12,15 +12,17 @@
 
 namespace command_utils
 {
-inline Step& getStep(std::weak_ptr<Module> mod, int song, int track, int order, int step)
+/// Get a step to be edited. It also discards the cached pattern size and effects and renews the revision.
+inline Step& getStep(Song& song, int track, int order, int step)
 {
-	return mod.lock()->getSong(song).getTrack(track)
-			.getPatternFromOrderNumber(order).getStep(step);
+	Pattern& pattern = song.getTrack(track).getPatternFromOrderNumber(order);
+	pattern.invalidateCache();
+	return pattern.getStep(step);
 }
 
-inline Step& getStep(Song& song, int track, int order, int step)
+inline Step& getStep(std::weak_ptr<Module> mod, int song, int track, int order, int step)
 {
-	return song.getTrack(track).getPatternFromOrderNumber(order).getStep(step);
+	return getStep(mod.lock()->getSong(song), track, order, step);
 }
 
 inline Pattern& getPattern(std::weak_ptr<Module> mod, int song, int track, int order)
@@ -292,10 +292,14 @@ Configuration::Configuration()
 	sndDevice_ = u8"";
 	realChip_ = RealChipInterfaceType::NONE;
 	emulator_ = 1;
+	ymfmFidelity_ = 0;
 	sampleRate_ = 44100;
 	bufferLength_ = 40;
+	renderAheadLength_ = 0;
 	resamplerType_ = chip::ResamplerType::BlipBuf;
 	isImmediateWriteMode_ = false;
+	isSsgPipeline_ = false;
+	isAdaptiveQuality_ = false;
 
 	// Midi //
 	midiEnabled_ = false;
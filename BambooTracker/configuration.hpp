@@ -297,23 +297,35 @@ public:
 	RealChipInterfaceType getRealChipInterface() const { return realChip_; }
 	void setEmulator(int emulator) { emulator_ = emulator; }
 	int getEmulator() const { return emulator_; }
+	void setYmfmFidelity(int fidelity) { ymfmFidelity_ = fidelity; }
+	int getYmfmFidelity() const { return ymfmFidelity_; }
 	void setSampleRate(uint32_t rate) { sampleRate_ = rate; }
 	uint32_t getSampleRate() const { return sampleRate_; }
 	void setBufferLength(size_t length) { bufferLength_ = length; }
 	size_t getBufferLength() const { return bufferLength_; }
+	void setRenderAheadLength(size_t length) { renderAheadLength_ = length; }
+	size_t getRenderAheadLength() const { return renderAheadLength_; }
 	void setResamplerType(chip::ResamplerType type) { resamplerType_ = type; }
 	chip::ResamplerType getResamplerType() const { return resamplerType_; }
 	void setImmediateWriteModeEnabled(bool enabled) { isImmediateWriteMode_ = enabled; }
 	bool getImmediateWriteModeEnabled() const { return isImmediateWriteMode_; }
+	void setSsgPipelineEnabled(bool enabled) { isSsgPipeline_ = enabled; }
+	bool getSsgPipelineEnabled() const { return isSsgPipeline_; }
+	void setAdaptiveQualityEnabled(bool enabled) { isAdaptiveQuality_ = enabled; }
+	bool getAdaptiveQualityEnabled() const { return isAdaptiveQuality_; }
 
 private:
 	std::string sndAPI_, sndDevice_;
 	RealChipInterfaceType realChip_;
 	int emulator_;
+	int ymfmFidelity_;
 	uint32_t sampleRate_;
 	size_t bufferLength_;
+	size_t renderAheadLength_;
 	chip::ResamplerType resamplerType_;
 	bool isImmediateWriteMode_;
+	bool isSsgPipeline_;
+	bool isAdaptiveQuality_;
 
 	// Midi //
 public:
@@ -304,8 +304,16 @@ ConfigurationDialog::ConfigurationDialog(std::weak_ptr<Configuration> config, st
 	ui->emulatorComboBox->addItem("Nuked OPN-Mod", static_cast<int>(chip::OpnaEmulator::Nuked));
 	ui->emulatorComboBox->addItem("ymfm", static_cast<int>(chip::OpnaEmulator::Ymfm));
 	ui->emulatorComboBox->setCurrentIndex(ui->emulatorComboBox->findData(configLocked->getEmulator()));
+	ui->ymfmFidelityComboBox->addItem(tr("Maximum fidelity"), static_cast<int>(chip::YmfmFidelity::Maximum));
+	ui->ymfmFidelityComboBox->addItem(tr("Medium fidelity"), static_cast<int>(chip::YmfmFidelity::Medium));
+	ui->ymfmFidelityComboBox->addItem(tr("Minimum fidelity"), static_cast<int>(chip::YmfmFidelity::Minimum));
+	ui->ymfmFidelityComboBox->addItem(tr("Fidelity by sample rate"), static_cast<int>(chip::YmfmFidelity::Auto));
+	ui->ymfmFidelityComboBox->setCurrentIndex(ui->ymfmFidelityComboBox->findData(configLocked->getYmfmFidelity()));
+	on_emulatorComboBox_currentIndexChanged(ui->emulatorComboBox->currentIndex());
 
 	ui->zeroWaitWriteCheckBox->setChecked(configLocked->getImmediateWriteModeEnabled());
+	ui->ssgThreadCheckBox->setChecked(configLocked->getSsgPipelineEnabled());
+	ui->adaptiveQualityCheckBox->setChecked(configLocked->getAdaptiveQualityEnabled());
 
 	{
 		QSignalBlocker blocker(ui->audioApiComboBox);
@@ -366,6 +374,9 @@ ConfigurationDialog::ConfigurationDialog(std::weak_ptr<Configuration> config, st
 	ui->resamplerComboBox->addItem(QString("Linear (%1)").arg(tr("old, deprecated")), static_cast<int>(chip::ResamplerType::Linear));
 	ui->resamplerComboBox->addItem("blip_buf", static_cast<int>(chip::ResamplerType::BlipBuf));
 	ui->resamplerComboBox->addItem(QString("blip_buf (%1)").arg(tr("fast")), static_cast<int>(chip::ResamplerType::FastBlipBuf));
+	ui->resamplerComboBox->addItem(QString("Sinc (%1)").arg(tr("fast")), static_cast<int>(chip::ResamplerType::SincFast));
+	ui->resamplerComboBox->addItem(QString("Sinc (%1)").arg(tr("medium quality")), static_cast<int>(chip::ResamplerType::SincMedium));
+	ui->resamplerComboBox->addItem(QString("Sinc (%1)").arg(tr("best quality")), static_cast<int>(chip::ResamplerType::SincBest));
 	for (int i = 0; i < ui->resamplerComboBox->count(); ++i) {
 		if (static_cast<chip::ResamplerType>(ui->resamplerComboBox->itemData(i).toInt()) == configLocked->getResamplerType()) {
 			ui->resamplerComboBox->setCurrentIndex(i);
@@ -380,6 +391,15 @@ ConfigurationDialog::ConfigurationDialog(std::weak_ptr<Configuration> config, st
 	});
 	ui->bufferLengthHorizontalSlider->setValue(static_cast<int>(configLocked->getBufferLength()));
 
+	ui->renderAheadHorizontalSlider->setStyle(SliderStyle::instance());
+	QObject::connect(ui->renderAheadHorizontalSlider, &QSlider::valueChanged,
+					 this, [&](int value) {
+		ui->renderAheadLabel->setText(QString::number(value) + "ms");
+	});
+	ui->renderAheadGroupBox->setChecked(configLocked->getRenderAheadLength() > 0);
+	ui->renderAheadHorizontalSlider->setValue(configLocked->getRenderAheadLength()
+											  ? static_cast<int>(configLocked->getRenderAheadLength()) : 100);
+
 	// Mixer //
 	ui->masterMixerSlider->setText(tr("Master"));
 	ui->masterMixerSlider->setSuffix("%");
@@ -489,8 +509,15 @@ void ConfigurationDialog::on_ConfigurationDialog_accepted()
 		configLocked->setEmulator(emu);
 		changedEmu = true;
 	}
+	int fidelity = ui->ymfmFidelityComboBox->currentData().toInt();
+	if (fidelity != configLocked->getYmfmFidelity()) {
+		configLocked->setYmfmFidelity(fidelity);
+		changedEmu |= (emu == static_cast<int>(chip::OpnaEmulator::Ymfm));
+	}
 
 	configLocked->setImmediateWriteModeEnabled(ui->zeroWaitWriteCheckBox->isChecked());
+	configLocked->setSsgPipelineEnabled(ui->ssgThreadCheckBox->isChecked());
+	configLocked->setAdaptiveQualityEnabled(ui->adaptiveQualityCheckBox->isChecked());
 
 	configLocked->setSoundDevice(ui->audioDeviceComboBox->currentText().toUtf8().toStdString());
 	configLocked->setSoundAPI(ui->audioApiComboBox->currentText().toUtf8().toStdString());
@@ -502,6 +529,8 @@ void ConfigurationDialog::on_ConfigurationDialog_accepted()
 	configLocked->setSampleRate(ui->sampleRateComboBox->currentData(Qt::UserRole).toUInt());
 	configLocked->setResamplerType(static_cast<chip::ResamplerType>(ui->resamplerComboBox->currentData().toInt()));
 	configLocked->setBufferLength(static_cast<size_t>(ui->bufferLengthHorizontalSlider->value()));
+	configLocked->setRenderAheadLength(ui->renderAheadGroupBox->isChecked()
+									   ? static_cast<size_t>(ui->renderAheadHorizontalSlider->value()) : 0);
 
 	// Mixer //
 	configLocked->setMixerVolumeMaster(ui->masterMixerSlider->value());
@@ -559,6 +588,12 @@ void ConfigurationDialog::on_mixerResetPushButton_clicked()
 }
 
 /***** Sound *****/
+void ConfigurationDialog::on_emulatorComboBox_currentIndexChanged(int index)
+{
+	ui->ymfmFidelityComboBox->setEnabled(
+				ui->emulatorComboBox->itemData(index).toInt() == static_cast<int>(chip::OpnaEmulator::Ymfm));
+}
+
 void ConfigurationDialog::on_audioApiComboBox_currentIndexChanged(const QString &arg1)
 {
 	ui->audioDeviceComboBox->clear();
@@ -256,10 +256,14 @@ bool saveConfiguration(std::weak_ptr<Configuration> config)
 		settings.setValue("soundDevice", gui_utils::utf8ToQString(configLocked->getSoundDevice()));
 		settings.setValue("realChipInterface",	static_cast<int>(configLocked->getRealChipInterface()));
 		settings.setValue("emulator",		configLocked->getEmulator());
+		settings.setValue("ymfmFidelity",	configLocked->getYmfmFidelity());
 		settings.setValue("sampleRate",   static_cast<int>(configLocked->getSampleRate()));
 		settings.setValue("bufferLength", static_cast<int>(configLocked->getBufferLength()));
+		settings.setValue("renderAheadLength", static_cast<int>(configLocked->getRenderAheadLength()));
 		settings.setValue("resamplerType", static_cast<int>(configLocked->getResamplerType()));
 		settings.setValue("immediateWriteModeEnabled", configLocked->getImmediateWriteModeEnabled());
+		settings.setValue("ssgPipelineEnabled", configLocked->getSsgPipelineEnabled());
+		settings.setValue("adaptiveQualityEnabled", configLocked->getAdaptiveQualityEnabled());
 		settings.endGroup();
 
 		// Midi //
@@ -440,15 +444,21 @@ bool loadConfiguration(std::weak_ptr<Configuration> config)
 		configLocked->setRealChipInterface(static_cast<RealChipInterfaceType>(
 											   settings.value("realChipInterface", static_cast<int>(configLocked->getRealChipInterface())).toInt()));
 		configLocked->setEmulator(settings.value("emulator", configLocked->getEmulator()).toInt());
+		configLocked->setYmfmFidelity(settings.value("ymfmFidelity", configLocked->getYmfmFidelity()).toInt());
 		QVariant sampleRateWorkaround;
 		sampleRateWorkaround.setValue(configLocked->getSampleRate());
 		configLocked->setSampleRate(static_cast<uint32_t>(settings.value("sampleRate", sampleRateWorkaround).toInt()));
 		QVariant bufferLengthWorkaround;
 		bufferLengthWorkaround.setValue(configLocked->getBufferLength());
 		configLocked->setBufferLength(static_cast<size_t>(settings.value("bufferLength", bufferLengthWorkaround).toInt()));
+		QVariant renderAheadLengthWorkaround;
+		renderAheadLengthWorkaround.setValue(configLocked->getRenderAheadLength());
+		configLocked->setRenderAheadLength(static_cast<size_t>(settings.value("renderAheadLength", renderAheadLengthWorkaround).toInt()));
 		configLocked->setResamplerType(static_cast<chip::ResamplerType>(
 										   settings.value("resamplerType", static_cast<int>(configLocked->getResamplerType())).toInt()));
 		configLocked->setImmediateWriteModeEnabled(settings.value("immediateWriteModeEnabled", configLocked->getImmediateWriteModeEnabled()).toBool());
+		configLocked->setSsgPipelineEnabled(settings.value("ssgPipelineEnabled", configLocked->getSsgPipelineEnabled()).toBool());
+		configLocked->setAdaptiveQualityEnabled(settings.value("adaptiveQualityEnabled", configLocked->getAdaptiveQualityEnabled()).toBool());
 		settings.endGroup();
 
 		// Midi //
@@ -335,17 +335,17 @@ void ADPCMSampleEditor::importSampleFrom(const QString file)
 {
 	std::unique_ptr<io::WavContainer> wav;
 	try {
-		io::BinaryContainer container;
+		QByteArray array;
 		{
 			QFile fp(file);
 			if (!fp.open(QIODevice::ReadOnly)) {
 				FileIOErrorMessageBox::openError(file, true, io::FileType::WAV, this);
 				return;
 			}
-			QByteArray array = fp.readAll();
+			array = fp.readAll();
 			fp.close();
-			std::move(array.begin(), array.end(), std::back_inserter(container));
 		}
+		auto container = io::BinaryContainer::view(array.constData(), static_cast<size_t>(array.size()));
 
 		wav = std::make_unique<io::WavContainer>(container);
 	}
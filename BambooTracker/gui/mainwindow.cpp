@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <array>
 #include <numeric>
+#include <thread>
+#include <atomic>
 #include <QString>
 #include <QClipboard>
 #include <QMenu>
@@ -39,6 +41,7 @@
 #include "io/binary_container.hpp"
 #include "io/wav_container.hpp"
 #include "version.hpp"
+#include "batch_exporter.hpp"
 #include "gui/command/instrument/instrument_commands_qt.hpp"
 #include "gui/instrument_editor/fm_instrument_editor.hpp"
 #include "gui/instrument_editor/ssg_instrument_editor.hpp"
@@ -79,6 +82,53 @@ const std::unordered_map<Configuration::ToolbarPosition, Qt::ToolBarArea> TB_POS
 };
 
 constexpr int STATUS_DISPLAY_TIMEOUT = 0;
+
+// Interval of the load measurement for the adaptive quality
+constexpr int GOVERNOR_INTERVAL = 500;
+// Interval of checking the playback counts shown in the status bar
+constexpr int PLAYBACK_STATUS_INTERVAL = 500;
+
+QString getResamplerName(chip::ResamplerType type)
+{
+	switch (type) {
+	case chip::ResamplerType::Linear:		return "Linear";
+	case chip::ResamplerType::BlipBuf:		return "blip_buf";
+	case chip::ResamplerType::FastBlipBuf:	return QString("blip_buf (%1)").arg(MainWindow::tr("fast"));
+	case chip::ResamplerType::SincFast:		return QString("Sinc (%1)").arg(MainWindow::tr("fast"));
+	case chip::ResamplerType::SincMedium:	return QString("Sinc (%1)").arg(MainWindow::tr("medium quality"));
+	case chip::ResamplerType::SincBest:		return QString("Sinc (%1)").arg(MainWindow::tr("best quality"));
+	default:								return QString();
+	}
+}
+
+std::vector<int> getMutedTracks(BambooTracker& bt)
+{
+	std::vector<int> tracks;
+	for (const TrackAttribute& attrib : bt.getSongStyle(bt.getCurrentSongNumber()).trackAttribs) {
+		if (bt.isMute(attrib.number)) tracks.push_back(attrib.number);
+	}
+	return tracks;
+}
+
+/// Count up the steps played by an export job.
+BatchExporter::ExportCancellCallback countSteps(std::atomic_int& stepCount, BatchExporter::ExportCancellCallback checkFunc)
+{
+	return [&stepCount, checkFunc] {
+		++stepCount;
+		return checkFunc();
+	};
+}
+
+/// Run export jobs while the progress dialog shows the steps played by the jobs.
+bool runExportJobs(BatchExporter& exporter, QProgressDialog& progress, const std::atomic_int& stepCount)
+{
+	std::vector<bool> results = exporter.run([&] {
+		progress.setValue(std::min(stepCount.load(), progress.maximum() - 1));
+		QApplication::processEvents();
+		return progress.wasCanceled();
+	});
+	return std::all_of(results.begin(), results.end(), [](bool b) { return b; });
+}
 }
 
 ModuleSaveCheckDialog::ModuleSaveCheckDialog(const std::string& name, QWidget* parent) :
@@ -103,6 +153,11 @@ MainWindow::MainWindow(std::weak_ptr<Configuration> config, QString filePath, bo
 	renamingInstEdit_(nullptr),
 	isModifiedForNotCommand_(false),
 	hasLockedWigets_(false),
+	governor_(std::thread::hardware_concurrency()),
+	governedSettings_{ chip::ResamplerType::BlipBuf, false, chip::YmfmFidelity::Maximum, 0 },
+	shownUnderrunCount_(0),
+	shownAvoidedDropoutCount_(0),
+	shownSkippedTickCount_(0),
 	isEditedPattern_(true),
 	isEditedOrder_(false),
 	isEditedInstList_(false),
@@ -728,14 +783,25 @@ MainWindow::MainWindow(std::weak_ptr<Configuration> config, QString filePath, bo
 
 	/* Audio stream */
 	stream_ = std::make_shared<AudioStreamRtAudio>();
-	stream_->setTickUpdateCallback(+[](void* cbPtr) -> int {
+	stream_->setTickUpdateCallback(+[](void* cbPtr) -> AudioStream::Tick {
 		auto bt = reinterpret_cast<BambooTracker*>(cbPtr);
-		return bt->streamCountUp();
+		int state = bt->streamCountUp();
+		return { state, bt->getStreamOrderNumber(), bt->getStreamStepNumber() };
 	}, bt_.get());
+	bt_->setLiveEventCallback([&] { stream_->skipRenderedAhead(); });
 	stream_->setGenerateCallback(+[](int16_t* container, size_t nSamples, void* cbPtr) {
 		auto bt = reinterpret_cast<BambooTracker*>(cbPtr);
 		return bt->getStreamSamples(container, nSamples);
 	}, bt_.get());
+	stream_->setRenderAheadLength(static_cast<uint32_t>(config.lock()->getRenderAheadLength()));
+	governorTimer_.reset(new QTimer);
+	QObject::connect(governorTimer_.get(), &QTimer::timeout, this, &MainWindow::updateQualityGovernor);
+	playbackStatusTimer_.reset(new QTimer);
+	QObject::connect(playbackStatusTimer_.get(), &QTimer::timeout, this, [&] {
+		updateAudioStreamStatus();
+		updateRealChipTimerStatus();
+	});
+	playbackStatusTimer_->start(PLAYBACK_STATUS_INTERVAL);
 	QObject::connect(stream_.get(), &AudioStream::streamInterrupted, this, &MainWindow::onNewTickSignaled);
 	QObject::connect(stream_.get(), &AudioStream::streamErrorInCallback,
 					 this, [&](const QVariant&) {
@@ -821,7 +887,8 @@ MainWindow::MainWindow(std::weak_ptr<Configuration> config, QString filePath, bo
 	RealChipInterfaceType intf = config.lock()->getRealChipInterface();
 	if (intf != RealChipInterfaceType::NONE) {
 		tickTimerForRealChip_ = std::make_unique<PreciseTimer>();
-		tickTimerForRealChip_->setInterval(1000000 / bt_->getModuleTickFrequency());
+		tickTimerForRealChip_->setFrequency(static_cast<uint32_t>(bt_->getModuleTickFrequency()));
+		tickTimerForRealChip_->setRealtimePriority(true);
 		tickEventMethod_ = metaObject()->indexOfSlot("onNewTickSignaledRealChip()");
 		Q_ASSERT(tickEventMethod_ != -1);
 		tickTimerForRealChip_->setFunction([&]{
@@ -834,6 +901,8 @@ MainWindow::MainWindow(std::weak_ptr<Configuration> config, QString filePath, bo
 		tickTimerForRealChip_->start();
 	}
 
+	setQualityGovernor();
+
 	/* Load module */
 	if (filePath.isEmpty()) {
 		loadModule();
@@ -1768,17 +1837,17 @@ void MainWindow::funcLoadInstrument(QString file)
 	}
 
 	try {
-		io::BinaryContainer container;
+		QByteArray array;
 		{
 			QFile fp(file);
 			if (!fp.open(QIODevice::ReadOnly)) {
 				FileIOErrorMessageBox::openError(file, true, io::FileType::Inst, this);
 				return;
 			}
-			QByteArray&& array = fp.readAll();
+			array = fp.readAll();
 			fp.close();
-			std::move(array.begin(), array.end(), std::back_inserter(container));
 		}
+		auto container = io::BinaryContainer::view(array.constData(), static_cast<size_t>(array.size()));
 		bt_->loadInstrument(container, file.toStdString(), n);
 
 		auto inst = bt_->getInstrument(n);
@@ -1823,8 +1892,7 @@ void MainWindow::saveInstrument()
 		{
 			io::BinaryContainer container;
 			bt_->saveInstrument(container, n);
-			bytes.reserve(container.size());
-			std::move(container.begin(), container.end(), std::back_inserter(bytes));
+			bytes = QByteArray(reinterpret_cast<const char*>(container.data()), static_cast<int>(container.size()));
 		}
 		QFile fp(file);
 		if (!fp.open(QIODevice::WriteOnly)) {
@@ -1874,17 +1942,17 @@ void MainWindow::funcImportInstrumentsFromBank(QString file)
 
 	std::unique_ptr<AbstractBank> bank;
 	try {
-		io::BinaryContainer container;
+		QByteArray array;
 		{
 			QFile fp(file);
 			if (!fp.open(QIODevice::ReadOnly)) {
 				FileIOErrorMessageBox::openError(file, true, io::FileType::Bank, this);
 				return;
 			}
-			QByteArray&& array = fp.readAll();
+			array = fp.readAll();
 			fp.close();
-			std::move(array.begin(), array.end(), std::back_inserter(container));
 		}
+		auto container = io::BinaryContainer::view(array.constData(), static_cast<size_t>(array.size()));
 
 		bank.reset(io::BankIO::getInstance().loadBank(container, file.toStdString()));
 		config_.lock()->setWorkingDirectory(QFileInfo(file).dir().path().toStdString());
@@ -2038,8 +2106,7 @@ void MainWindow::exportInstrumentsToBank()
 		{
 			io::BinaryContainer container;
 			bt_->exportInstruments(container, sel);
-			bytes.reserve(container.size());
-			std::move(container.begin(), container.end(), std::back_inserter(bytes));
+			bytes = QByteArray(reinterpret_cast<const char*>(container.data()), static_cast<int>(container.size()));
 		}
 		QFile fp(file);
 		if (!fp.open(QIODevice::WriteOnly)) {
@@ -2131,7 +2198,7 @@ void MainWindow::loadModule()
 
 	// Set tick frequency
 	stream_->setInterruption(bt_->getModuleTickFrequency());
-	if (tickTimerForRealChip_) tickTimerForRealChip_->setInterval(1000000 / bt_->getModuleTickFrequency());
+	if (tickTimerForRealChip_) tickTimerForRealChip_->setFrequency(static_cast<uint32_t>(bt_->getModuleTickFrequency()));
 	statusIntr_->setText(QString::number(bt_->getModuleTickFrequency()) + QString("Hz"));
 
 	// Set mixer
@@ -2195,14 +2262,25 @@ void MainWindow::openModule(const QString& file)
 
 		QFile fp(file);
 		if (fp.open(QIODevice::ReadOnly)) {
-			io::BinaryContainer container;
 			{
-				QByteArray&& array = fp.readAll();
+				// Parse the module in place from the read-only mapped file.
+				// Fall back to reading it when the file cannot be mapped.
+				QByteArray array;
+				const qint64 fileSize = fp.size();
+				const uchar* mapped = fileSize ? fp.map(0, fileSize) : nullptr;
+				io::BinaryContainer container;
+				if (mapped) {
+					container = io::BinaryContainer::view(mapped, static_cast<size_t>(fileSize));
+				}
+				else {
+					array = fp.readAll();
+					container = io::BinaryContainer::view(array.constData(), static_cast<size_t>(array.size()));
+				}
+
+				bt_->loadModule(container);
+				if (mapped) fp.unmap(const_cast<uchar*>(mapped));
 				fp.close();
-				std::move(array.begin(), array.end(), std::back_inserter(container));
 			}
-
-			bt_->loadModule(container);
 			bt_->setModulePath(file.toStdString());
 
 			loadModule();
@@ -2419,6 +2497,7 @@ void MainWindow::changeConfiguration()
 		tickTimerForRealChip_.reset();
 		bt_->connectToRealChip(RealChipInterfaceType::NONE);
 
+        stream_->setRenderAheadLength(static_cast<uint32_t>(config_.lock()->getRenderAheadLength()));
         try {
             QString streamErr;
             streamState = stream_->initialize(
@@ -2454,7 +2533,8 @@ void MainWindow::changeConfiguration()
 		}
 		else {
 			tickTimerForRealChip_ = std::make_unique<PreciseTimer>();
-			tickTimerForRealChip_->setInterval(1000000 / bt_->getModuleTickFrequency());
+			tickTimerForRealChip_->setFrequency(static_cast<uint32_t>(bt_->getModuleTickFrequency()));
+			tickTimerForRealChip_->setRealtimePriority(true);
 			tickEventMethod_ = metaObject()->indexOfSlot("onNewTickSignaledRealChip()");
 			Q_ASSERT(tickEventMethod_ != -1);
 			tickTimerForRealChip_->setFunction([&]{
@@ -2476,6 +2556,7 @@ void MainWindow::changeConfiguration()
 	instDialogMan_->updateByConfiguration();
 
 	bt_->changeConfiguration(config_);
+	setQualityGovernor();
 
 	if (streamState) {
 		uint32_t sr = stream_->getStreamRate();
@@ -2496,6 +2577,86 @@ void MainWindow::changeConfiguration()
 	update();
 }
 
+void MainWindow::setQualityGovernor()
+{
+	std::shared_ptr<Configuration> configLocked = config_.lock();
+	// Fidelity is not taken from the configuration, which is applied at the next start
+	chip::YmfmFidelity fidelity = bt_->getYmfmFidelity();
+	if (governedSettings_.fidelity != fidelity) bt_->setYmfmFidelity(fidelity);
+	governedSettings_ = {
+		configLocked->getResamplerType(),
+		configLocked->getSsgPipelineEnabled(),
+		fidelity,
+		static_cast<uint32_t>(configLocked->getRenderAheadLength())
+	};
+	governor_.setBaseSettings(governedSettings_, bt_->isYmfmEmulator());
+
+	if (configLocked->getAdaptiveQualityEnabled()
+			&& configLocked->getRealChipInterface() == RealChipInterfaceType::NONE) {
+		stream_->takeLoad();	// Discard the load with the previous settings
+		governorTimer_->start(GOVERNOR_INTERVAL);
+	}
+	else {
+		governorTimer_->stop();
+	}
+}
+
+void MainWindow::updateQualityGovernor()
+{
+	AudioStream::Load load = stream_->takeLoad();
+	if (!governor_.update(load.average, load.peak)) return;
+
+	const QualityGovernor::Settings& settings = governor_.getSettings();
+	if (settings.resampler != governedSettings_.resampler) bt_->setStreamResampler(settings.resampler);
+	if (settings.ssgPipeline != governedSettings_.ssgPipeline) bt_->setSsgPipelineEnabled(settings.ssgPipeline);
+	if (settings.fidelity != governedSettings_.fidelity) bt_->setYmfmFidelity(settings.fidelity);
+	governedSettings_ = settings;
+
+	QString detail = getResamplerName(settings.resampler);
+	if (settings.ssgPipeline) detail += ", " + tr("SSG thread");
+	if (settings.fidelity == chip::YmfmFidelity::Medium) detail += ", " + tr("medium ymfm fidelity");
+	else if (settings.fidelity == chip::YmfmFidelity::Minimum) detail += ", " + tr("minimum ymfm fidelity");
+	if (settings.renderAheadLength) detail += ", " + tr("render ahead %1ms").arg(settings.renderAheadLength);
+	int percent = static_cast<int>(std::round(governor_.getLastLoad() * 100));
+	QString text = governor_.getLevel()
+				   ? tr("Audio load %1%: reduced quality to %2").arg(percent).arg(detail)
+				   : tr("Audio load %1%: restored quality to %2").arg(percent).arg(detail);
+	ui->statusBar->showMessage(text, STATUS_DISPLAY_TIMEOUT);
+}
+
+void MainWindow::updateAudioStreamStatus()
+{
+	uint64_t underruns = stream_->getRenderAheadUnderrunCount();
+	if (underruns != shownUnderrunCount_) {
+		shownUnderrunCount_ = underruns;
+		ui->statusBar->showMessage(tr("Render-ahead buffer ran short %1 times").arg(underruns),
+								   STATUS_DISPLAY_TIMEOUT);
+	}
+
+	uint64_t avoided = stream_->getAvoidedDropoutCount();
+	if (avoided != shownAvoidedDropoutCount_) {
+		shownAvoidedDropoutCount_ = avoided;
+		ui->statusBar->showMessage(tr("Kept audio playing through settings changes (%1 buffers)").arg(avoided),
+								   STATUS_DISPLAY_TIMEOUT);
+	}
+}
+
+void MainWindow::updateRealChipTimerStatus()
+{
+	if (!tickTimerForRealChip_) return;
+
+	// The statistics restart with the timer
+	PreciseTimer::Statistics stats = tickTimerForRealChip_->getStatistics();
+	if (stats.skipped > shownSkippedTickCount_) {
+		ui->statusBar->showMessage(tr("Real chip timer skipped %1 ticks (mean lateness %2 ms, max %3 ms)")
+								   .arg(stats.skipped)
+								   .arg(stats.meanJitterUs / 1000., 0, 'f', 2)
+								   .arg(stats.maxJitterUs / 1000., 0, 'f', 2),
+								   STATUS_DISPLAY_TIMEOUT);
+	}
+	shownSkippedTickCount_ = stats.skipped;
+}
+
 void MainWindow::setRealChipInterface(RealChipInterfaceType intf)
 {
 	if (intf == bt_->getRealChipInterfaceType()) return;
@@ -3294,8 +3455,7 @@ bool MainWindow::on_actionSave_triggered()
 			{
 				io::BinaryContainer container;
 				bt_->saveModule(container);
-				bytes.reserve(container.size());
-				std::move(container.begin(), container.end(), std::back_inserter(bytes));
+				bytes = QByteArray(reinterpret_cast<const char*>(container.data()), static_cast<int>(container.size()));
 			}
 			QFile fp(path);
 			if (!fp.open(QIODevice::WriteOnly)) {
@@ -3349,8 +3509,7 @@ bool MainWindow::on_actionSave_As_triggered()
 		{
 			io::BinaryContainer container;
 			bt_->saveModule(container);
-			bytes.reserve(container.size());
-			std::move(container.begin(), container.end(), std::back_inserter(bytes));
+			bytes = QByteArray(reinterpret_cast<const char*>(container.data()), static_cast<int>(container.size()));
 		}
 
 		QFile fp(file);
@@ -3500,14 +3659,10 @@ void MainWindow::on_actionRemove_Unused_Patterns_triggered()
 
 void MainWindow::on_actionWAV_triggered()
 {
-	// Record current mute states
 	const auto& style = bt_->getSongStyle(bt_->getCurrentSongNumber());
-	const auto& attribs = style.trackAttribs;
-	std::vector<bool> muteStates(attribs.size());
 	std::vector<int> unmuteTracks;
-	for (size_t i = 0; i < attribs.size(); ++i) {
-		muteStates[i] = bt_->isMute(attribs[i].number);
-		if (!muteStates[i]) unmuteTracks.push_back(static_cast<int>(i));
+	for (const TrackAttribute& attrib : style.trackAttribs) {
+		if (!bt_->isMute(attrib.number)) unmuteTracks.push_back(attrib.number);
 	}
 
 	unmuteTracks = gui_utils::adaptVisibleTrackList(unmuteTracks, style.type, SongType::Standard);
@@ -3527,132 +3682,79 @@ void MainWindow::on_actionWAV_triggered()
 	if (!path.endsWith(".wav")) path += ".wav";	// For linux
 	QString exDir = QFileInfo(path).dir().path();
 
-	int max = static_cast<int>(bt_->getTotalStepCount(
-								   bt_->getCurrentSongNumber(), static_cast<size_t>(dialog.getLoopCount()))) + 3;
-	QProgressDialog progress("", tr("Cancel"), 0, max, this);
-	progress.setWindowModality(Qt::ApplicationModal);
+	const int songNum = bt_->getCurrentSongNumber();
+	const uint32_t rate = static_cast<uint32_t>(dialog.getSampleRate());
+	const int loopCnt = dialog.getLoopCount();
+	std::vector<int> soloTracks = dialog.getSoloExportTracks();
+
+	// Solo tracks are rendered from a single playback
+	std::vector<std::vector<int>> stems;
+	for (int track : soloTracks) {
+		if (style.type == SongType::FM3chExpanded && track >= 2) {
+			if (track == 2) stems.push_back({ 2, 3, 4, 5 });
+			else stems.push_back({ track + 3 });
+		}
+		else {
+			stems.push_back({ track });
+		}
+	}
+
+	// Export a snapshot of the module so that the song keeps playing
+	BatchExporter exporter(config_);
+	BatchExporter::ModuleSnapshot snapshot = BatchExporter::takeSnapshot(*bt_);
+	std::atomic_int stepCount(0);
+	io::WavContainer container(rate, 2, 16);
+	std::vector<int> mutedTracks = getMutedTracks(*bt_);
+	exporter.addJob(snapshot, songNum, [&](BambooTracker& bt, BatchExporter::ExportCancellCallback checkFunc) {
+		for (int track : mutedTracks) bt.setTrackMuteState(track, true);
+		return bt.exportToWav(container, loopCnt, countSteps(stepCount, checkFunc));
+	});
+	std::vector<io::WavContainer> stemContainers;
+	if (!stems.empty()) {
+		exporter.addJob(snapshot, songNum, [&](BambooTracker& bt, BatchExporter::ExportCancellCallback checkFunc) {
+			return bt.exportStemsToWav(stemContainers, rate, loopCnt, countSteps(stepCount, checkFunc), stems);
+		});
+	}
+
+	int max = static_cast<int>(bt_->getTotalStepCount(songNum, static_cast<size_t>(loopCnt))
+							   * exporter.getJobCount()) + 1;
+	QProgressDialog progress(tr("Export to WAV"), tr("Cancel"), 0, max, this);
+	progress.setValue(0);
 	progress.setWindowFlags(progress.windowFlags()
 							& ~Qt::WindowContextHelpButtonHint
 							& ~Qt::WindowCloseButtonHint);
-	auto bar = [&progress] {
-		QApplication::processEvents();
-		progress.setValue(progress.value() + 1);
-		return progress.wasCanceled();
-	};
-
-	unmuteTracks = dialog.getSoloExportTracks();
-	unmuteTracks.insert(unmuteTracks.begin(), -1);
-
-	bt_->stopPlaySong();
-    lockWidgets(false);
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.open();
 
-    try {
-        stream_->stop();
-    }
-    catch (std::exception& e) {
-        showStreamFailedDialog(e.what());
-    }
+	if (!runExportJobs(exporter, progress, stepCount)) {
+		if (!progress.wasCanceled()) FileIOErrorMessageBox(path, false, io::FileType::WAV, "", this).exec();
+		return;
+	}
 
-	for (size_t i = 0; i < unmuteTracks.size(); ++i) {
-		int curTrack = unmuteTracks[i];
-		QString text, name;
-		if (curTrack == -1) text = tr("Export to WAV");	// Mixed all
-		else {
-			if (curTrack < 6) name = gui_utils::getTrackName(SongType::Standard, SoundSource::FM, curTrack);
-			else if (curTrack < 9) name = gui_utils::getTrackName(SongType::Standard, SoundSource::SSG, curTrack - 6);
-			else if (curTrack < 15) name = gui_utils::getTrackName(SongType::Standard, SoundSource::RHYTHM, curTrack - 9);
-			else name = gui_utils::getTrackName(SongType::Standard, SoundSource::ADPCM, 0);
-			text = tr("Export %1 to WAV").arg(name);
-		}
-		progress.setLabelText(text);
-		progress.setValue(0);
-		progress.open();
-
-		// Update mute states
-		if (i == 1) {
-			for (const TrackAttribute& attrib : attribs)
-				bt_->setTrackMuteState(attrib.number, attrib.number != unmuteTracks[i]);
-		}
-		else if (i > 1) {
-			int prevTrack = unmuteTracks[i - 1];
-			if (style.type == SongType::FM3chExpanded) {
-				if (prevTrack == 2) {
-					bt_->setTrackMuteState(2, true);
-					bt_->setTrackMuteState(3, true);
-					bt_->setTrackMuteState(4, true);
-					bt_->setTrackMuteState(5, true);
-				}
-				else if (prevTrack < 2) {
-					bt_->setTrackMuteState(prevTrack, true);
-				}
-				else {
-					bt_->setTrackMuteState(prevTrack + 3, true);
-				}
-				if (curTrack == 2) {
-					bt_->setTrackMuteState(2, false);
-					bt_->setTrackMuteState(3, false);
-					bt_->setTrackMuteState(4, false);
-					bt_->setTrackMuteState(5, false);
-				}
-				else if (curTrack < 2) {
-					bt_->setTrackMuteState(curTrack, false);
-				}
-				else {
-					bt_->setTrackMuteState(curTrack + 3, false);
-				}
-			}
-			else {
-				bt_->setTrackMuteState(prevTrack, true);
-				bt_->setTrackMuteState(curTrack, false);
-			}
+	auto writeWav = [&](const QString& filePath, const io::WavContainer& wav) {
+		QFile fp(filePath);
+		if (!fp.open(QIODevice::WriteOnly)) {
+			FileIOErrorMessageBox::openError(filePath, false, io::FileType::WAV, this);
+			return false;
 		}
+		fp.write(reinterpret_cast<const char*>(wav.data()), static_cast<qint64>(wav.size()));
+		fp.close();
 
-		try {
-			QByteArray bytes;
-			{
-				const uint32_t rate = static_cast<uint32_t>(dialog.getSampleRate());
-				const uint16_t nCh = 2;
-				const int loopCnt = dialog.getLoopCount();
-				io::WavContainer container(rate, nCh, 16);
-				if (!bt_->exportToWav(container, loopCnt, bar))
-					break;	// Jump if cancelled
-				bytes.reserve(container.size());
-				std::move(container.begin(), container.end(), std::back_inserter(bytes));
-			}
-
-			if (curTrack > -1) path = QString("%1/%2 - %3.wav").arg(exDir).arg(curTrack + 1, 2, 10, QChar('0')).arg(name);
-			QFile fp(path);
-			if (!fp.open(QIODevice::WriteOnly)) {
-				FileIOErrorMessageBox::openError(path, false, io::FileType::WAV, this);
-				break;	// Jump to post process
-			}
-			fp.write(bytes);
-			fp.close();
-			bar();
+		config_.lock()->setWorkingDirectory(QFileInfo(filePath).dir().path().toStdString());
+		return true;
+	};
 
-			config_.lock()->setWorkingDirectory(QFileInfo(path).dir().path().toStdString());
-		}
-		catch (io::FileIOError& e) {
-			FileIOErrorMessageBox(path, false, e, this).exec();
-			break;
-		}
-		catch (std::exception& e) {
-			FileIOErrorMessageBox(path, false, io::FileType::WAV, QString(e.what()), this).exec();
-			break;
-		}
+	if (!writeWav(path, container)) return;
+	for (size_t i = 0; i < soloTracks.size(); ++i) {
+		int curTrack = soloTracks[i];
+		QString name;
+		if (curTrack < 6) name = gui_utils::getTrackName(SongType::Standard, SoundSource::FM, curTrack);
+		else if (curTrack < 9) name = gui_utils::getTrackName(SongType::Standard, SoundSource::SSG, curTrack - 6);
+		else if (curTrack < 15) name = gui_utils::getTrackName(SongType::Standard, SoundSource::RHYTHM, curTrack - 9);
+		else name = gui_utils::getTrackName(SongType::Standard, SoundSource::ADPCM, 0);
+		QString stemPath = QString("%1/%2 - %3.wav").arg(exDir).arg(curTrack + 1, 2, 10, QChar('0')).arg(name);
+		if (!writeWav(stemPath, stemContainers[i])) break;
 	}
-
-	// Restore states
-	for (size_t i = 0 ; i < attribs.size(); ++i) {
-		bt_->setTrackMuteState(attribs[i].number, muteStates[i]);
-    }
-
-    try {
-        stream_->start();
-    }
-    catch (std::exception& e) {
-        showStreamFailedDialog(e.what());
-    }
 }
 
 void MainWindow::on_actionVGM_triggered()
@@ -3673,7 +3775,24 @@ void MainWindow::on_actionVGM_triggered()
 	if (path.isNull()) return;
 	if (!path.endsWith(".vgm")) path += ".vgm";	// For linux
 
-	int max = static_cast<int>(bt_->getTotalStepCount(bt_->getCurrentSongNumber(), 1)) + 3;
+	// Export a snapshot of the module so that the song keeps playing
+	const int songNum = bt_->getCurrentSongNumber();
+	const int target = dialog.getExportTarget();
+	const bool gd3TagEnabled = dialog.enabledGD3();
+	const bool mixEnabled = dialog.isEnabledMix();
+	const double gain = dialog.getGain();
+	BatchExporter exporter(config_);
+	std::atomic_int stepCount(0);
+	io::BinaryContainer container;
+	std::vector<int> mutedTracks = getMutedTracks(*bt_);
+	exporter.addJob(BatchExporter::takeSnapshot(*bt_), songNum,
+					[&](BambooTracker& bt, BatchExporter::ExportCancellCallback checkFunc) {
+		for (int track : mutedTracks) bt.setTrackMuteState(track, true);
+		return bt.exportToVgm(container, target, gd3TagEnabled, tag, mixEnabled, gain,
+							  countSteps(stepCount, checkFunc));
+	});
+
+	int max = static_cast<int>(bt_->getTotalStepCount(songNum, 1)) + 1;
 	QProgressDialog progress(tr("Export to VGM"), tr("Cancel"), 0, max, this);
 	progress.setValue(0);
 	progress.setWindowFlags(progress.windowFlags()
@@ -3682,56 +3801,20 @@ void MainWindow::on_actionVGM_triggered()
 	progress.setWindowModality(Qt::ApplicationModal);
 	progress.open();
 
-	bt_->stopPlaySong();
-    lockWidgets(false);
-
-    try {
-        stream_->stop();
-    }
-    catch (std::exception& e) {
-        showStreamFailedDialog(e.what());
-    }
-
-	try {
-		auto bar = [&progress]() -> bool {
-			QApplication::processEvents();
-			progress.setValue(progress.value() + 1);
-			return progress.wasCanceled();
-		};
-
-		QByteArray bytes;
-		{
-			io::BinaryContainer container;
-			if (!bt_->exportToVgm(container, dialog.getExportTarget(), dialog.enabledGD3(), tag, dialog.isEnabledMix(), dialog.getGain(), bar))
-				goto AFTER_VGM_WRITE;	// Jump if cancelled
-			bytes.reserve(container.size());
-			std::move(container.begin(), container.end(), std::back_inserter(bytes));
-		}
-		QFile fp(path);
-		if (!fp.open(QIODevice::WriteOnly)) {
-			FileIOErrorMessageBox::openError(path, false, io::FileType::VGM, this);
-			goto AFTER_VGM_WRITE;	// Jump if cancelled
-		}
-		fp.write(bytes);
-		fp.close();
-		bar();
-
-		config_.lock()->setWorkingDirectory(QFileInfo(path).dir().path().toStdString());
-	}
-	catch (io::FileIOError& e) {
-		FileIOErrorMessageBox(path, false, e, this).exec();
+	if (!runExportJobs(exporter, progress, stepCount)) {
+		if (!progress.wasCanceled()) FileIOErrorMessageBox(path, false, io::FileType::VGM, "", this).exec();
+		return;
 	}
-	catch (std::exception& e) {
-		FileIOErrorMessageBox(path, false, io::FileType::VGM, QString(e.what()), this).exec();
+
+	QFile fp(path);
+	if (!fp.open(QIODevice::WriteOnly)) {
+		FileIOErrorMessageBox::openError(path, false, io::FileType::VGM, this);
+		return;
 	}
+	fp.write(reinterpret_cast<const char*>(container.data()), static_cast<qint64>(container.size()));
+	fp.close();
 
-AFTER_VGM_WRITE:
-    try {
-        stream_->start();
-    }
-    catch (std::exception& e) {
-        showStreamFailedDialog(e.what());
-    }
+	config_.lock()->setWorkingDirectory(QFileInfo(path).dir().path().toStdString());
 }
 
 void MainWindow::on_actionS98_triggered()
@@ -3752,7 +3835,22 @@ void MainWindow::on_actionS98_triggered()
 	if (path.isNull()) return;
 	if (!path.endsWith(".s98")) path += ".s98";	// For linux
 
-	int max = static_cast<int>(bt_->getTotalStepCount(bt_->getCurrentSongNumber(), 1)) + 3;
+	// Export a snapshot of the module so that the song keeps playing
+	const int songNum = bt_->getCurrentSongNumber();
+	const int target = dialog.getExportTarget();
+	const bool tagEnabled = dialog.enabledTag();
+	const int rate = dialog.getResolution();
+	BatchExporter exporter(config_);
+	std::atomic_int stepCount(0);
+	io::BinaryContainer container;
+	std::vector<int> mutedTracks = getMutedTracks(*bt_);
+	exporter.addJob(BatchExporter::takeSnapshot(*bt_), songNum,
+					[&](BambooTracker& bt, BatchExporter::ExportCancellCallback checkFunc) {
+		for (int track : mutedTracks) bt.setTrackMuteState(track, true);
+		return bt.exportToS98(container, target, tagEnabled, tag, rate, countSteps(stepCount, checkFunc));
+	});
+
+	int max = static_cast<int>(bt_->getTotalStepCount(songNum, 1)) + 1;
 	QProgressDialog progress(tr("Export to S98"), tr("Cancel"), 0, max, this);
 	progress.setValue(0);
 	progress.setWindowFlags(progress.windowFlags()
@@ -3761,58 +3859,20 @@ void MainWindow::on_actionS98_triggered()
 	progress.setWindowModality(Qt::ApplicationModal);
 	progress.open();
 
-	bt_->stopPlaySong();
-	lockWidgets(false);
-
-    try {
-        stream_->stop();
-    }
-    catch (std::exception& e) {
-        showStreamFailedDialog(e.what());
-    }
-
-	try {
-		auto bar = [&progress]() -> bool {
-			QApplication::processEvents();
-			progress.setValue(progress.value() + 1);
-			return progress.wasCanceled();
-		};
-
-		QByteArray bytes;
-		{
-			io::BinaryContainer container;
-			if (!bt_->exportToS98(container, dialog.getExportTarget(), dialog.enabledTag(),
-								  tag, dialog.getResolution(), bar))
-				goto AFTER_S98_WRITE;	// Jump if cancelled
-			bytes.reserve(container.size());
-			std::move(container.begin(), container.end(), std::back_inserter(bytes));
-		}
-
-		QFile fp(path);
-		if (!fp.open(QIODevice::WriteOnly)) {
-			FileIOErrorMessageBox::openError(path, false, io::FileType::S98, this);
-			goto AFTER_S98_WRITE;	// Jump to post process
-		}
-		fp.write(bytes);
-		fp.close();
-		bar();
-
-		config_.lock()->setWorkingDirectory(QFileInfo(path).dir().path().toStdString());
-	}
-	catch (io::FileIOError& e) {
-		FileIOErrorMessageBox(path, false, e, this).exec();
+	if (!runExportJobs(exporter, progress, stepCount)) {
+		if (!progress.wasCanceled()) FileIOErrorMessageBox(path, false, io::FileType::S98, "", this).exec();
+		return;
 	}
-	catch (std::exception& e) {
-		FileIOErrorMessageBox(path, false, io::FileType::S98, QString(e.what()), this).exec();
+
+	QFile fp(path);
+	if (!fp.open(QIODevice::WriteOnly)) {
+		FileIOErrorMessageBox::openError(path, false, io::FileType::S98, this);
+		return;
 	}
+	fp.write(reinterpret_cast<const char*>(container.data()), static_cast<qint64>(container.size()));
+	fp.close();
 
-AFTER_S98_WRITE:
-    try {
-        stream_->start();
-    }
-    catch (std::exception& e) {
-        showStreamFailedDialog(e.what());
-    }
+	config_.lock()->setWorkingDirectory(QFileInfo(path).dir().path().toStdString());
 }
 
 void MainWindow::on_actionMix_triggered()
@@ -3827,13 +3887,16 @@ void MainWindow::on_actionOverwrite_triggered()
 
 void MainWindow::onNewTickSignaledRealChip()
 {
-	onNewTickSignaled(bt_->streamCountUp());
+	int state = bt_->streamCountUp();
+	onNewTickSignaled(state, bt_->getStreamOrderNumber(), bt_->getStreamStepNumber());
 }
 
-void MainWindow::onNewTickSignaled(int state)
+void MainWindow::onNewTickSignaled(int state, int order, int step)
 {
+	bt_->setPlayingPosition(state, order, step);
+
 	if (!state) {	// New step
-		int order = bt_->getPlayingOrderNumber();
+		order = bt_->getPlayingOrderNumber();
 		if (order > -1) {	// Playing
 			if (isVisible() && !isMinimized()) {
 				ui->orderList->updatePositionByOrderUpdate(firstViewUpdateRequest_);
@@ -4139,12 +4202,19 @@ void MainWindow::on_action_Hide_Tracks_triggered()
 
 void MainWindow::on_action_Estimate_Song_Length_triggered()
 {
-	double time = bt_->estimateSongLength(bt_->getCurrentSongNumber());
-	int seconds = static_cast<int>(std::round(time));
+	SongPlaybackTiming timing = bt_->getSongPlaybackTiming(bt_->getCurrentSongNumber(), 1);
+	int seconds = static_cast<int>(std::round(timing.ticksToSecond(timing.totalTicks)));
 	QMessageBox dialog;
 	dialog.setIcon(QMessageBox::Information);
-	dialog.setText(tr("Approximate song length: %1m%2s")
+	dialog.setText(tr("Song length: %1m%2s")
 				   .arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0')));
+	if (timing.hasLoop()) {
+		int loopSeconds = static_cast<int>(std::round(timing.ticksToSecond(timing.totalTicks - timing.introTicks)));
+		dialog.setInformativeText(tr("Loop from order %1, step %2: %3m%4s")
+								  .arg(QString("%1").arg(timing.loopOrder, 2, 16, QChar('0')).toUpper())
+								  .arg(QString("%1").arg(timing.loopStep, 2, 16, QChar('0')).toUpper())
+								  .arg(loopSeconds / 60).arg(loopSeconds % 60, 2, 10, QChar('0')));
+	}
 	dialog.exec();
 }
 
@@ -54,6 +54,7 @@
 #include "bamboo_tracker.hpp"
 #include "precise_timer.hpp"
 #include "audio/audio_stream.hpp"
+#include "audio/quality_governor.hpp"
 #include "gui/instrument_editor/instrument_editor_manager.hpp"
 #include "gui/color_palette.hpp"
 #include "gui/file_history.hpp"
@@ -172,6 +173,19 @@ private:
 	void setMidiConfiguration();
 	void updateFonts();
 
+	// Adaptive quality
+	std::unique_ptr<QTimer> governorTimer_;
+	QualityGovernor governor_;
+	QualityGovernor::Settings governedSettings_;
+	void setQualityGovernor();
+	void updateQualityGovernor();
+
+	// Counts of the audio stream and the real chip timer last shown in the status bar
+	std::unique_ptr<QTimer> playbackStatusTimer_;
+	uint64_t shownUnderrunCount_, shownAvoidedDropoutCount_, shownSkippedTickCount_;
+	void updateAudioStreamStatus();
+	void updateRealChipTimerStatus();
+
 	// History change
 	void changeFileHistory(QString file);
 
@@ -340,7 +354,7 @@ private slots:
 	void on_actionMix_triggered();
 	void on_actionOverwrite_triggered();
 	void onNewTickSignaledRealChip();
-	void onNewTickSignaled(int state);
+	void onNewTickSignaled(int state, int order, int step);
 	void on_actionClear_triggered();
 	void on_keyRepeatCheckBox_stateChanged(int arg1);
 	void updateVisuals();
@@ -2048,7 +2048,7 @@ void InstrumentsManager::storeSampleADPCMRawSample(int sampNum, const std::vecto
 
 void InstrumentsManager::storeSampleADPCMRawSample(int sampNum, std::vector<uint8_t>&& sample)
 {
-	sampADPCM_.at(static_cast<size_t>(sampNum))->storeSample(sample);
+	sampADPCM_.at(static_cast<size_t>(sampNum))->storeSample(std::move(sample));
 }
 
 void InstrumentsManager::clearSampleADPCMRawSample(int sampNum)
@@ -2081,6 +2081,21 @@ size_t InstrumentsManager::getSampleADPCMStopAddress(int sampNum) const
 	return sampADPCM_.at(static_cast<size_t>(sampNum))->getStopAddress();
 }
 
+void InstrumentsManager::setSampleADPCMResident(int sampNum, bool resident)
+{
+	sampADPCM_.at(static_cast<size_t>(sampNum))->setResident(resident);
+}
+
+bool InstrumentsManager::isSampleADPCMResident(int sampNum) const
+{
+	return sampADPCM_.at(static_cast<size_t>(sampNum))->isResident();
+}
+
+void InstrumentsManager::invalidateSampleADPCMResidency()
+{
+	for (auto& samp : sampADPCM_) samp->setResident(false);
+}
+
 std::multiset<int> InstrumentsManager::getSampleADPCMUsers(int sampNum) const
 {
 	return sampADPCM_.at(static_cast<size_t>(sampNum))->getUserInstruments();
@@ -332,6 +332,9 @@ public:
 	size_t getSampleADPCMStartAddress(int sampNum) const;
 	void setSampleADPCMStopAddress(int sampNum, size_t addr);
 	size_t getSampleADPCMStopAddress(int sampNum) const;
+	void setSampleADPCMResident(int sampNum, bool resident);
+	bool isSampleADPCMResident(int sampNum) const;
+	void invalidateSampleADPCMResidency();
 	std::multiset<int> getSampleADPCMUsers(int sampNum) const;
 	std::vector<int> getSampleADPCMEntriedIndices() const;
 	std::vector<int> getSampleADPCMValidIndices() const;
@@ -54,6 +54,7 @@ void SampleADPCM::clearSample()
 {
 	startAddress_ = 0;
 	stopAddress_ = 0;
+	isResident_ = false;
 	sample_ = std::vector<uint8_t>(1);
 	repeatRange_ = SampleRepeatRange(0, (sample_.size() - 1) >> 5);	// By 32 bytes
 }
@@ -93,7 +94,10 @@ bool SampleADPCM::storeSample(const std::vector<uint8_t>& sample)
 	if (sample.empty()) return false;
 
 	repeatRange_ = repeatRange_.clampLast((sample.size() - 1) >> 5);	// By 32 bytes
-	sample_ = sample;
+	if (sample_ != sample) {
+		sample_ = sample;
+		isResident_ = false;
+	}
 
 	return true;
 }
@@ -103,7 +107,10 @@ bool SampleADPCM::storeSample(std::vector<uint8_t>&& sample)
 	if (sample.empty()) return false;
 
 	repeatRange_ = repeatRange_.clampLast((sample.size() - 1) >> 5);	// By 32 bytes
-	sample_ = std::move(sample);
+	if (sample_ != sample) {
+		sample_ = std::move(sample);
+		isResident_ = false;
+	}
 
 	return true;
 }
@@ -72,6 +72,9 @@ public:
 	size_t getStartAddress() const noexcept { return startAddress_; }
 	void setStopAddress(size_t addr) noexcept { stopAddress_ = addr; }
 	size_t getStopAddress() const noexcept { return stopAddress_; }
+	/// Whether the current sample data is stored in the chip memory at the start/stop address
+	void setResident(bool resident) noexcept { isResident_ = resident; }
+	bool isResident() const noexcept { return isResident_; }
 
 	bool isEdited() const override;
 	void clearParameters() override;
@@ -90,4 +93,5 @@ private:
 	SampleRepeatRange repeatRange_;
 	std::vector<uint8_t> sample_;
 	size_t startAddress_, stopAddress_;
+	bool isResident_;
 };
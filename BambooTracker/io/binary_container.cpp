@@ -25,269 +25,166 @@
 
 #include "binary_container.hpp"
 #include <algorithm>
-#include <iterator>
 #include <utility>
-#include <stdexcept>
 
 namespace io
 {
 BinaryContainer::BinaryContainer()
-	: isLE_(true)
+	: view_(nullptr), viewSize_(0), isLE_(true)
 {
 }
 
 BinaryContainer::BinaryContainer(const std::vector<uint8_t>& buf)
-	: isLE_(true)
+	: buf_(buf), view_(nullptr), viewSize_(0), isLE_(true)
 {
-	std::copy(buf.cbegin(), buf.cend(), std::back_inserter(buf_));
 }
 
 BinaryContainer::BinaryContainer(std::vector<uint8_t>&& buf)
-	: isLE_(true)
+	: buf_(std::move(buf)), view_(nullptr), viewSize_(0), isLE_(true)
 {
-	std::move(buf.begin(), buf.end(), std::back_inserter(buf_));
 }
 
-void BinaryContainer::clear()
-{
-	buf_.clear();
-	buf_.shrink_to_fit();
-}
-
-void BinaryContainer::appendInt8(int8_t v)
+BinaryContainer::BinaryContainer(const BinaryContainer& other)
+	: buf_(other.cbegin(), other.cend()), view_(nullptr), viewSize_(0), isLE_(other.isLE_)
 {
-	buf_.push_back(static_cast<uint8_t>(v));
 }
 
-void BinaryContainer::appendUint8(uint8_t v)
+BinaryContainer& BinaryContainer::operator=(const BinaryContainer& other)
 {
-	buf_.push_back(v);
+	if (this != &other) {
+		buf_.assign(other.cbegin(), other.cend());
+		view_ = nullptr;
+		viewSize_ = 0;
+		isLE_ = other.isLE_;
+	}
+	return *this;
 }
 
-void BinaryContainer::appendInt16(int16_t v)
+BinaryContainer::BinaryContainer(BinaryContainer&& other) noexcept
+	: buf_(std::move(other.buf_)),
+	  view_(std::exchange(other.view_, nullptr)),
+	  viewSize_(std::exchange(other.viewSize_, 0)),
+	  isLE_(other.isLE_)
 {
-	append({
-			   static_cast<uint8_t>(0x00ff & v),
-			   static_cast<uint8_t>(v >> 8),
-		   });
 }
 
-void BinaryContainer::appendUint16(uint16_t v)
+BinaryContainer& BinaryContainer::operator=(BinaryContainer&& other) noexcept
 {
-	append({
-			   static_cast<uint8_t>(0x00ff & v),
-			   static_cast<uint8_t>(v >> 8),
-		   });
+	buf_ = std::move(other.buf_);
+	view_ = std::exchange(other.view_, nullptr);
+	viewSize_ = std::exchange(other.viewSize_, 0);
+	isLE_ = other.isLE_;
+	return *this;
 }
 
-void BinaryContainer::appendInt32(int32_t v)
+BinaryContainer BinaryContainer::view(const void* data, size_type size)
 {
-	append({
-			   static_cast<uint8_t>(0x000000ff & v),
-			   static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			   static_cast<uint8_t>(0x00ff & (v >> 16)),
-			   static_cast<uint8_t>(v >> 24),
-		   });
+	BinaryContainer bc;
+	if (size) {
+		bc.view_ = static_cast<const value_type*>(data);
+		bc.viewSize_ = size;
+	}
+	return bc;
 }
 
-void BinaryContainer::appendUint32(uint32_t v)
-{
-	append({
-			   static_cast<uint8_t>(0x000000ff & v),
-			   static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			   static_cast<uint8_t>(0x00ff & (v >> 16)),
-			   static_cast<uint8_t>(v >> 24),
-		   });
-}
-
-void BinaryContainer::appendChar(char c)
+void BinaryContainer::clear()
 {
-	buf_.push_back(static_cast<uint8_t>(c));
+	view_ = nullptr;
+	viewSize_ = 0;
+	buf_.clear();
+	buf_.shrink_to_fit();
 }
 
 void BinaryContainer::appendString(const std::string& str)
 {
-	std::copy(str.cbegin(), str.cend(), std::back_inserter(buf_));
+	detach();
+	buf_.insert(buf_.end(), str.cbegin(), str.cend());
 }
 
 void BinaryContainer::appendArray(const uint8_t* array, size_type size)
 {
-	std::copy(array, array + size, std::back_inserter(buf_));
+	detach();
+	buf_.insert(buf_.end(), array, array + size);
 }
 
 void BinaryContainer::appendVector(const std::vector<uint8_t>& vec)
 {
-	std::copy(vec.cbegin(), vec.cend(), std::back_inserter(buf_));
+	detach();
+	buf_.insert(buf_.end(), vec.cbegin(), vec.cend());
 }
 
 void BinaryContainer::appendVector(std::vector<uint8_t>&& vec)
 {
-	std::move(vec.begin(), vec.end(), std::back_inserter(buf_));
+	detach();
+	if (buf_.empty()) buf_ = std::move(vec);
+	else buf_.insert(buf_.end(), vec.cbegin(), vec.cend());
 }
 
 void BinaryContainer::appendBinaryContainer(const BinaryContainer& bc)
 {
-	std::copy(bc.cbegin(), bc.cend(), std::back_inserter(buf_));
+	appendArray(bc.data(), bc.size());
 }
 
 void BinaryContainer::appendBinaryContainer(BinaryContainer&& bc)
 {
-	std::move(bc.begin(), bc.end(), std::back_inserter(buf_));
+	detach();
+	if (buf_.empty() && !bc.isView()) buf_ = std::move(bc.buf_);
+	else buf_.insert(buf_.end(), bc.cbegin(), bc.cend());
 }
 
 void BinaryContainer::writeInt8(size_type offset, int8_t v)
 {
-	buf_.at(offset) = static_cast<uint8_t>(v);
+	writeUint8(offset, static_cast<uint8_t>(v));
 }
 
 void BinaryContainer::writeUint8(size_type offset, uint8_t v)
 {
+	detach();
 	buf_.at(offset) = v;
 }
 
-void BinaryContainer::writeInt16(size_type offset, int16_t v)
-{
-	write(offset, {
-			  static_cast<uint8_t>(0x00ff & v),
-			  static_cast<uint8_t>(v >> 8),
-		  });
-}
-
-void BinaryContainer::writeUint16(size_type offset, uint16_t v)
-{
-	write(offset, {
-			  static_cast<uint8_t>(0x00ff & v),
-			  static_cast<uint8_t>(v >> 8),
-		  });
-}
-
-void BinaryContainer::writeInt32(size_type offset, int32_t v)
-{
-	write(offset, {
-			  static_cast<uint8_t>(0x000000ff & v),
-			  static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			  static_cast<uint8_t>(0x00ff & (v >> 16)),
-			  static_cast<uint8_t>(v >> 24),
-		  });
-}
-
-void BinaryContainer::writeUint32(size_type offset, uint32_t v)
-{
-	write(offset, {
-			  static_cast<uint8_t>(0x000000ff & v),
-			  static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			  static_cast<uint8_t>(0x00ff & (v >> 16)),
-			  static_cast<uint8_t>(v >> 24),
-		  });
-}
-
 void BinaryContainer::writeChar(size_type offset, char c)
 {
-	buf_.at(offset) = static_cast<uint8_t>(c);
+	writeUint8(offset, static_cast<uint8_t>(c));
 }
 
 void BinaryContainer::writeString(size_type offset, const std::string& str)
 {
-	if (buf_.size() <= offset || buf_.size() < offset + str.length())
+	if (size() <= offset || size() < offset + str.length())
 		throw std::out_of_range("Invalid buffer range in binary container");
 
+	detach();
 	std::copy(str.cbegin(), str.cend(), buf_.begin() + static_cast<int>(offset));
 }
 
-int8_t BinaryContainer::readInt8(size_type offset) const
-{
-	return static_cast<int8_t>(buf_.at(offset));
-}
-
-uint8_t BinaryContainer::readUint8(size_type offset) const
-{
-	return static_cast<uint8_t>(buf_.at(offset));
-}
-
-int16_t BinaryContainer::readInt16(size_type offset) const
-{
-	std::vector<uint8_t> data = read(offset, 2);
-	return static_cast<int16_t>(data[0] | (data[1] << 8));
-}
-
-uint16_t BinaryContainer::readUint16(size_type offset) const
-{
-	std::vector<uint8_t> data = read(offset, 2);
-	return static_cast<uint16_t>(data[0] | (data[1] << 8));
-}
-
-int32_t BinaryContainer::readInt32(size_type offset) const
-{
-	std::vector<uint8_t> data = read(offset, 4);
-	return static_cast<int32_t>(data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24));
-}
-
-uint32_t BinaryContainer::readUint32(size_type offset) const
+std::string BinaryContainer::readString(size_type offset, size_type length) const
 {
-	std::vector<uint8_t> data = read(offset, 4);
-	return static_cast<uint32_t>(data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24));
+	const value_type* p = readSpan(offset, length);
+	return std::string(reinterpret_cast<const char*>(p), length);
 }
 
-char BinaryContainer::readChar(size_type offset) const
+std::vector<uint8_t> BinaryContainer::readVector(size_type offset, size_type length) const
 {
-	return buf_.at(offset);
-}
-
-std::string BinaryContainer::readString(size_type offset, size_type length) const
-{
-	if (buf_.size() <= offset || buf_.size() < offset + length)
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	return std::string(buf_.begin() + static_cast<int>(offset), buf_.begin() + static_cast<int>(offset + length));
+	const value_type* p = readSpan(offset, length);
+	return std::vector<uint8_t>(p, p + length);
 }
 
 BinaryContainer BinaryContainer::getSubcontainer(size_type offset, size_type length) const
 {
-	if (buf_.size() <= offset || buf_.size() < offset + length)
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	BinaryContainer sub;
-	std::copy_n(buf_.begin() + static_cast<int>(offset), length, std::back_inserter(sub));
-	return sub;
+	return BinaryContainer(readVector(offset, length));
 }
 
 std::vector<uint8_t> BinaryContainer::toVector() const
 {
-	std::vector<uint8_t> vec;
-	vec.reserve(buf_.size());
-	std::copy(buf_.cbegin(), buf_.cend(), std::back_inserter(vec));
-	return vec;
-}
-
-void BinaryContainer::append(const std::vector<uint8_t>&& a)
-{
-	if (isLE_)
-		std::copy(a.cbegin(), a.cend(), std::back_inserter(buf_));
-	else
-		std::reverse_copy(a.cbegin(), a.cend(), std::back_inserter(buf_));
+	return std::vector<uint8_t>(cbegin(), cend());
 }
 
-void BinaryContainer::write(size_t offset, const std::vector<uint8_t>&& a)
+void BinaryContainer::detach()
 {
-	if (buf_.size() <= offset || buf_.size() < offset + a.size())
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	if (isLE_)
-		std::copy(a.cbegin(), a.cend(), buf_.begin() + static_cast<int>(offset));
-	else
-		std::reverse_copy(a.cbegin(), a.cend(), buf_.begin() + static_cast<int>(offset));
-}
-
-std::vector<uint8_t> BinaryContainer::read(size_type offset, size_type size) const
-{
-	if (buf_.size() <= offset || buf_.size() < offset + size)
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	std::vector<uint8_t> data;
-	if (isLE_)
-		std::copy(buf_.cbegin() + static_cast<int>(offset), buf_.cbegin() + static_cast<int>(offset + size), std::back_inserter(data));
-	else
-		std::reverse_copy(buf_.cbegin() + static_cast<int>(offset), buf_.cbegin() + static_cast<int>(offset + size), std::back_inserter(data));
-	return data;
+	if (view_) {
+		buf_.assign(view_, view_ + viewSize_);
+		view_ = nullptr;
+		viewSize_ = 0;
+	}
 }
 }
@@ -25,62 +25,87 @@
 
 #pragma once
 
-#include <deque>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 #include <string>
+#include <iterator>
+#include <stdexcept>
 
 namespace io
 {
+/**
+ * @brief Contiguous byte buffer with typed reads and writes.
+ *
+ * The container owns its bytes by default. A container created by @c view()
+ * refers to external read-only memory instead of copying it. Any modification
+ * of a view copies the bytes into its own storage first, and a copied view
+ * owns its bytes so that it can outlive the external memory.
+ */
 class BinaryContainer
 {
 public:
-	using container_type = std::deque<uint8_t>;
+	using container_type = std::vector<uint8_t>;
 	using value_type = container_type::value_type;
 	using size_type = container_type::size_type;
-	using iterator = container_type::iterator;
-	using const_iterator = container_type::const_iterator;
-	using reverse_iterator = container_type::reverse_iterator;
-	using const_reverse_iterator = container_type::const_reverse_iterator;
+	using iterator = value_type*;
+	using const_iterator = const value_type*;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 	explicit BinaryContainer();
 	explicit BinaryContainer(const std::vector<uint8_t>& buf);
 	explicit BinaryContainer(std::vector<uint8_t>&& buf);
+	BinaryContainer(const BinaryContainer& other);
+	BinaryContainer& operator=(const BinaryContainer& other);
+	BinaryContainer(BinaryContainer&& other) noexcept;
+	BinaryContainer& operator=(BinaryContainer&& other) noexcept;
+
+	/**
+	 * @brief Create a read-only view of external memory without copying it.
+	 * @param data Pointer to the memory which must outlive the view.
+	 * @param size Size of the memory in bytes.
+	 */
+	static BinaryContainer view(const void* data, size_type size);
+	inline bool isView() const noexcept { return view_ != nullptr; }
 
-	inline iterator begin() noexcept { return buf_.begin(); }
-	inline const_iterator begin() const noexcept { return buf_.begin(); }
+	inline iterator begin() { detach(); return buf_.data(); }
+	inline const_iterator begin() const noexcept { return data(); }
 
-	inline iterator end() noexcept { return buf_.end(); }
-	inline const_iterator end() const noexcept { return buf_.end(); }
+	inline iterator end() { detach(); return buf_.data() + buf_.size(); }
+	inline const_iterator end() const noexcept { return data() + size(); }
 
-	inline const_iterator cbegin() const noexcept { return buf_.cbegin(); }
-	inline const_iterator cend() const noexcept { return buf_.cend(); }
+	inline const_iterator cbegin() const noexcept { return data(); }
+	inline const_iterator cend() const noexcept { return data() + size(); }
 
-	inline reverse_iterator rbegin() noexcept { return buf_.rbegin(); }
-	inline const_reverse_iterator rbegin() const noexcept { return buf_.rbegin(); }
+	inline reverse_iterator rbegin() { return reverse_iterator(end()); }
+	inline const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(cend()); }
 
-	inline reverse_iterator rend() noexcept { return buf_.rend(); }
-	inline const_reverse_iterator rend() const noexcept { return buf_.rend(); }
+	inline reverse_iterator rend() { return reverse_iterator(begin()); }
+	inline const_reverse_iterator rend() const noexcept { return const_reverse_iterator(cbegin()); }
 
-	inline const_reverse_iterator crbegin() const noexcept { return buf_.crbegin(); }
-	inline const_reverse_iterator crend() const noexcept { return buf_.crend(); }
+	inline const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+	inline const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+	inline const value_type* data() const noexcept { return view_ ? view_ : buf_.data(); }
 
 	inline void push_back(uint8_t v) { appendUint8(v); }
 
-	inline size_type size() const noexcept { return buf_.size(); }
+	inline size_type size() const noexcept { return view_ ? viewSize_ : buf_.size(); }
 	void clear();
-	inline void resize(size_type size) { buf_.resize(size); }
+	inline void resize(size_type size) { detach(); buf_.resize(size); }
+	inline void reserve(size_type size) { detach(); buf_.reserve(size); }
 
 	inline void setEndian(bool isLittleEndian) noexcept { isLE_ = isLittleEndian; }
 	inline bool isLittleEndian() const noexcept { return isLE_; }
 
-	void appendInt8(int8_t v);
-	void appendUint8(uint8_t v);
-	void appendInt16(int16_t v);
-	void appendUint16(uint16_t v);
-	void appendInt32(int32_t v);
-	void appendUint32(uint32_t v);
-	void appendChar(char c);
+	inline void appendInt8(int8_t v) { appendUint8(static_cast<uint8_t>(v)); }
+	inline void appendUint8(uint8_t v) { detach(); buf_.push_back(v); }
+	inline void appendInt16(int16_t v) { appendUint16(static_cast<uint16_t>(v)); }
+	inline void appendUint16(uint16_t v) { append<2>(v); }
+	inline void appendInt32(int32_t v) { appendUint32(static_cast<uint32_t>(v)); }
+	inline void appendUint32(uint32_t v) { append<4>(v); }
+	inline void appendChar(char c) { appendUint8(static_cast<uint8_t>(c)); }
 	void appendString(const std::string& str);
 	void appendArray(const uint8_t* array, size_type size);
 	void appendVector(const std::vector<uint8_t>& vec);
@@ -90,32 +115,74 @@ public:
 
 	void writeInt8(size_type offset, int8_t v);
 	void writeUint8(size_type offset, uint8_t v);
-	void writeInt16(size_type offset, int16_t v);
-	void writeUint16(size_type offset, uint16_t v);
-	void writeInt32(size_type offset, int32_t v);
-	void writeUint32(size_type offset, uint32_t v);
+	inline void writeInt16(size_type offset, int16_t v) { writeUint16(offset, static_cast<uint16_t>(v)); }
+	inline void writeUint16(size_type offset, uint16_t v) { write<2>(offset, v); }
+	inline void writeInt32(size_type offset, int32_t v) { writeUint32(offset, static_cast<uint32_t>(v)); }
+	inline void writeUint32(size_type offset, uint32_t v) { write<4>(offset, v); }
 	void writeChar(size_type offset, char c);
 	void writeString(size_type offset, const std::string& str);
 
-	int8_t readInt8(size_type offset) const;
-	uint8_t readUint8(size_type offset) const;
-	int16_t readInt16(size_type offset) const;
-	uint16_t readUint16(size_type offset) const;
-	int32_t readInt32(size_type offset) const;
-	uint32_t readUint32(size_type offset) const;
-	char readChar(size_type offset) const;
+	inline int8_t readInt8(size_type offset) const { return static_cast<int8_t>(readUint8(offset)); }
+	inline uint8_t readUint8(size_type offset) const { return *readSpan(offset, 1); }
+	inline int16_t readInt16(size_type offset) const { return static_cast<int16_t>(readUint16(offset)); }
+	inline uint16_t readUint16(size_type offset) const { return static_cast<uint16_t>(read<2>(offset)); }
+	inline int32_t readInt32(size_type offset) const { return static_cast<int32_t>(readUint32(offset)); }
+	inline uint32_t readUint32(size_type offset) const { return read<4>(offset); }
+	inline char readChar(size_type offset) const { return static_cast<char>(readUint8(offset)); }
 	std::string readString(size_type offset, size_type length) const;
 
+	/**
+	 * @brief Get a pointer to the range of bytes without copying them.
+	 * @throw std::out_of_range if the range exceeds the buffer.
+	 * @return Pointer which is valid until the container is modified.
+	 */
+	inline const value_type* readSpan(size_type offset, size_type length) const
+	{
+		if (size() < offset + length || (!length && size() <= offset))
+			throw std::out_of_range("Invalid buffer range in binary container");
+		return data() + offset;
+	}
+	std::vector<uint8_t> readVector(size_type offset, size_type length) const;
+
 	BinaryContainer getSubcontainer(size_type offset, size_type length) const;
 
 	std::vector<uint8_t> toVector() const;
 
 private:
 	container_type buf_;
+	const value_type* view_;
+	size_type viewSize_;
 	bool isLE_;
 
-	void append(const std::vector<uint8_t>&& a);
-	void write(size_t offset, const std::vector<uint8_t>&& a);
-	std::vector<uint8_t> read(size_type offset, size_type size) const;
+	void detach();
+
+	template <size_type N>
+	void append(uint32_t v)
+	{
+		uint8_t a[N];
+		for (size_type i = 0; i < N; ++i) a[isLE_ ? i : (N - 1 - i)] = static_cast<uint8_t>(v >> (8 * i));
+		detach();
+		buf_.insert(buf_.end(), a, a + N);
+	}
+
+	template <size_type N>
+	void write(size_type offset, uint32_t v)
+	{
+		if (size() <= offset || size() < offset + N)
+			throw std::out_of_range("Invalid buffer range in binary container");
+		detach();
+		for (size_type i = 0; i < N; ++i)
+			buf_[offset + (isLE_ ? i : (N - 1 - i))] = static_cast<uint8_t>(v >> (8 * i));
+	}
+
+	template <size_type N>
+	uint32_t read(size_type offset) const
+	{
+		const value_type* p = readSpan(offset, N);
+		uint32_t v = 0;
+		for (size_type i = 0; i < N; ++i)
+			v |= static_cast<uint32_t>(p[isLE_ ? i : (N - 1 - i)]) << (8 * i);
+		return v;
+	}
 };
 }
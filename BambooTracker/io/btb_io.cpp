@@ -1888,9 +1888,8 @@ AbstractInstrument* BtbIO::loadInstrument(const BinaryContainer& instCtr,
 				instManLocked->setSampleADPCMRepeatEnabled(sampNum, (propCtr.readUint8(sampCsr++) & 0x01) != 0);
 				uint32_t len = propCtr.readUint32(sampCsr);
 				sampCsr += 4;
-				std::vector<uint8_t> samples = propCtr.getSubcontainer(sampCsr, len).toVector();
+				instManLocked->storeSampleADPCMRawSample(sampNum, propCtr.readVector(sampCsr, len));
 				sampCsr += len;
-				instManLocked->storeSampleADPCMRawSample(sampNum, samples);
 				if (bankVersion >= Version::toBCD(1, 3, 1)) {
 					uint16_t repeatBegin = propCtr.readUint16(sampCsr);
 					sampCsr += 2;
@@ -1899,7 +1898,7 @@ AbstractInstrument* BtbIO::loadInstrument(const BinaryContainer& instCtr,
 					instManLocked->setSampleADPCMRepeatrange(sampNum, SampleRepeatRange(repeatBegin, repeatEnd));
 				}
 				else {
-					instManLocked->setSampleADPCMRepeatrange(sampNum, SampleRepeatRange(0, (samples.size() - 1) >> 5));
+					instManLocked->setSampleADPCMRepeatrange(sampNum, SampleRepeatRange(0, (len - 1) >> 5));
 				}
 			}
 		}
@@ -2226,9 +2225,8 @@ AbstractInstrument* BtbIO::loadInstrument(const BinaryContainer& instCtr,
 						instManLocked->setSampleADPCMRepeatEnabled(newSamp, (propCtr.readUint8(sampCsr++) & 0x01) != 0);
 						uint32_t len = propCtr.readUint32(sampCsr);
 						sampCsr += 4;
-						std::vector<uint8_t> samples = propCtr.getSubcontainer(sampCsr, len).toVector();
+						instManLocked->storeSampleADPCMRawSample(newSamp, propCtr.readVector(sampCsr, len));
 						sampCsr += len;
-						instManLocked->storeSampleADPCMRawSample(newSamp, samples);
 						if (bankVersion >= Version::toBCD(1, 3, 1)) {
 							uint16_t repeatBegin = propCtr.readUint16(sampCsr);
 							sampCsr += 2;
@@ -2237,7 +2235,7 @@ AbstractInstrument* BtbIO::loadInstrument(const BinaryContainer& instCtr,
 							instManLocked->setSampleADPCMRepeatrange(newSamp, SampleRepeatRange(repeatBegin, repeatEnd));
 						}
 						else {
-							instManLocked->setSampleADPCMRepeatrange(newSamp, SampleRepeatRange(0, (samples.size() - 1) >> 5));
+							instManLocked->setSampleADPCMRepeatrange(newSamp, SampleRepeatRange(0, (len - 1) >> 5));
 						}
 						++newSamp;	// Increment for search
 					}
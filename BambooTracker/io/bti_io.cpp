@@ -1568,9 +1568,8 @@ AbstractInstrument* BtiIO::load(const BinaryContainer& ctr, const std::string& f
 					instManLocked->setSampleADPCMRepeatEnabled(idx, (ctr.readUint8(csr++) & 0x01) != 0);
 					uint32_t len = ctr.readUint32(csr);
 					csr += 4;
-					std::vector<uint8_t> samples = ctr.getSubcontainer(csr, len).toVector();
+					instManLocked->storeSampleADPCMRawSample(idx, ctr.readVector(csr, len));
 					 csr += len;
-					instManLocked->storeSampleADPCMRawSample(idx, samples);
 					if (fileVersion >= Version::toBCD(1, 5, 1)) {
 						uint16_t repeatBegin = ctr.readUint16(csr);
 						csr += 2;
@@ -1579,7 +1578,7 @@ AbstractInstrument* BtiIO::load(const BinaryContainer& ctr, const std::string& f
 						instManLocked->setSampleADPCMRepeatrange(idx, SampleRepeatRange(repeatBegin, repeatEnd));
 					}
 					else {
-						instManLocked->setSampleADPCMRepeatrange(idx, SampleRepeatRange(0, (samples.size() - 1) >> 5));
+						instManLocked->setSampleADPCMRepeatrange(idx, SampleRepeatRange(0, (len - 1) >> 5));
 					}
 
 					instPropCsr += ofs;
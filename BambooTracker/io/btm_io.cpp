@@ -1281,9 +1281,8 @@ size_t loadInstrumentPropertySection(std::weak_ptr<InstrumentsManager> instMan,
 				instManLocked->setSampleADPCMRepeatEnabled(idx, (ctr.readUint8(csr++) & 0x01) != 0);
 				uint32_t len = ctr.readUint32(csr);
 				csr += 4;
-				std::vector<uint8_t> samples = ctr.getSubcontainer(csr, len).toVector();
+				instManLocked->storeSampleADPCMRawSample(idx, ctr.readVector(csr, len));
 				 csr += len;
-				instManLocked->storeSampleADPCMRawSample(idx, samples);
 				if (version >= Version::toBCD(1, 6, 1)) {
 					uint16_t repeatBegin = ctr.readUint16(csr);
 					csr += 2;
@@ -1292,7 +1291,7 @@ size_t loadInstrumentPropertySection(std::weak_ptr<InstrumentsManager> instMan,
 					instManLocked->setSampleADPCMRepeatrange(idx, SampleRepeatRange(repeatBegin, repeatEnd));
 				}
 				else {
-					instManLocked->setSampleADPCMRepeatrange(idx, SampleRepeatRange(0, (samples.size() - 1) >> 5));
+					instManLocked->setSampleADPCMRepeatrange(idx, SampleRepeatRange(0, (len - 1) >> 5));
 				}
 
 				instPropCsr += ofs;
@@ -25,13 +25,18 @@
 
 #include "export_io.hpp"
 #include "binary_container.hpp"
+#include "export_sink.hpp"
 #include "io_file_type.hpp"
 #include "file_io_error.hpp"
 
 namespace io
 {
-void writeVgm(BinaryContainer& container, int target, const std::vector<uint8_t>& samples,
-			  uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
+size_t getVgmHeaderSize(bool hasMix)
+{
+	return 0x100 + (hasMix ? 17 : 0);
+}
+
+void writeVgm(ExportSink& sink, int target, uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
 			  uint32_t loopSamples, uint32_t totalSamples, const GD3Tag* tag, const VgmMix* mix)
 {
 	uint32_t tagLen = 0;
@@ -45,18 +50,20 @@ void writeVgm(BinaryContainer& container, int target, const std::vector<uint8_t>
 		tagLen = 12 + tagDataLen;
 	}
 	uint32_t extraLen = mix ? 17 : 0;
+	size_t commandsSize = sink.size() - getVgmHeaderSize(mix);
+	BinaryContainer container;
 
 	// Header
 	// 0x00: "Vgm " ident
 	uint8_t header[0x100] = {'V', 'g', 'm', ' '};
 	// 0x04: EOF offset
-	uint32_t offset = 0x100+ extraLen + samples.size() + 1 + tagLen - 4;
+	uint32_t offset = 0x100+ extraLen + commandsSize + 1 + tagLen - 4;
 	*reinterpret_cast<uint32_t*>(header + 0x04) = offset;
 	// 0x08: Version [v1.71]
 	uint32_t version = 0x171;
 	*reinterpret_cast<uint32_t*>(header + 0x08) = version;
 	// 0x14: GD3 offset
-	uint32_t gd3Offset = tag ? (0x100 + extraLen + samples.size() + 1 - 0x14) : 0;
+	uint32_t gd3Offset = tag ? (0x100 + extraLen + commandsSize + 1 - 0x14) : 0;
 	*reinterpret_cast<uint32_t*>(header + 0x14) = gd3Offset;
 	// 0x18: Total # samples
 	*reinterpret_cast<uint32_t*>(header + 0x18) = totalSamples;
@@ -131,8 +138,10 @@ void writeVgm(BinaryContainer& container, int target, const std::vector<uint8_t>
 		container.appendUint16(mix->ssgMultiplier);
 	}
 
-	// Commands
-	container.appendVector(samples);
+	sink.patch(0, container.data(), container.size());
+
+	// Commands are already in the sink
+	container.clear();
 	container.appendUint8(0x66);	// End
 
 	// GD3 tag
@@ -167,12 +176,16 @@ void writeVgm(BinaryContainer& container, int target, const std::vector<uint8_t>
 		// Notes
 		container.appendString(tag->notes);
 	}
+
+	sink.append(container.data(), container.size());
 }
 
-void writeS98(BinaryContainer& container, int target, const std::vector<uint8_t>& samples,
-			  uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
+void writeS98(ExportSink& sink, int target, uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
 			  bool tagEnabled, const S98Tag& tag)
 {
+	size_t commandsSize = sink.size() - S98_HEADER_SIZE;
+	BinaryContainer container;
+
 	// Header
 	// 0x00: Magic "S98"
 	container.appendString("S98");
@@ -188,7 +201,7 @@ void writeS98(BinaryContainer& container, int target, const std::vector<uint8_t>
 	uint32_t zero = 0;
 	container.appendUint32(zero);
 	// 0x10: Tag offset
-	uint32_t tagOffset = tagEnabled ? (0x80 + samples.size() + 1) : 0;
+	uint32_t tagOffset = tagEnabled ? (0x80 + commandsSize + 1) : 0;
 	container.appendUint32(tagOffset);
 	// 0x14: Dump data offset
 	uint32_t dumpOffset = 0x80;
@@ -262,8 +275,10 @@ void writeS98(BinaryContainer& container, int target, const std::vector<uint8_t>
 	for (uint32_t i = 0; i < (24 - 4 * deviceCnt); ++i)
 		container.appendUint32(zero);
 
-	// Commands
-	container.appendVector(samples);
+	sink.patch(0, container.data(), container.size());
+
+	// Commands are already in the sink
+	container.clear();
 	container.appendUint8(0xfd);	// End
 
 	// GD3 tag
@@ -307,5 +322,7 @@ void writeS98(BinaryContainer& container, int target, const std::vector<uint8_t>
 		uint8_t end = 0;
 		container.appendUint8(end);
 	}
+
+	sink.append(container.data(), container.size());
 }
 }
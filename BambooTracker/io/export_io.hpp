@@ -29,10 +29,11 @@
 #include <string>
 #include <cmath>
 #include <cstdint>
+#include <cstddef>
 
 namespace io
 {
-class BinaryContainer;
+class ExportSink;
 
 // VGM ----------
 struct GD3Tag
@@ -57,8 +58,14 @@ struct VgmMix
 		: ssgMultiplier(static_cast<uint16_t>(std::pow(10.0, (ssgLevel + gain - fmLevel) / 20.0) * 0x100) | 0x8000) {}
 };
 
-void writeVgm(BinaryContainer& container, int target, const std::vector<uint8_t>& samples,
-			  uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
+/// Size of the header reserved at the beginning of the sink before commands.
+size_t getVgmHeaderSize(bool hasMix);
+
+/**
+ * @brief Finish VGM whose commands follow the reserved header in the sink.
+ * @param loopPoint Offset of the loop point from the first command.
+ */
+void writeVgm(ExportSink& sink, int target, uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
 			  uint32_t loopSamples, uint32_t totalSamples, const GD3Tag* tag, const VgmMix* mix);
 
 // S98 ----------
@@ -75,8 +82,14 @@ struct S98Tag
 	std::string system;
 };
 
-void writeS98(BinaryContainer& container, int target, const std::vector<uint8_t>& samples,
-			  uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
+/// Size of the header reserved at the beginning of the sink before commands.
+constexpr size_t S98_HEADER_SIZE = 0x80;
+
+/**
+ * @brief Finish S98 whose commands follow the reserved header in the sink.
+ * @param loopPoint Offset of the loop point from the first command.
+ */
+void writeS98(ExportSink& sink, int target, uint32_t clock, uint32_t rate, bool loopFlag, uint32_t loopPoint,
 			  bool tagEnabled, const S98Tag& tag);
 
 enum ExportTargetFlag
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "export_sink.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "binary_container.hpp"
+
+namespace io
+{
+void ExportSink::appendZeros(size_t size)
+{
+	static const uint8_t ZEROS[0x100] = {};
+	while (size) {
+		size_t n = std::min(size, sizeof(ZEROS));
+		append(ZEROS, n);
+		size -= n;
+	}
+}
+
+//******************************//
+void MemoryExportSink::append(const uint8_t* data, size_t size)
+{
+	size_ += size;
+	while (size) {
+		if (chunks_.empty() || chunks_.back().size() == CHUNK_SIZE) {
+			chunks_.emplace_back();
+			chunks_.back().reserve(CHUNK_SIZE);
+		}
+		std::vector<uint8_t>& chunk = chunks_.back();
+		size_t n = std::min(size, CHUNK_SIZE - chunk.size());
+		chunk.insert(chunk.end(), data, data + n);
+		data += n;
+		size -= n;
+	}
+}
+
+void MemoryExportSink::patch(size_t offset, const uint8_t* data, size_t size)
+{
+	while (size) {
+		std::vector<uint8_t>& chunk = chunks_.at(offset / CHUNK_SIZE);
+		size_t pos = offset % CHUNK_SIZE;
+		if (chunk.size() <= pos) throw std::out_of_range("Invalid patch range in export sink");
+		size_t n = std::min(size, chunk.size() - pos);
+		std::copy(data, data + n, chunk.begin() + static_cast<std::ptrdiff_t>(pos));
+		offset += n;
+		data += n;
+		size -= n;
+	}
+}
+
+void MemoryExportSink::copyTo(BinaryContainer& container) const
+{
+	container.reserve(container.size() + size_);
+	for (const auto& chunk : chunks_) container.appendArray(chunk.data(), chunk.size());
+}
+
+//******************************//
+FileExportSink::FileExportSink(const std::string& path)
+	: ofs_(path, std::ios::binary)
+{
+}
+
+void FileExportSink::append(const uint8_t* data, size_t size)
+{
+	ofs_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	size_ += size;
+}
+
+void FileExportSink::patch(size_t offset, const uint8_t* data, size_t size)
+{
+	ofs_.seekp(static_cast<std::streamoff>(offset));
+	ofs_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	ofs_.seekp(0, std::ios::end);
+}
+
+bool FileExportSink::close()
+{
+	ofs_.close();
+	return !ofs_.fail();
+}
+}
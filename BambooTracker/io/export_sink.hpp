@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <fstream>
+
+namespace io
+{
+class BinaryContainer;
+
+/**
+ * @brief Append-only destination of exported data.
+ *
+ * The header is reserved at first and patched after all commands are appended,
+ * so the data never has to be kept or copied as a whole.
+ */
+class ExportSink
+{
+public:
+	virtual ~ExportSink() = default;
+	virtual void append(const uint8_t* data, size_t size) = 0;
+	inline void appendUint8(uint8_t v) { append(&v, 1); }
+	void appendZeros(size_t size);
+	/// Overwrite already appended data.
+	virtual void patch(size_t offset, const uint8_t* data, size_t size) = 0;
+	inline size_t size() const noexcept { return size_; }
+
+protected:
+	size_t size_ = 0;
+};
+
+/// Keeps data in fixed-size chunks, so appending never moves previous data.
+class MemoryExportSink final : public ExportSink
+{
+public:
+	void append(const uint8_t* data, size_t size) override;
+	void patch(size_t offset, const uint8_t* data, size_t size) override;
+	void copyTo(BinaryContainer& container) const;
+
+	static constexpr size_t CHUNK_SIZE = 0x10000;
+
+private:
+	std::vector<std::vector<uint8_t>> chunks_;
+};
+
+/// Writes data to a file directly.
+class FileExportSink final : public ExportSink
+{
+public:
+	explicit FileExportSink(const std::string& path);
+	void append(const uint8_t* data, size_t size) override;
+	void patch(size_t offset, const uint8_t* data, size_t size) override;
+	/// Return false if any write has failed.
+	bool good() const { return static_cast<bool>(ofs_); }
+	bool close();
+
+private:
+	std::ofstream ofs_;
+};
+}
@@ -62,7 +62,7 @@ AbstractBank* PmbIO::load(const BinaryContainer& ctr) const
 		ids.push_back(i);
 		names.push_back(name);
 
-		std::vector<uint8_t>&& smp = ctr.getSubcontainer(globCsr, len).toVector();
+		std::vector<uint8_t>&& smp = ctr.readVector(globCsr, len);
 
 		std::vector<int16_t> buf(smp.size());
 		std::transform(smp.begin(), smp.end(), buf.begin(), [globCsr](uint8_t v) {
@@ -51,7 +51,7 @@ AbstractBank* PpsIO::load(const BinaryContainer& ctr) const
 		if (len) {
 			ids.push_back(i);
 
-			std::vector<uint8_t>&& smp = ctr.getSubcontainer(start, len).toVector();
+			std::vector<uint8_t>&& smp = ctr.readVector(start, len);
 			std::vector<int16_t> buf(smp.size() * 2);
 			for (size_t i = 0; i < smp.size(); ++i) {
 				uint8_t sample = smp[i];
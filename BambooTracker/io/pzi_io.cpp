@@ -69,7 +69,7 @@ AbstractBank* PziIO::load(const BinaryContainer& ctr) const
 			isRepeatedList.push_back(isRepeated);
 			deltaNs.push_back(SampleADPCM::calculateADPCMDeltaN(sr));
 
-			std::vector<uint8_t>&& smp = ctr.getSubcontainer(SAMP_OFFS + start, len).toVector();
+			std::vector<uint8_t>&& smp = ctr.readVector(SAMP_OFFS + start, len);
 			std::vector<int16_t> buf(smp.size());
 			std::transform(smp.begin(), smp.end(), buf.begin(), [](uint8_t v) {
 				// Centering
@@ -138,7 +138,7 @@ WavContainer::WavContainer(const BinaryContainer& bc)
 			assertValue(p + dataSize <= bc.size(), p);
 			buf_.writeUint32(DATA_SIZE_OFFS, dataSize);
 			p += 4;
-			buf_.appendBinaryContainer(bc.getSubcontainer(p, dataSize));
+			buf_.appendArray(bc.readSpan(p, dataSize), dataSize);
 			p += dataSize;
 		}
 		else {
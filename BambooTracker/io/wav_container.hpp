@@ -44,24 +44,25 @@ public:
 	explicit WavContainer(uint32_t rate = 44100, uint16_t nCh = 2, uint16_t getBitSize = 16);
 	explicit WavContainer(const BinaryContainer& bc);
 
-	inline iterator begin() noexcept { return buf_.begin(); }
+	inline iterator begin() { return buf_.begin(); }
 	inline const_iterator begin() const noexcept { return buf_.begin(); }
 
-	inline iterator end() noexcept { return buf_.end(); }
+	inline iterator end() { return buf_.end(); }
 	inline const_iterator end() const noexcept { return buf_.end(); }
 
 	inline const_iterator cbegin() const noexcept { return buf_.cbegin(); }
 	inline const_iterator cend() const noexcept { return buf_.cend(); }
 
-	inline reverse_iterator rbegin() noexcept { return buf_.rbegin(); }
+	inline reverse_iterator rbegin() { return buf_.rbegin(); }
 	inline const_reverse_iterator rbegin() const noexcept { return buf_.rbegin(); }
 
-	inline reverse_iterator rend() noexcept { return buf_.rend(); }
+	inline reverse_iterator rend() { return buf_.rend(); }
 	inline const_reverse_iterator rend() const noexcept { return buf_.rend(); }
 
 	inline const_reverse_iterator crbegin() const noexcept { return buf_.crbegin(); }
 	inline const_reverse_iterator crend() const noexcept { return buf_.crend(); }
 
+	inline const value_type* data() const noexcept { return buf_.data(); }
 	inline size_type size() const { return buf_.size(); }
 
 	void setChannelCount(uint16_t n);
@@ -3543,9 +3543,14 @@ Please change the settings in the configuration.</source>
         <translation>¿Quiere intercambiar pistas?</translation>
     </message>
     <message>
-        <location filename="../gui/mainwindow.cpp" line="4158"/>
-        <source>Approximate song length: %1m%2s</source>
-        <translation>Duración de canción aproximada: %1m%2s</translation>
+        <location filename="../gui/mainwindow.cpp" line="4209"/>
+        <source>Song length: %1m%2s</source>
+        <translation type="unfinished">Duración de canción: %1m%2s</translation>
+    </message>
+    <message>
+        <location filename="../gui/mainwindow.cpp" line="4213"/>
+        <source>Loop from order %1, step %2: %3m%4s</source>
+        <translation type="unfinished">Bucle desde orden %1, paso %2: %3m%4s</translation>
     </message>
     <message>
         <location filename="../gui/mainwindow.hpp" line="239"/>
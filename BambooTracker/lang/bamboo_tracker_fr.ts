@@ -3801,8 +3801,13 @@
         <translation type="unfinished"></translation>
     </message>
     <message>
-        <location filename="../gui/mainwindow.cpp" line="3969"/>
-        <source>Approximate song length: %1m%2s</source>
+        <location filename="../gui/mainwindow.cpp" line="4209"/>
+        <source>Song length: %1m%2s</source>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <location filename="../gui/mainwindow.cpp" line="4213"/>
+        <source>Loop from order %1, step %2: %3m%4s</source>
         <translation type="unfinished"></translation>
     </message>
     <message>
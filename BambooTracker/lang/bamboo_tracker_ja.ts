@@ -3302,9 +3302,14 @@
         <translation>トラックを入れ替えますか?</translation>
     </message>
     <message>
-        <location filename="../gui/mainwindow.cpp" line="3987"/>
-        <source>Approximate song length: %1m%2s</source>
-        <translation>ソングの長さ: %1分%2秒</translation>
+        <location filename="../gui/mainwindow.cpp" line="4209"/>
+        <source>Song length: %1m%2s</source>
+        <translation type="unfinished">ソングの長さ: %1分%2秒</translation>
+    </message>
+    <message>
+        <location filename="../gui/mainwindow.cpp" line="4213"/>
+        <source>Loop from order %1, step %2: %3m%4s</source>
+        <translation type="unfinished">ループ: オーダー %1, ステップ %2 から %3分%4秒</translation>
     </message>
     <message>
         <location filename="../gui/mainwindow.cpp" line="2607"/>
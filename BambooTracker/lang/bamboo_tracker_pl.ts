@@ -3666,9 +3666,18 @@
         <translation>Czy chcesz zamienić kanały?</translation>
     </message>
     <message>
-        <location filename="../gui/mainwindow.cpp" line="3969"/>
+        <location filename="../gui/mainwindow.cpp" line="4209"/>
+        <source>Song length: %1m%2s</source>
+        <translation type="unfinished">Długość piosenki: %1m%2s</translation>
+    </message>
+    <message>
+        <location filename="../gui/mainwindow.cpp" line="4213"/>
+        <source>Loop from order %1, step %2: %3m%4s</source>
+        <translation type="unfinished">Pętla od kolejności %1, kroku %2: %3m%4s</translation>
+    </message>
+    <message>
         <source>Approximate song length: %1m%2s</source>
-        <translation>Przybliżona długość piosenki: %1m%2s</translation>
+        <translation type="vanished">Przybliżona długość piosenki: %1m%2s</translation>
     </message>
     <message>
         <location filename="../gui/mainwindow.cpp" line="2585"/>
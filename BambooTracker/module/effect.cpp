@@ -24,321 +24,172 @@
  */
 
 #include "effect.hpp"
-#include <unordered_map>
 #include "step.hpp"
 
 namespace
 {
-const std::unordered_map<char, int> CTOHEX = {
-	{ '0', 0 },
-	{ '1', 1 },
-	{ '2', 2 },
-	{ '3', 3 },
-	{ '4', 4 },
-	{ '5', 5 },
-	{ '6', 6 },
-	{ '7', 7 },
-	{ '8', 8 },
-	{ '9', 9 },
-	{ 'A', 10 },
-	{ 'B', 11 },
-	{ 'C', 12 },
-	{ 'D', 13 },
-	{ 'E', 14 },
-	{ 'F', 15 }
-};
+inline int ctohex(char c) noexcept
+{
+	if ('0' <= c && c <= '9') return c - '0';
+	if ('A' <= c && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+inline EffectType filterSource(SoundSource src, EffectType type, bool fm, bool ssg, bool rhythm, bool adpcm) noexcept
+{
+	switch (src) {
+	case SoundSource::FM:		return fm ? type : EffectType::NoEffect;
+	case SoundSource::SSG:		return ssg ? type : EffectType::NoEffect;
+	case SoundSource::RHYTHM:	return rhythm ? type : EffectType::NoEffect;
+	case SoundSource::ADPCM:	return adpcm ? type : EffectType::NoEffect;
+	default:					return EffectType::NoEffect;
+	}
+}
+
+// Effects for the tone channels (FM, SSG and ADPCM)
+inline EffectType filterToneSource(SoundSource src, EffectType type) noexcept
+{
+	return filterSource(src, type, true, true, false, true);
+}
+
+inline EffectType filterFmSource(SoundSource src, EffectType type) noexcept
+{
+	return filterSource(src, type, true, false, false, false);
+}
+
+inline EffectType filterSsgSource(SoundSource src, EffectType type) noexcept
+{
+	return filterSource(src, type, false, true, false, false);
+}
 }
 
 namespace effect_utils
 {
-EffectType validateEffectId(SoundSource src, const std::string& id)
+EffectIdCode internEffectId(const std::string& id) noexcept
 {
-	if (id == "00") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::Arpeggio;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "01") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::PortamentoUp;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "02") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::PortamentoDown;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "03") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::TonePortamento;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "04") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::Vibrato;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "07") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::Tremolo;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "08") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::RHYTHM:
-		case SoundSource::ADPCM:
-			return EffectType::Pan;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0A") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::VolumeSlide;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0B") {
-		return EffectType::PositionJump;
-	}
-	else if (id == "0C") {
-		return EffectType::SongEnd;
-	}
-	else if (id == "0D") {
-		return EffectType::PatternBreak;
-	}
-	else if (id == "0F") {
-		return EffectType::SpeedTempoChange;
-	}
-	else if (id == "0G") {
-		return EffectType::NoteDelay;
-	}
-	else if (id == "0H") {
-		switch (src) {
-		case SoundSource::SSG:
-			return EffectType::AutoEnvelope;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0I") {
-		switch (src) {
-		case SoundSource::SSG:
-			return EffectType::HardEnvHighPeriod;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0J") {
-		switch (src) {
-		case SoundSource::SSG:
-			return EffectType::HardEnvLowPeriod;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0K") {
-		return EffectType::Retrigger;
-	}
-	else if (id == "0O") {
-		return EffectType::Groove;
-	}
-	else if (id == "0P") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::Detune;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0Q") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::NoteSlideUp;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0R") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::NoteSlideDown;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0S") {
-		return EffectType::NoteRelease;
-	}
-	else if (id == "0T") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::TransposeDelay;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0V") {
-		switch (src) {
-		case SoundSource::SSG:
-			return EffectType::ToneNoiseMix;
-		case SoundSource::RHYTHM:
-			return EffectType::MasterVolume;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0W") {
-		switch (src) {
-		case SoundSource::SSG:
-			return EffectType::NoisePitch;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "0X") {
-		return EffectType::RegisterAddress0;
-	}
-	else if (id == "0Y") {
-		return EffectType::RegisterAddress1;
-	}
-	else if (id == "0Z") {
-		return EffectType::RegisterValue;
-	}
-	else if (id == "B0") {
-		switch (src) {
-		case SoundSource::FM:
-			return EffectType::Brightness;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "EA") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::XVolumeSlide;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "ES") {
-		return EffectType::NoteCut;
-	}
-	else if (id == "FB") {
-		switch (src) {
-		case SoundSource::FM:
-			return EffectType::FBControl;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "FP") {
-		switch (src) {
-		case SoundSource::FM:
-		case SoundSource::SSG:
-		case SoundSource::ADPCM:
-			return EffectType::FineDetune;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "ML") {
-		switch (src) {
-		case SoundSource::FM:
-			return EffectType::MLControl;
-		default:
-			return EffectType::NoEffect;
-		}
-	}
-	else if (id == "RR") {
-		switch (src) {
-		case SoundSource::FM:
-			return EffectType::RRControl;
-		default:
-			return EffectType::NoEffect;
-		}
+	if (id.empty()) return EffectIdCode::Unknown;
+	const char c = (id.size() > 1) ? id[1] : '\0';
+
+	switch (id.front()) {
+	case '-':
+		return (c == '-') ? EffectIdCode::None : EffectIdCode::Unknown;
+	case '0':
+		switch (c) {
+		case '0':	return EffectIdCode::Id00;
+		case '1':	return EffectIdCode::Id01;
+		case '2':	return EffectIdCode::Id02;
+		case '3':	return EffectIdCode::Id03;
+		case '4':	return EffectIdCode::Id04;
+		case '7':	return EffectIdCode::Id07;
+		case '8':	return EffectIdCode::Id08;
+		case 'A':	return EffectIdCode::Id0A;
+		case 'B':	return EffectIdCode::Id0B;
+		case 'C':	return EffectIdCode::Id0C;
+		case 'D':	return EffectIdCode::Id0D;
+		case 'F':	return EffectIdCode::Id0F;
+		case 'G':	return EffectIdCode::Id0G;
+		case 'H':	return EffectIdCode::Id0H;
+		case 'I':	return EffectIdCode::Id0I;
+		case 'J':	return EffectIdCode::Id0J;
+		case 'K':	return EffectIdCode::Id0K;
+		case 'O':	return EffectIdCode::Id0O;
+		case 'P':	return EffectIdCode::Id0P;
+		case 'Q':	return EffectIdCode::Id0Q;
+		case 'R':	return EffectIdCode::Id0R;
+		case 'S':	return EffectIdCode::Id0S;
+		case 'T':	return EffectIdCode::Id0T;
+		case 'V':	return EffectIdCode::Id0V;
+		case 'W':	return EffectIdCode::Id0W;
+		case 'X':	return EffectIdCode::Id0X;
+		case 'Y':	return EffectIdCode::Id0Y;
+		case 'Z':	return EffectIdCode::Id0Z;
+		default:	return EffectIdCode::Unknown;
+		}
+	case 'A':
+		return EffectIdCode::IdAx;
+	case 'B':
+		return (c == '0') ? EffectIdCode::IdB0 : EffectIdCode::Unknown;
+	case 'D':
+		return EffectIdCode::IdDx;
+	case 'E':
+		switch (c) {
+		case 'A':	return EffectIdCode::IdEA;
+		case 'S':	return EffectIdCode::IdES;
+		default:	return EffectIdCode::Unknown;
+		}
+	case 'F':
+		switch (c) {
+		case 'B':	return EffectIdCode::IdFB;
+		case 'P':	return EffectIdCode::IdFP;
+		default:	return EffectIdCode::Unknown;
+		}
+	case 'M':
+		return (c == 'L') ? EffectIdCode::IdML : EffectIdCode::IdMx;
+	case 'R':
+		return (c == 'R') ? EffectIdCode::IdRR : EffectIdCode::Unknown;
+	case 'T':
+		return EffectIdCode::IdTx;
+	default:
+		return EffectIdCode::Unknown;
 	}
-	else {
-		switch (id.front()) {
-		case 'A':
-			switch (src) {
-			case SoundSource::FM:
-				return EffectType::ARControl;
-			default:
-				return EffectType::NoEffect;
-			}
-		case 'D':
-			switch (src) {
-			case SoundSource::FM:
-				return EffectType::DRControl;
-			default:
-				return EffectType::NoEffect;
-			}
-		case 'M':
-			return EffectType::VolumeDelay;
-		case 'T':
-			switch (src) {
-			case SoundSource::FM:
-				return EffectType::TLControl;
-			default:
-				return EffectType::NoEffect;
-			}
-		default:
-			return EffectType::NoEffect;
-		}
+}
+
+EffectType validateEffectId(SoundSource src, EffectIdCode code) noexcept
+{
+	switch (code) {
+	case EffectIdCode::Id00:	return filterToneSource(src, EffectType::Arpeggio);
+	case EffectIdCode::Id01:	return filterToneSource(src, EffectType::PortamentoUp);
+	case EffectIdCode::Id02:	return filterToneSource(src, EffectType::PortamentoDown);
+	case EffectIdCode::Id03:	return filterToneSource(src, EffectType::TonePortamento);
+	case EffectIdCode::Id04:	return filterToneSource(src, EffectType::Vibrato);
+	case EffectIdCode::Id07:	return filterToneSource(src, EffectType::Tremolo);
+	case EffectIdCode::Id08:	return filterSource(src, EffectType::Pan, true, false, true, true);
+	case EffectIdCode::Id0A:	return filterToneSource(src, EffectType::VolumeSlide);
+	case EffectIdCode::Id0B:	return EffectType::PositionJump;
+	case EffectIdCode::Id0C:	return EffectType::SongEnd;
+	case EffectIdCode::Id0D:	return EffectType::PatternBreak;
+	case EffectIdCode::Id0F:	return EffectType::SpeedTempoChange;
+	case EffectIdCode::Id0G:	return EffectType::NoteDelay;
+	case EffectIdCode::Id0H:	return filterSsgSource(src, EffectType::AutoEnvelope);
+	case EffectIdCode::Id0I:	return filterSsgSource(src, EffectType::HardEnvHighPeriod);
+	case EffectIdCode::Id0J:	return filterSsgSource(src, EffectType::HardEnvLowPeriod);
+	case EffectIdCode::Id0K:	return EffectType::Retrigger;
+	case EffectIdCode::Id0O:	return EffectType::Groove;
+	case EffectIdCode::Id0P:	return filterToneSource(src, EffectType::Detune);
+	case EffectIdCode::Id0Q:	return filterToneSource(src, EffectType::NoteSlideUp);
+	case EffectIdCode::Id0R:	return filterToneSource(src, EffectType::NoteSlideDown);
+	case EffectIdCode::Id0S:	return EffectType::NoteRelease;
+	case EffectIdCode::Id0T:	return filterToneSource(src, EffectType::TransposeDelay);
+	case EffectIdCode::Id0V:
+		switch (src) {
+		case SoundSource::SSG:		return EffectType::ToneNoiseMix;
+		case SoundSource::RHYTHM:	return EffectType::MasterVolume;
+		default:					return EffectType::NoEffect;
+		}
+	case EffectIdCode::Id0W:	return filterSsgSource(src, EffectType::NoisePitch);
+	case EffectIdCode::Id0X:	return EffectType::RegisterAddress0;
+	case EffectIdCode::Id0Y:	return EffectType::RegisterAddress1;
+	case EffectIdCode::Id0Z:	return EffectType::RegisterValue;
+	case EffectIdCode::IdB0:	return filterFmSource(src, EffectType::Brightness);
+	case EffectIdCode::IdEA:	return filterToneSource(src, EffectType::XVolumeSlide);
+	case EffectIdCode::IdES:	return EffectType::NoteCut;
+	case EffectIdCode::IdFB:	return filterFmSource(src, EffectType::FBControl);
+	case EffectIdCode::IdFP:	return filterToneSource(src, EffectType::FineDetune);
+	case EffectIdCode::IdML:	return filterFmSource(src, EffectType::MLControl);
+	case EffectIdCode::IdRR:	return filterFmSource(src, EffectType::RRControl);
+	case EffectIdCode::IdAx:	return filterFmSource(src, EffectType::ARControl);
+	case EffectIdCode::IdDx:	return filterFmSource(src, EffectType::DRControl);
+	case EffectIdCode::IdMx:	return EffectType::VolumeDelay;
+	case EffectIdCode::IdTx:	return filterFmSource(src, EffectType::TLControl);
+	default:					return EffectType::NoEffect;
 	}
 }
 
-Effect validateEffect(SoundSource src, const std::string& id, int value)
+Effect validateEffect(SoundSource src, const Step::PlainEffect& plain) noexcept
 {
-	if (value == Step::EFF_VAL_NONE) return { EffectType::NoEffect, Step::EFF_VAL_NONE };
+	if (plain.value == Step::EFF_VAL_NONE) return { EffectType::NoEffect, Step::EFF_VAL_NONE };
 
-	EffectType type = effect_utils::validateEffectId(src, id);
+	EffectType type = effect_utils::validateEffectId(src, plain.code);
 
 	int v;
 	switch (type) {
@@ -349,10 +200,14 @@ Effect validateEffect(SoundSource src, const std::string& id, int value)
 	case EffectType::TLControl:
 	case EffectType::ARControl:
 	case EffectType::DRControl:
-		v = (CTOHEX.at(id[1]) << 8) | value;
+	{
+		int upper = ctohex(plain.id[1]);
+		if (upper < 0) return { EffectType::NoEffect, Step::EFF_VAL_NONE };
+		v = (upper << 8) | plain.value;
 		break;
+	}
 	default:
-		v = value;
+		v = plain.value;
 	}
 
 	return { type, v };
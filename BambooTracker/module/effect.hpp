@@ -47,12 +47,13 @@ struct Effect
 
 namespace effect_utils
 {
-EffectType validateEffectId(SoundSource src, const std::string& id);
-Effect validateEffect(SoundSource src, const std::string& id, int value);
-inline Effect validateEffect(SoundSource src, const Step::PlainEffect& plain)
+EffectIdCode internEffectId(const std::string& id) noexcept;
+EffectType validateEffectId(SoundSource src, EffectIdCode code) noexcept;
+inline EffectType validateEffectId(SoundSource src, const std::string& id)
 {
-	return validateEffect(src, plain.id, plain.value);
+	return validateEffectId(src, internEffectId(id));
 }
+Effect validateEffect(SoundSource src, const Step::PlainEffect& plain) noexcept;
 
 inline int reverseFmVolume(int volume, bool over0 = false) noexcept
 {
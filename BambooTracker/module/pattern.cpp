@@ -25,22 +25,41 @@
 
 #include "pattern.hpp"
 #include <algorithm>
+#include <atomic>
 #include "effect.hpp"
 #include "note.hpp"
 #include "utils.hpp"
 
 namespace
 {
-constexpr size_t MAX_STEP_SIZE = 256;
+// Modules may be loaded in worker threads
+std::atomic<uint64_t> revisionCounter(0);
+
+inline uint64_t issueRevision() noexcept
+{
+	return ++revisionCounter;
+}
+
+// The cached size is stored in the low bits under the revision
+constexpr int SIZE_BITS = 9;
+constexpr uint64_t SIZE_MASK = (1u << SIZE_BITS) - 1;
 }
 
 Pattern::Pattern(int n, size_t defSize)
-	: num_(n), size_(defSize), steps_(defSize), usedCnt_(0)
+	: num_(n), size_(defSize), steps_(defSize), usedCnt_(0), effSize_(0),
+	  effTableSrc_(SoundSource::FM), effTableRevision_(0), revision_(issueRevision())
+{
+}
+
+Pattern::Pattern(const Pattern& other)
+	: num_(other.num_), size_(other.size_), steps_(other.steps_), usedCnt_(other.usedCnt_), effSize_(0),
+	  effTableSrc_(SoundSource::FM), effTableRevision_(0), revision_(other.getRevision())
 {
 }
 
 Pattern::Pattern(int n, size_t size, const std::vector<Step>& steps)
-	: num_(n), size_(size), steps_(steps), usedCnt_(0)
+	: num_(n), size_(size), steps_(steps), usedCnt_(0), effSize_(0),
+	  effTableSrc_(SoundSource::FM), effTableRevision_(0), revision_(issueRevision())
 {
 }
 
@@ -49,13 +68,52 @@ Step& Pattern::getStep(int n)
 	return steps_.at(static_cast<size_t>(n));
 }
 
+void Pattern::invalidateCache() noexcept
+{
+	// Caches are valid only while they are tagged with the current revision
+	revision_.store(issueRevision(), std::memory_order_release);
+}
+
+const Pattern::ValidatedEffects& Pattern::getValidatedEffects(int n, SoundSource src) const
+{
+	if (effTableRevision_.load(std::memory_order_relaxed) != getRevision() || effTableSrc_ != src)
+		buildEffectTable(src);
+	return effTable_.at(static_cast<size_t>(n));
+}
+
+void Pattern::buildEffectTable(SoundSource src) const
+{
+	// Tag with the revision read before decoding,
+	// so that an edit while decoding leaves the table outdated
+	uint64_t rev = getRevision();
+	effTable_.resize(steps_.size());
+	for (size_t i = 0; i < steps_.size(); ++i) {
+		for (int j = 0; j < Step::N_EFFECT; ++j) {
+			effTable_[i][static_cast<size_t>(j)] = effect_utils::validateEffect(src, steps_[i].getEffect(j));
+		}
+	}
+	effTableSrc_ = src;
+	effTableRevision_.store(rev, std::memory_order_relaxed);
+}
+
 size_t Pattern::getSize() const
+{
+	uint64_t rev = getRevision();
+	uint64_t cache = effSize_.load(std::memory_order_relaxed);
+	if ((cache >> SIZE_BITS) == (rev & (~uint64_t(0) >> SIZE_BITS))) return cache & SIZE_MASK;
+
+	size_t size = calculateSize();
+	effSize_.store((rev << SIZE_BITS) | size, std::memory_order_relaxed);
+	return size;
+}
+
+size_t Pattern::calculateSize() const
 {
 	for (size_t i = 0; i < size_; ++i) {
 		for (int j = 0; j < Step::N_EFFECT; ++j) {
 			if (!steps_[i].hasEffectValue(j)) continue;
 			// "SoundSource::FM" is dummy, these effects are not related with sound source
-			switch (effect_utils::validateEffectId(SoundSource::FM, steps_[i].getEffectId(j))) {
+			switch (effect_utils::validateEffectId(SoundSource::FM, steps_[i].getEffectIdCode(j))) {
 			case EffectType::PositionJump:
 			case EffectType::SongEnd:
 			case EffectType::PatternBreak:
@@ -73,13 +131,16 @@ void Pattern::changeSize(size_t size)
 	if (size && size <= MAX_STEP_SIZE) {
 		size_ = size;
 		if (steps_.size() < size) steps_.resize(size);
+		invalidateCache();
 	}
 }
 
 void Pattern::insertStep(int n)
 {
-	if (n < static_cast<int>(size_))
+	if (n < static_cast<int>(size_)) {
 		steps_.emplace(steps_.begin() + n);
+		invalidateCache();
+	}
 }
 
 void Pattern::deletePreviousStep(int n)
@@ -89,6 +150,7 @@ void Pattern::deletePreviousStep(int n)
 	steps_.erase(steps_.begin() + n - 1);
 	if (steps_.size() < size_)
 		steps_.resize(size_);
+	invalidateCache();
 }
 
 bool Pattern::hasEvent() const
@@ -115,7 +177,7 @@ std::set<int> Pattern::getRegisteredInstruments() const
 	return set;
 }
 
-Pattern Pattern::clone(int asNumber)
+Pattern Pattern::clone(int asNumber) const
 {
 	return Pattern(asNumber, size_, steps_);
 }
@@ -130,9 +192,11 @@ void Pattern::transpose(int semitones, const std::vector<int>& excludeInsts)
 			step.setNoteNumber(utils::clamp(note + semitones, 0, Note::NOTE_NUMBER_RANGE - 1));
 		}
 	}
+	invalidateCache();
 }
 
 void Pattern::clear()
 {
 	steps_ = std::vector<Step>(size_);
+	invalidateCache();
 }
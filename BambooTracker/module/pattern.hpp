@@ -27,13 +27,21 @@
 
 #include <vector>
 #include <set>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include "step.hpp"
+#include "effect.hpp"
 
 class Pattern
 {
 public:
 	Pattern(int n, size_t defSize);
+	Pattern(const Pattern& other);
+	Pattern& operator=(const Pattern&) = delete;
+
+	static constexpr size_t MAX_STEP_SIZE = 256;
 
 	inline void setNumber(int n) noexcept { num_ = n; }
 	inline int getNumber() const noexcept { return num_; }
@@ -44,8 +52,18 @@ public:
 
 	Step& getStep(int n);
 
+	using ValidatedEffects = std::array<Effect, Step::N_EFFECT>;
+	/// Effects of the step validated for the sound source, decoded once until the cache is discarded.
+	/// The cache is rebuilt lazily, so only the live playback may read it.
+	/// Edits may discard it from another thread while it is rebuilt.
+	const ValidatedEffects& getValidatedEffects(int n, SoundSource src) const;
+
 	size_t getSize() const;
 	void changeSize(size_t size);
+	/// Discard the cached effective size and validated effects and renew the revision after changing steps.
+	void invalidateCache() noexcept;
+	/// Revision number of the steps, unique among patterns and renewed when the cache is discarded.
+	inline uint64_t getRevision() const noexcept { return revision_.load(std::memory_order_acquire); }
 
 	void insertStep(int n);
 	void deletePreviousStep(int n);
@@ -54,7 +72,7 @@ public:
 	std::vector<int> getEditedStepIndices() const;
 	std::set<int> getRegisteredInstruments() const;
 
-	Pattern clone(int asNumber);
+	Pattern clone(int asNumber) const;
 
 	void transpose(int semitones, const std::vector<int>& excludeInsts);
 
@@ -65,6 +83,18 @@ private:
 	size_t size_;
 	std::vector<Step> steps_;
 	int usedCnt_;
+	/// Cached size cut by position jump, song end or pattern break,
+	/// packed with the revision it was calculated from.
+	mutable std::atomic<uint64_t> effSize_;
+	/// Cached validated effects of all steps for \c effTableSrc_.
+	mutable std::vector<ValidatedEffects> effTable_;
+	mutable SoundSource effTableSrc_;
+	/// Revision the cached effects were decoded from. 0 means none.
+	mutable std::atomic<uint64_t> effTableRevision_;
+	std::atomic<uint64_t> revision_;
+
+	size_t calculateSize() const;
+	void buildEffectTable(SoundSource src) const;
 
 	Pattern(int n, size_t size, const std::vector<Step>& steps);
 };
@@ -24,6 +24,10 @@
  */
 
 #include "step.hpp"
+#include <type_traits>
+#include "effect.hpp"
+
+static_assert(std::is_trivially_copyable<Step>::value, "Step must be trivially copyable.");
 
 const std::string Step::EFF_ID_NONE = "--";
 
@@ -33,11 +37,26 @@ Step::Step()
 	  vol_(VOLUME_NONE)
 {
 	for (size_t i = 0; i < N_EFFECT; ++i) {
-		eff_[i].id = EFF_ID_NONE;
-		eff_[i].value = EFF_VAL_NONE;
+		clearEffect(i);
 	}
 }
 
+void Step::setEffectId(int n, const std::string& str)
+{
+	PlainEffect& eff = eff_[n];
+	eff.id[0] = str.size() > 0 ? str[0] : '-';
+	eff.id[1] = str.size() > 1 ? str[1] : '-';
+	eff.code = effect_utils::internEffectId(str);
+}
+
+void Step::clearEffectId(int n)
+{
+	PlainEffect& eff = eff_[n];
+	eff.id[0] = '-';
+	eff.id[1] = '-';
+	eff.code = EffectIdCode::None;
+}
+
 void Step::clear()
 {
 	clearNoteNumber();
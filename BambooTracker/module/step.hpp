@@ -27,6 +27,18 @@
 
 #include <string>
 #include <stdexcept>
+#include <cstdint>
+
+/// Interned effect ID which does not depend on sound source
+enum class EffectIdCode : uint8_t
+{
+	None, Unknown,
+	Id00, Id01, Id02, Id03, Id04, Id07, Id08, Id0A, Id0B, Id0C, Id0D, Id0F, Id0G, Id0H, Id0I, Id0J,
+	Id0K, Id0O, Id0P, Id0Q, Id0R, Id0S, Id0T, Id0V, Id0W, Id0X, Id0Y, Id0Z, IdB0, IdEA, IdES, IdFB,
+	IdFP, IdML, IdRR,
+	// 1st character is ID and 2nd character is the upper digit of value
+	IdAx, IdDx, IdMx, IdTx
+};
 
 class Step
 {
@@ -45,10 +57,10 @@ public:
 		NOTE_KEY_CUT	= -7,
 	};
 	int getNoteNumber() const noexcept { return note_; }
-	void setNoteNumber(int num) { note_ = num; }
+	void setNoteNumber(int num) { note_ = static_cast<int16_t>(num); }
 	void setKeyOff() { note_ = NOTE_KEY_OFF; }
 	void setKeyCut() { note_ = NOTE_KEY_CUT; }
-	void setEchoBuffer(int n) { note_ = NOTE_ECHO0 - n; }
+	void setEchoBuffer(int n) { note_ = static_cast<int16_t>(NOTE_ECHO0 - n); }
 	void clearNoteNumber() noexcept { note_ = NOTE_NONE; }
 	bool hasGeneralNote() const noexcept { return note_ > NOTE_NONE; }
 	bool hasKeyOff() const noexcept { return note_ == NOTE_KEY_OFF; }
@@ -60,7 +72,7 @@ public:
 
 	static constexpr int INST_NONE = -1;
 	int getInstrumentNumber() const noexcept { return inst_; }
-	void setInstrumentNumber(int num) { inst_ = num; }
+	void setInstrumentNumber(int num) { inst_ = static_cast<int16_t>(num); }
 	void clearInstrumentNumber() noexcept { inst_ = INST_NONE; }
 	bool hasInstrument() const noexcept { return inst_ != INST_NONE; }
 
@@ -68,23 +80,24 @@ public:
 
 	static constexpr int VOLUME_NONE = -1;
 	int getVolume() const noexcept { return vol_; }
-	void setVolume(int volume) { vol_ = volume; }
+	void setVolume(int volume) { vol_ = static_cast<int16_t>(volume); }
 	void clearVolume() noexcept { vol_ = VOLUME_NONE; }
 	bool hasVolume() const noexcept { return vol_ != VOLUME_NONE; }
 
 	static bool testEmptyVolume(int vol) { return vol == VOLUME_NONE; }
 
 	static const std::string EFF_ID_NONE;	// "--"
-	std::string getEffectId(int n) const { return eff_[n].id; }
-	void setEffectId(int n, const std::string& str) { eff_[n].id = str; }
-	void clearEffectId(int n) { eff_[n].id = EFF_ID_NONE; }
-	bool hasEffectId(int n) const { return eff_[n].id != EFF_ID_NONE; }
+	std::string getEffectId(int n) const { return std::string(eff_[n].id, 2); }
+	EffectIdCode getEffectIdCode(int n) const { return eff_[n].code; }
+	void setEffectId(int n, const std::string& str);
+	void clearEffectId(int n);
+	bool hasEffectId(int n) const { return eff_[n].code != EffectIdCode::None; }
 
 	static bool testEmptyEffectId(const std::string& id) { return id == EFF_ID_NONE; }
 
 	static constexpr int EFF_VAL_NONE = -1;
 	int getEffectValue(int n) const { return eff_[n].value; }
-	void setEffectValue(int n, int v) { eff_[n].value = v; }
+	void setEffectValue(int n, int v) { eff_[n].value = static_cast<int16_t>(v); }
 	void clearEffectValue(int n) { eff_[n].value = EFF_VAL_NONE; }
 	bool hasEffectValue(int n) const { return eff_[n].value != EFF_VAL_NONE; }
 
@@ -92,8 +105,9 @@ public:
 
 	struct PlainEffect
 	{
-		std::string id;
-		int value;
+		char id[2];	// Only for display
+		EffectIdCode code;
+		int16_t value;
 	};
 
 	static constexpr int N_EFFECT = 4;
@@ -127,19 +141,21 @@ private:
 	///		 -5: echo 3 notes before
 	///		 -6: echo 4 notes before
 	///		 -7: key cut
-	int note_;
+	int16_t note_;
 	/// instNum_
 	///		0<=: instrument number
 	///		 -1: none
-	int inst_;
+	int16_t inst_;
 	/// vol_
 	///		0<=: volume level
 	///		 -1: none
-	int vol_;
+	int16_t vol_;
 	/// eff
 	///	[id]
 	///		 "--": none
 	///		other: effect ID
+	///	[code]
+	///		interned [id]
 	/// [value]
 	///		0<=: effect value
 	///		 -1: none
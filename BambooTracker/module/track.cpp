@@ -35,18 +35,38 @@ constexpr int MAX_ORDER_SIZE = 256;
 }
 
 Track::Track(int number, SoundSource source, int channelInSource, int defPattenSize)
-	: effetDisplayWidth_(0), visibility_(true)
+	: patterns_(PATTERN_SIZE),
+	  defPtnSize_(static_cast<size_t>(defPattenSize)),
+	  effetDisplayWidth_(0),
+	  visibility_(true)
 
 {
 	setAttribute(number, source, channelInSource);
 
+	materializePattern(0).increaseUsedCount();
+	order_.push_back(0);	// Set first order
+}
+
+Track::Track(const Track& other)
+	: attrib_(other.attrib_),
+	  order_(other.order_),
+	  defPtnSize_(other.defPtnSize_),
+	  effetDisplayWidth_(other.effetDisplayWidth_),
+	  visibility_(other.visibility_)
+{
 	patterns_.reserve(PATTERN_SIZE);
-	for (int i = 0; i < PATTERN_SIZE; ++i) {
-		patterns_.emplace_back(i, defPattenSize);
+	for (const auto& ptn : other.patterns_) {
+		patterns_.push_back(ptn ? std::make_unique<Pattern>(*ptn) : nullptr);
 	}
+}
 
-	patterns_[0].increaseUsedCount();
-	order_.push_back(0);	// Set first order
+Track& Track::operator=(const Track& other)
+{
+	if (this != &other) {
+		Track tmp(other);
+		*this = std::move(tmp);
+	}
+	return *this;
 }
 
 void Track::setAttribute(int number, SoundSource source, int channelInSource) noexcept
@@ -77,7 +97,7 @@ bool Track::canAddNewOrder() const
 
 Pattern& Track::getPattern(int num)
 {
-	return patterns_.at(static_cast<size_t>(num));
+	return materializePattern(num);
 }
 
 Pattern& Track::getPatternFromOrderNumber(int num)
@@ -87,8 +107,8 @@ Pattern& Track::getPatternFromOrderNumber(int num)
 
 int Track::searchFirstUneditedUnusedPattern() const
 {
-	auto it = utils::findIf(patterns_, [](const Pattern& pattern) {
-		return (!pattern.hasEvent() && !pattern.getUsedCount());
+	auto it = utils::findIf(patterns_, [](const std::unique_ptr<Pattern>& pattern) {
+		return (!pattern || (!pattern->hasEvent() && !pattern->getUsedCount()));
 	});
 	return (it == patterns_.cend() ? -1 : std::distance(patterns_.cbegin(), it));
 }
@@ -98,21 +118,25 @@ int Track::clonePattern(int num)
 	int n = searchFirstUneditedUnusedPattern();
 	if (n == -1) return num;
 	else {
-		patterns_.at(static_cast<size_t>(n)) = patterns_.at(static_cast<size_t>(num)).clone(n);
+		const Pattern& src = materializePattern(num);
+		patterns_.at(static_cast<size_t>(n)) = std::make_unique<Pattern>(src.clone(n));
 		return n;
 	}
 }
 
 std::vector<int> Track::getEditedPatternIndices() const
 {
-	return utils::findIndicesIf(patterns_, [](const Pattern& pattern) { return pattern.hasEvent(); });
+	return utils::findIndicesIf(patterns_, [](const std::unique_ptr<Pattern>& pattern) {
+		return (pattern && pattern->hasEvent());
+	});
 }
 
 std::set<int> Track::getRegisteredInstruments() const
 {
 	std::set<int> set;
-	for (const Pattern& pattern : patterns_) {
-		auto&& insts = pattern.getRegisteredInstruments();
+	for (const auto& pattern : patterns_) {
+		if (!pattern) continue;
+		auto&& insts = pattern->getRegisteredInstruments();
 		std::copy(insts.cbegin(), insts.cend(), std::inserter(set, set.end()));
 	}
 	return set;
@@ -120,8 +144,8 @@ std::set<int> Track::getRegisteredInstruments() const
 
 void Track::registerPatternToOrder(int order, int pattern)
 {
-	patterns_.at(static_cast<size_t>(pattern)).increaseUsedCount();
-	patterns_.at(static_cast<size_t>(order_.at(static_cast<size_t>(order)))).decreaseUsedCount();
+	materializePattern(pattern).increaseUsedCount();
+	materializePattern(order_.at(static_cast<size_t>(order))).decreaseUsedCount();
 	order_.at(static_cast<size_t>(order)) = pattern;
 }
 
@@ -132,12 +156,12 @@ void Track::insertOrderBelow(int order)
 
 	if (order == static_cast<int>(order_.size()) - 1) order_.push_back(n);
 	else order_.insert(order_.begin() + order + 1, n);
-	patterns_[static_cast<size_t>(n)].increaseUsedCount();
+	materializePattern(n).increaseUsedCount();
 }
 
 void Track::deleteOrder(int order)
 {
-	patterns_.at(static_cast<size_t>(order_.at(static_cast<size_t>(order)))).decreaseUsedCount();
+	materializePattern(order_.at(static_cast<size_t>(order))).decreaseUsedCount();
 	order_.erase(order_.begin() + order);
 }
 
@@ -148,31 +172,46 @@ void Track::swapOrder(int a, int b)
 
 void Track::changeDefaultPatternSize(size_t size)
 {
-	for (auto& ptn : patterns_) ptn.changeSize(size);
+	if (!size || Pattern::MAX_STEP_SIZE < size) return;
+
+	defPtnSize_ = size;
+	for (auto& ptn : patterns_) {
+		if (ptn) ptn->changeSize(size);
+	}
 }
 
 void Track::clearUnusedPatterns()
 {
-	for (Pattern& pattern : patterns_) {
-		if (!pattern.getUsedCount() && pattern.hasEvent())
-			pattern.clear();
+	// Release unused patterns instead of clearing them
+	for (auto& pattern : patterns_) {
+		if (pattern && !pattern->getUsedCount()) pattern.reset();
 	}
 }
 
 void Track::replaceDuplicateInstrumentsInPatterns(const std::unordered_map<int, int>& map)
 {
-	for (Pattern& pattern : patterns_) {
-		if (pattern.hasEvent()) {
-			for (size_t i = 0; i < pattern.getSize(); ++i) {
-				Step& step = pattern.getStep(static_cast<int>(i));
+	for (auto& pattern : patterns_) {
+		if (pattern && pattern->hasEvent()) {
+			for (size_t i = 0; i < pattern->getSize(); ++i) {
+				Step& step = pattern->getStep(static_cast<int>(i));
 				int inst = step.getInstrumentNumber();
 				if (map.count(inst)) step.setInstrumentNumber(map.at(inst));
 			}
+			pattern->invalidateCache();
 		}
 	}
 }
 
 void Track::transpose(int semitones, const std::vector<int>& excludeInsts)
 {
-	for (Pattern& pattern : patterns_) pattern.transpose(semitones, excludeInsts);
+	for (auto& pattern : patterns_) {
+		if (pattern) pattern->transpose(semitones, excludeInsts);
+	}
+}
+
+Pattern& Track::materializePattern(int num)
+{
+	std::unique_ptr<Pattern>& ptn = patterns_.at(static_cast<size_t>(num));
+	if (!ptn) ptn = std::make_unique<Pattern>(num, defPtnSize_);
+	return *ptn;
 }
@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <set>
+#include <memory>
 #include <unordered_map>
 #include "pattern.hpp"
 #include "bamboo_tracker_defs.hpp"
@@ -49,6 +50,10 @@ class Track
 {
 public:
 	Track(int number, SoundSource source, int channelInSource, int defPattenSize);
+	Track(const Track& other);
+	Track& operator=(const Track& other);
+	Track(Track&&) noexcept = default;
+	Track& operator=(Track&&) noexcept = default;
 
 	void setAttribute(int number, SoundSource source, int channelInSource) noexcept;
 	TrackAttribute getAttribute() const noexcept { return attrib_; }
@@ -84,7 +89,12 @@ private:
 	TrackAttribute attrib_;
 
 	std::vector<int> order_;
-	std::vector<Pattern> patterns_;
+	/// Patterns are allocated when they are first written or registered to an order.
+	/// Null entry means an unused pattern which has no event.
+	std::vector<std::unique_ptr<Pattern>> patterns_;
+	size_t defPtnSize_;
 	size_t effetDisplayWidth_;
 	bool visibility_;
+
+	Pattern& materializePattern(int num);
 };
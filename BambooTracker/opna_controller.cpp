@@ -59,16 +59,23 @@ std::unique_ptr<chip::AbstractResampler> generateResampler(chip::ResamplerType t
 	case chip::ResamplerType::BlipBuf:		return std::make_unique<chip::BlipResampler>(false);
 	case chip::ResamplerType::FastBlipBuf:	return std::make_unique<chip::BlipResampler>(true);
 	case chip::ResamplerType::Linear:		return std::make_unique<chip::LinearResampler>();
+	case chip::ResamplerType::SincFast:		return std::make_unique<chip::SincResampler>(chip::SincResampler::Quality::Fast);
+	case chip::ResamplerType::SincMedium:	return std::make_unique<chip::SincResampler>(chip::SincResampler::Quality::Medium);
+	case chip::ResamplerType::SincBest:		return std::make_unique<chip::SincResampler>(chip::SincResampler::Quality::Best);
 	}
 }
 }
 
-OPNAController::OPNAController(chip::OpnaEmulator emu, int clock, int rate, int duration, chip::ResamplerType resampler)
+OPNAController::OPNAController(chip::OpnaEmulator emu, chip::YmfmFidelity fidelity, int clock, int rate, int duration,
+							   chip::ResamplerType resampler)
 	: mode_(SongType::Standard),
-	  storePointADPCM_(0)
+	  emu_(emu),
+	  clock_(clock),
+	  resamplerType_(resampler),
+	  masterVolume_(100)
 {
 	constexpr size_t DRAM_SIZE = 262144;	// 256KiB
-	opna_ = std::make_unique<chip::OPNA>(emu, clock, rate, duration, DRAM_SIZE,
+	opna_ = std::make_unique<chip::OPNA>(emu, fidelity, clock, rate, duration, DRAM_SIZE,
 										 generateResampler(resampler), generateResampler(resampler));
 
 	for (size_t inch = 0; inch < 6; ++inch) {
@@ -82,6 +89,7 @@ OPNAController::OPNAController(chip::OpnaEmulator emu, int clock, int rate, int
 	isMuteADPCM_ = false;
 
 	resetState();
+	clearSamplesADPCM();
 
 	outputHistory_.reset(new int16_t[2 * bt_defs::OUTPUT_HISTORY_SIZE]{});
 	outputHistoryReady_.reset(new int16_t[2 * bt_defs::OUTPUT_HISTORY_SIZE]{});
@@ -224,6 +232,26 @@ void OPNAController::setImmediateWriteMode(bool enabled) noexcept
 	opna_->setImmediateWriteMode(enabled);
 }
 
+void OPNAController::setSsgPipelineEnabled(bool enabled)
+{
+	opna_->setSsgPipelineEnabled(enabled);
+}
+
+bool OPNAController::isYmfm() const noexcept
+{
+	return opna_->isYmfm();
+}
+
+chip::YmfmFidelity OPNAController::getYmfmFidelity() const noexcept
+{
+	return opna_->getYmfmFidelity();
+}
+
+void OPNAController::setYmfmFidelity(chip::YmfmFidelity fidelity)
+{
+	opna_->setYmfmFidelity(fidelity);
+}
+
 /********** Mute **********/
 void OPNAController::setMuteState(SoundSource src, int chInSrc, bool isMute)
 {
@@ -269,12 +297,14 @@ void OPNAController::setDuration(int duration)
 
 void OPNAController::setResampler(chip::ResamplerType type)
 {
+	resamplerType_ = type;
 	opna_->setFmResampler(generateResampler(type));
 	opna_->setSsgResampler(generateResampler(type));
 }
 
 void OPNAController::setMasterVolume(int percentage)
 {
+	masterVolume_ = percentage;
 	opna_->setMasterVolume(percentage);
 }
 
@@ -283,6 +313,18 @@ void OPNAController::setExportContainer(std::shared_ptr<chip::AbstractRegisterWr
 	opna_->setRegisterWriteLogger(cntr);
 }
 
+std::unique_ptr<chip::OPNA> OPNAController::createChipReplica(int rate) const
+{
+	// Use the fidelity of the live chip so that the replica sounds the same
+	auto chip = std::make_unique<chip::OPNA>(emu_, opna_->getYmfmFidelity(), clock_, rate, opna_->getMaxDuration(), opna_->getDRAMSize(),
+											 generateResampler(resamplerType_), generateResampler(resamplerType_));
+	chip->setImmediateWriteMode(opna_->isImmediateWriteMode());
+	chip->setMasterVolume(masterVolume_);
+	chip->setVolumeFM(opna_->getVolumeFM());
+	chip->setVolumeSSG(opna_->getVolumeSSG());
+	return chip;
+}
+
 /********** Internal common process **********/
 void OPNAController::checkRealToneByArpeggio(const ArpeggioIterInterface& arpItr,
 											 const EchoBuffer& echoBuf, Note& baseNote,
@@ -1172,6 +1214,11 @@ void OPNAController::haltSequencesFM(int ch)
 	if (auto& xVolSldItr = fm.xVolSldItr) xVolSldItr->end();
 }
 
+void OPNAController::setEchoBufferFM(int ch, const EchoBuffer& buf)
+{
+	fm_[ch].echoBuf = buf;
+}
+
 /********** Chip details **********/
 bool OPNAController::isKeyOnFM(int ch) const
 {
@@ -2427,6 +2474,11 @@ void OPNAController::haltSequencesSSG(int ch)
 	if (auto& xVolSldItr = ssg.xVolSldItr) xVolSldItr->end();
 }
 
+void OPNAController::setEchoBufferSSG(int ch, const EchoBuffer& buf)
+{
+	ssg_[ch].echoBuf = buf;
+}
+
 /********** Chip details **********/
 bool OPNAController::isKeyOnSSG(int ch) const
 {
@@ -3710,13 +3762,33 @@ void OPNAController::updateInstrumentDrumkit(int instNum, int key)
 
 void OPNAController::clearSamplesADPCM()
 {
-	storePointADPCM_ = 0;
+	freeBlocksADPCM_.clear();
+	freeBlocksADPCM_.emplace(0, ((opna_->getDRAMSize() - 1) >> 5) + 1);	// By 32 bytes
 	startAddrADPCM_ = std::numeric_limits<size_t>::max();
 	stopAddrADPCM_ = startAddrADPCM_;
 }
 
 bool OPNAController::storeSampleADPCM(const std::vector<uint8_t>& sample, size_t& startAddr, size_t& stopAddr)
 {
+	if (freeBlocksADPCM_.empty()) return false;
+
+	// First fit
+	size_t len = ((sample.size() - 1) >> 5) + 1;	// By 32 bytes
+	auto it = std::find_if(freeBlocksADPCM_.begin(), freeBlocksADPCM_.end(),
+						   [len](const std::pair<const size_t, size_t>& blk) { return blk.second >= len; });
+	if (it == freeBlocksADPCM_.end()) {
+		// Cut off the sample at the end of memory
+		size_t dramBlkSize = ((opna_->getDRAMSize() - 1) >> 5) + 1;
+		it = std::prev(freeBlocksADPCM_.end());
+		if (it->first + it->second != dramBlkSize) return false;
+		len = it->second;
+	}
+
+	startAddr = it->first;
+	stopAddr = startAddr + len - 1;
+	if (it->second > len) freeBlocksADPCM_.emplace_hint(std::next(it), stopAddr + 1, it->second - len);
+	freeBlocksADPCM_.erase(it);
+
 	// Turn on immediate-write mode to avoid suspending sample writes
 	bool isImmediate = opna_->isImmediateWriteMode();
 	opna_->setImmediateWriteMode(true);
@@ -3730,31 +3802,37 @@ bool OPNAController::storeSampleADPCM(const std::vector<uint8_t>& sample, size_t
 	opna_->setRegister(0x10c, dramLim & 0xff);
 	opna_->setRegister(0x10d, (dramLim >> 8) & 0xff);
 
-	bool stored = false;
-	if (storePointADPCM_ < dramLim) {
-		startAddr = storePointADPCM_;
-		opna_->setRegister(0x102, startAddr & 0xff);
-		opna_->setRegister(0x103, (startAddr >> 8) & 0xff);
+	opna_->setRegister(0x102, startAddr & 0xff);
+	opna_->setRegister(0x103, (startAddr >> 8) & 0xff);
+	opna_->setRegister(0x104, stopAddr & 0xff);
+	opna_->setRegister(0x105, (stopAddr >> 8) & 0xff);
 
-		stopAddr = startAddr + ((sample.size() - 1) >> 5);	// By 32 bytes
-		stopAddr = std::min(stopAddr, dramLim);
-		opna_->setRegister(0x104, stopAddr & 0xff);
-		opna_->setRegister(0x105, (stopAddr >> 8) & 0xff);
-		storePointADPCM_ = stopAddr + 1;
-
-		size_t size = sample.size();
-		for (size_t i = 0; i < size; ++i) {
-			opna_->setRegister(0x108, sample[i]);
-		}
-		stored = true;
-	}
+	size_t size = std::min(sample.size(), len << 5);
+	opna_->writeDRAMBlock(static_cast<uint32_t>(startAddr << 5), sample.data(), size);
 
 	opna_->setRegister(0x100, 0x00);
 	opna_->setRegister(0x110, 0x80);
 
 	opna_->setImmediateWriteMode(isImmediate);
 
-	return stored;
+	return true;
+}
+
+void OPNAController::reserveSampleADPCM(size_t startAddr, size_t stopAddr)
+{
+	auto it = freeBlocksADPCM_.upper_bound(startAddr);
+	if (it != freeBlocksADPCM_.begin()) --it;
+	while (it != freeBlocksADPCM_.end() && it->first <= stopAddr) {
+		size_t first = it->first;
+		size_t last = first + it->second - 1;
+		if (last < startAddr) {
+			++it;
+			continue;
+		}
+		it = freeBlocksADPCM_.erase(it);
+		if (first < startAddr) freeBlocksADPCM_.emplace(first, startAddr - first);
+		if (stopAddr < last) it = freeBlocksADPCM_.emplace(stopAddr + 1, last - stopAddr).first;
+	}
 }
 
 /********** Set volume **********/
@@ -3900,6 +3978,11 @@ void OPNAController::haltSequencesADPCM()
 	if (xVolSldItrAdpcm_) xVolSldItrAdpcm_->end();
 }
 
+void OPNAController::setEchoBufferADPCM(const EchoBuffer& buf)
+{
+	echoBufADPCM_ = buf;
+}
+
 /********** Chip details **********/
 bool OPNAController::isKeyOnADPCM() const
 {
@@ -3918,7 +4001,12 @@ Note OPNAController::getADPCMLatestNote() const
 
 size_t OPNAController::getADPCMStoredSize() const
 {
-	return storePointADPCM_ << 5;
+	size_t dramBlkSize = ((opna_->getDRAMSize() - 1) >> 5) + 1;	// By 32 bytes
+	if (freeBlocksADPCM_.empty()) return dramBlkSize << 5;
+
+	// Return the end of the last used block
+	auto last = std::prev(freeBlocksADPCM_.end());
+	return ((last->first + last->second == dramBlkSize) ? last->first : dramBlkSize) << 5;
 }
 
 /***********************************/
@@ -28,6 +28,7 @@
 #include <cstdint>
 #include <memory>
 #include <unordered_map>
+#include <map>
 #include <deque>
 #include "song.hpp"
 #include "instrument.hpp"
@@ -42,7 +43,8 @@
 class OPNAController
 {
 public:
-	OPNAController(chip::OpnaEmulator emu, int clock, int rate, int duration, chip::ResamplerType resampler);
+	OPNAController(chip::OpnaEmulator emu, chip::YmfmFidelity fidelity, int clock, int rate, int duration,
+				   chip::ResamplerType resampler);
 
 	// Reset and initialize
 	void reset();
@@ -78,6 +80,10 @@ public:
 	void setMode(SongType mode);
 	SongType getMode() const noexcept;
 	void setImmediateWriteMode(bool enabled) noexcept;
+	void setSsgPipelineEnabled(bool enabled);
+	bool isYmfm() const noexcept;
+	chip::YmfmFidelity getYmfmFidelity() const noexcept;
+	void setYmfmFidelity(chip::YmfmFidelity fidelity);
 
 	// Mute
 	void setMuteState(SoundSource src, int chInSrc, bool isMute);
@@ -93,10 +99,15 @@ public:
 
 	// Export
 	void setExportContainer(std::shared_ptr<chip::AbstractRegisterWriteLogger> cntr = nullptr);
+	std::unique_ptr<chip::OPNA> createChipReplica(int rate) const;
 
 private:
 	std::unique_ptr<chip::OPNA> opna_;
 	SongType mode_;
+	const chip::OpnaEmulator emu_;
+	const int clock_;
+	chip::ResamplerType resamplerType_;
+	int masterVolume_;
 
 	struct RegisterWrite
 	{
@@ -168,6 +179,7 @@ public:
 
 	// For state retrieve
 	void haltSequencesFM(int ch);
+	void setEchoBufferFM(int ch, const EchoBuffer& buf);
 
 	// Chip details
 	bool isKeyOnFM(int ch) const;
@@ -292,6 +304,7 @@ public:
 	void setNoteCutSSG(int ch);
 
 	void haltSequencesSSG(int ch);
+	void setEchoBufferSSG(int ch, const EchoBuffer& buf);
 
 	// Chip details
 	bool isKeyOnSSG(int ch) const;
@@ -421,6 +434,8 @@ public:
 	void clearSamplesADPCM();
 	/// [Return] true if sample assignment is success
 	bool storeSampleADPCM(const std::vector<uint8_t>& sample, size_t& startAddr, size_t& stopAddr);
+	/// Mark the region as used without writing sample data
+	void reserveSampleADPCM(size_t startAddr, size_t stopAddr);
 
 	// Set volume
 	void setVolumeADPCM(int volume);
@@ -442,6 +457,7 @@ public:
 
 	// For state retrieve
 	void haltSequencesADPCM();
+	void setEchoBufferADPCM(const EchoBuffer& buf);
 
 	// Chip details
 	bool isKeyOnADPCM() const;
@@ -464,7 +480,7 @@ private:
 	bool shouldWriteEnvADPCM_;
 	bool shouldSetToneADPCM_;
 	size_t startAddrADPCM_, stopAddrADPCM_;	// By 32 bytes
-	size_t storePointADPCM_;	// Move by 32 bytes
+	std::map<size_t, size_t> freeBlocksADPCM_;	// Start address -> length, by 32 bytes
 	ADPCMEnvelopeIter envItrADPCM_;
 	ArpeggioIterInterface arpItrADPCM_;
 	PitchIter ptItrADPCM_;
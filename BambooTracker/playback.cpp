@@ -78,6 +78,7 @@ PlaybackManager::PlaybackManager(std::shared_ptr<OPNAController> opnaCtrl,
 								 std::weak_ptr<Module> mod,
 								 bool isRetrieveChannel)
 	: opnaCtrl_(opnaCtrl),
+	  isDryRun_(!opnaCtrl),
 	  instMan_(instMan),
 	  tickCounter_(tickCounter),
 	  mod_(mod),
@@ -85,7 +86,8 @@ PlaybackManager::PlaybackManager(std::shared_ptr<OPNAController> opnaCtrl,
 	  playingPos_(Position::INVALID, Position::INVALID),
 	  nextReadPos_(Position::INVALID, Position::INVALID),
 	  isFindNextStep_(false),
-	  isRetrieveChannel_(isRetrieveChannel)
+	  isRetrieveChannel_(isRetrieveChannel),
+	  checkpointGrooveCnt_(0)
 {
 	songStyle_ = mod.lock()->getSong(curSongNum_).getStyle();
 
@@ -99,6 +101,7 @@ void PlaybackManager::setSong(std::weak_ptr<Module> mod, int songNum)
 	mod_ = mod;
 	curSongNum_ = songNum;
 	songStyle_ = mod_.lock()->getSong(curSongNum_).getStyle();
+	checkpoints_.clear();
 
 	/* opna mode is changed in BambooTracker class */
 
@@ -230,7 +233,7 @@ void PlaybackManager::playStep(int order, int step)
 
 void PlaybackManager::startPlay()
 {
-	opnaCtrl_->reset();
+	if (!isDryRun_) opnaCtrl_->reset();
 
 	Song& song = mod_.lock()->getSong(curSongNum_);
 	tickCounter_.lock()->setTempo(song.getTempo());
@@ -255,7 +258,7 @@ void PlaybackManager::stopPlaySong()
 void PlaybackManager::stopPlay()
 {
 	// No mutex to call from PlaybackManager::streamCountUp
-	opnaCtrl_->reset();
+	if (!isDryRun_) opnaCtrl_->reset();
 
 	tickCounter_.lock()->setPlayState(false);
 	playStateFlags_ = PlayStateFlag::Clear;
@@ -291,19 +294,20 @@ int PlaybackManager::streamCountUp()
 
 	if (state > 0) {	// Tick process in playback
 		checkValidPosition();
-		tickProcess(state);
+		if (!isDryRun_) tickProcess(state);
 	}
 	else if (!state) {	// Step process in playback
 		checkValidPosition();
 		if (stepDown()) {
-			stepProcess();
+			if (isDryRun_) stepProcessDryRun();
+			else stepProcess();
 			if (!isFindNextStep_) findNextStep();
 		}
 		else if (!isPlayingStep()) {
 			stopPlay();
 		}
 	}
-	else {	// Stop playback
+	else if (!isDryRun_) {	// Stop playback
 		for (auto& attrib : songStyle_.trackAttribs) {
 			opnaCtrl_->tickEvent(attrib.source, attrib.channelInSource);
 		}
@@ -389,30 +393,32 @@ void PlaybackManager::stepProcess()
 
 	auto& song = mod_.lock()->getSong(curSongNum_);
 
-	// Store effects from the step to map
-	for (auto& attrib : songStyle_.trackAttribs) {
-		auto& step = song.getTrack(attrib.number)
-					 .getPatternFromOrderNumber(playingPos_.order).getStep(playingPos_.step);
+	// Look up the step of each track once and store its effects to map
+	const size_t trackCnt = songStyle_.trackAttribs.size();
+	playingSteps_.resize(trackCnt);
+	for (size_t t = 0; t < trackCnt; ++t) {
+		const TrackAttribute& attrib = songStyle_.trackAttribs[t];
+		Pattern& pattern = song.getTrack(attrib.number).getPatternFromOrderNumber(playingPos_.order);
+		playingSteps_[t] = &pattern.getStep(playingPos_.step);
 		size_t uch = static_cast<size_t>(attrib.channelInSource);
 		effOnKeyOnMem_[attrib.source].at(uch).clear();
 		directRegisterSets_[attrib.source].at(uch).clear();
-		using storeFunc = void (PlaybackManager::*)(int, const Effect&);
-		static const std::unordered_map<SoundSource, storeFunc> storeEffectToMap = {
-			{ SoundSource::FM, &PlaybackManager::storeEffectToMapFM },
-			{ SoundSource::SSG, &PlaybackManager::storeEffectToMapSSG },
-			{ SoundSource::RHYTHM, &PlaybackManager::storeEffectToMapRhythm },
-			{ SoundSource::ADPCM, &PlaybackManager::storeEffectToMapADPCM }
-		};
-		for (int i = 0; i < Step::N_EFFECT; ++i) {
-			Effect&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(i));
-			(this->*storeEffectToMap.at(attrib.source))(attrib.channelInSource, eff);
+		const int ch = attrib.channelInSource;
+		for (const Effect& eff : pattern.getValidatedEffects(playingPos_.step, attrib.source)) {
+			switch (attrib.source) {
+			case SoundSource::FM:		storeEffectToMapFM(ch, eff);		break;
+			case SoundSource::SSG:		storeEffectToMapSSG(ch, eff);		break;
+			case SoundSource::RHYTHM:	storeEffectToMapRhythm(ch, eff);	break;
+			case SoundSource::ADPCM:	storeEffectToMapADPCM(ch, eff);		break;
+			}
 		}
 	}
 
 	// Execute step events
 	bool isNextSet = executeStoredEffectsGlobal();
 	const int countsInStep = tickCounter_.lock()->getCountsInCurrentStep();
-	for (auto& attrib : songStyle_.trackAttribs) {
+	for (size_t t = 0; t < trackCnt; ++t) {
+		const TrackAttribute& attrib = songStyle_.trackAttribs[t];
 		// Check whether it has been set note delay effect
 		size_t uch = static_cast<size_t>(attrib.channelInSource);
 		bool hasSetNoteDelay = false;
@@ -431,8 +437,7 @@ void PlaybackManager::stepProcess()
 		}
 
 		//
-		auto& step = song.getTrack(attrib.number)
-					 .getPatternFromOrderNumber(playingPos_.order).getStep(playingPos_.step);
+		const Step& step = *playingSteps_[t];
 		switch (attrib.source) {
 		case SoundSource::FM:
 			if (hasSetNoteDelay) {
@@ -482,6 +487,34 @@ void PlaybackManager::stepProcess()
 	isFindNextStep_ = isNextSet;
 }
 
+/// Read only effects which change playback speed or position
+void PlaybackManager::stepProcessDryRun()
+{
+	auto& song = mod_.lock()->getSong(curSongNum_);
+	for (auto& attrib : songStyle_.trackAttribs) {
+		// Decode effects without the pattern cache, which is owned by the live playback
+		Step& step = song.getTrack(attrib.number).getPatternFromOrderNumber(playingPos_.order).getStep(playingPos_.step);
+		for (int i = 0; i < Step::N_EFFECT; ++i) {
+			Effect eff = effect_utils::validateEffect(attrib.source, step.getEffect(i));
+			switch (eff.type) {
+			case EffectType::SpeedTempoChange:
+			case EffectType::Groove:
+				playbackSpeedEffMem_.enqueue(eff);
+				break;
+			case EffectType::PositionJump:
+			case EffectType::SongEnd:
+			case EffectType::PatternBreak:
+				posChangeEffMem_.enqueue(eff);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	isFindNextStep_ = executeStoredEffectsGlobal();
+}
+
 void PlaybackManager::executeFMStepEvents(const Step& step, int ch, bool calledByNoteDelay)
 {
 	if (!calledByNoteDelay && !step.isEmptyNote()) clearFMDelayBeyondStepCounts(ch);	// Except no key event
@@ -1435,11 +1468,10 @@ void PlaybackManager::tickProcess(int rest)
 
 		if (rest == 1 && nextReadPos_.isValid() && attrib.source == SoundSource::FM && !isPlayingStep()) {
 			// Channel envelope reset before next key on
-			auto& step = song.getTrack(attrib.number)
-						 .getPatternFromOrderNumber(nextReadPos_.order).getStep(nextReadPos_.step);
+			Pattern& nextPattern = song.getTrack(attrib.number).getPatternFromOrderNumber(nextReadPos_.order);
+			auto& step = nextPattern.getStep(nextReadPos_.step);
 			bool hasNoteDelay = false;
-			for (int i = 0; i < Step::N_EFFECT; ++i) {
-				auto&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(i));
+			for (const Effect& eff : nextPattern.getValidatedEffects(nextReadPos_.step, attrib.source)) {
 				if (eff.type == EffectType::NoteDelay && eff.value > 0) {	// Note delay check
 					opnaCtrl_->tickEvent(attrib.source, ch);
 					hasNoteDelay = true;
@@ -1740,574 +1772,509 @@ void PlaybackManager::setChannelRetrieving(bool enabled)
 
 void PlaybackManager::retrieveChannelStates()
 {
+	// Replay the latest settings found before the current step from the checkpoint of the current order,
+	// so that the states are retrieved by reading only the steps in the current order.
+	auto mod = mod_.lock();
+	Song& song = mod->getSong(curSongNum_);
+
+	std::vector<int> instTypes;
+	auto instMan = instMan_.lock();
+	for (int n : instMan->getInstrumentIndices()) {
+		instTypes.resize(static_cast<size_t>(n) + 1, -1);
+		instTypes[static_cast<size_t>(n)] = static_cast<int>(instMan->getInstrumentSharedPtr(n)->getType());
+	}
+	size_t grooveCnt = mod->getGrooveCount();
+	if (grooveCnt != checkpointGrooveCnt_ || instTypes != checkpointInstTypes_) {
+		checkpoints_.clear();
+		checkpointGrooveCnt_ = grooveCnt;
+		checkpointInstTypes_ = std::move(instTypes);
+	}
+
+	ChannelStateSnapshot snapshot = getChannelStateCheckpoint(song, playingPos_.order);
+	for (int step = 0; step < playingPos_.step; ++step) {
+		readStepToSnapshot(snapshot, song, playingPos_.order, step, true);
+	}
+	// Settings in the current step are not replayed but hide the previous ones
+	const uint64_t curStamp = (snapshot.readStepCount + 1) * songStyle_.trackAttribs.size() * 8;
+	readStepToSnapshot(snapshot, song, playingPos_.order, playingPos_.step, false);
+
+	// Collect settings to replay, the order of them is same as searching back from the current step
+	std::vector<std::pair<const RetrievedSetting*, size_t>> settings;	// Global setting types are offset
+	for (const auto& trackSettings : snapshot.trackSettings) {
+		for (size_t type = 0; type < N_RET_TRACK_SETTING; ++type) {
+			const RetrievedSetting& setting = trackSettings[type];
+			if (setting.stamp && setting.stamp < curStamp) settings.emplace_back(&setting, type);
+		}
+	}
+	auto& globals = snapshot.globalSettings;
+	for (size_t type = 0; type < N_RET_GLOBAL_SETTING; ++type) {
+		const RetrievedSetting& setting = globals[type];
+		if (!setting.stamp || curStamp <= setting.stamp) continue;
+		switch (type) {
+		case RetSpeed:
+		case RetTempo:
+			// Groove overrides speed and tempo set before it
+			if (globals[RetGroove].stamp > std::max(globals[RetSpeed].stamp, globals[RetTempo].stamp)) continue;
+			break;
+		case RetGroove:
+			if (setting.stamp < std::max(globals[RetSpeed].stamp, globals[RetTempo].stamp)) continue;
+			break;
+		default:
+			break;
+		}
+		settings.emplace_back(&setting, N_RET_TRACK_SETTING + type);
+	}
+	std::sort(settings.begin(), settings.end(), [](const auto& a, const auto& b) {
+		return a.first->stamp > b.first->stamp;
+	});
+
+	for (const auto& pair : settings) {
+		const RetrievedSetting& setting = *pair.first;
+		const TrackAttribute& attrib = songStyle_.trackAttribs[setting.track];
+		if (pair.second >= N_RET_TRACK_SETTING) {
+			replaySettingGlobal(pair.second - N_RET_TRACK_SETTING, attrib.channelInSource, setting.eff);
+			continue;
+		}
+		switch (attrib.source) {
+		case SoundSource::FM:		replaySettingFM(pair.second, attrib.channelInSource, setting.eff);		break;
+		case SoundSource::SSG:		replaySettingSSG(pair.second, attrib.channelInSource, setting.eff);		break;
+		case SoundSource::RHYTHM:	replaySettingRhythm(pair.second, attrib.channelInSource, setting.eff);	break;
+		case SoundSource::ADPCM:	replaySettingADPCM(pair.second, setting.eff);							break;
+		}
+	}
+
+	// Echo buffer
+	for (size_t t = 0; t < songStyle_.trackAttribs.size(); ++t) {
+		const TrackAttribute& attrib = songStyle_.trackAttribs[t];
+		switch (attrib.source) {
+		case SoundSource::FM:
+			opnaCtrl_->setEchoBufferFM(attrib.channelInSource, snapshot.echoBuffers[t]);
+			break;
+		case SoundSource::SSG:
+			opnaCtrl_->setEchoBufferSSG(attrib.channelInSource, snapshot.echoBuffers[t]);
+			break;
+		case SoundSource::ADPCM:
+			opnaCtrl_->setEchoBufferADPCM(snapshot.echoBuffers[t]);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Sequence reset
 	size_t fmch = Song::getFMChannelCount(songStyle_.type);
+	for (size_t ch = 0; ch < fmch; ++ch) {
+		opnaCtrl_->haltSequencesFM(static_cast<int>(ch));
+	}
+	for (size_t ch = 0; ch < 3; ++ch) {
+		opnaCtrl_->haltSequencesSSG(static_cast<int>(ch));
+	}
+	opnaCtrl_->haltSequencesADPCM();
+}
 
-	// Skip echo buffer due to takes time to search
-	std::vector<bool> isSetInstFM(fmch, false), isSetVolFM(fmch, false), isSetArpFM(fmch, false);
-	std::vector<bool> isSetPrtFM(fmch, false), isSetVibFM(fmch, false), isSetTreFM(fmch, false);
-	std::vector<bool> isSetPanFM(fmch, false), isSetVolSldFM(fmch, false), isSetDtnFM(fmch, false);
-	std::vector<bool> isSetFBCtrlFM(fmch, false), isSetTLCtrlFM(fmch, false), isSetMLCtrlFM(fmch, false);
-	std::vector<bool> isSetARCtrlFM(fmch, false), isSetDRCtrlFM(fmch, false), isSetRRCtrlFM(fmch, false);
-	std::vector<bool> isSetBrightFM(fmch, false), isSetFiDtnFM(fmch, false), isSetXVolSldFM(fmch, false);
-	std::vector<bool> isSetInstSSG(3, false), isSetVolSSG(3, false), isSetArpSSG(3, false), isSetPrtSSG(3, false);
-	std::vector<bool> isSetVibSSG(3, false), isSetTreSSG(3, false), isSetVolSldSSG(3, false), isSetDtnSSG(3, false);
-	std::vector<bool> isSetTNMixSSG(3, false), isSetFiDtnSSG(3, false), isSetXVolSldSSG(3, false);
-	std::vector<bool> isSetVolRhythm(6, false), isSetPanRhythm(6, false);
-	bool isSetInstADPCM(false), isSetVolADPCM(false), isSetArpADPCM(false), isSetPrtADPCM(false);
-	bool isSetVibADPCM(false), isSetTreADPCM(false), isSetPanADPCM(false), isSetVolSldADPCM(false);
-	bool isSetDtnADPCM(false), isSetFiDtnADPCM(false), isSetXVolSldADPCM(false);
-	bool isSetMVolRhythm = false;
-	bool isSetNoisePitchSSG = false;
-	bool isSetHardEnvPeriodHighSSG = false;
-	bool isSetHardEnvPeriodLowSSG = false;
-	bool isSetAutoEnvSSG = false;
-	/// bit0: step
-	/// bit1: tempo
-	/// bit2: groove
-	uint8_t speedStates = 0;
-
-	Position pos = playingPos_;
-	bool isPrevPos = false;
-	Song& song = mod_.lock()->getSong(curSongNum_);
+const PlaybackManager::ChannelStateSnapshot& PlaybackManager::getChannelStateCheckpoint(Song& song, int order)
+{
+	if (checkpoints_.empty()) {
+		ChannelStateCheckpoint ckpt;
+		ckpt.snapshot.trackSettings.resize(songStyle_.trackAttribs.size());
+		ckpt.snapshot.echoBuffers.resize(songStyle_.trackAttribs.size());
+		checkpoints_.push_back(std::move(ckpt));
+	}
 
-	while (true) {
-		for (auto it = songStyle_.trackAttribs.rbegin(), e = songStyle_.trackAttribs.rend(); it != e; ++it) {
-			Step& step = song.getTrack(it->number).getPatternFromOrderNumber(pos.order).getStep(pos.step);
-			int ch = it->channelInSource;
-			size_t uch = static_cast<size_t>(ch);
+	// Discard checkpoints after the edited order
+	size_t uorder = static_cast<size_t>(order);
+	for (size_t o = 1; o < checkpoints_.size() && o <= uorder; ++o) {
+		if (checkpoints_[o].prevOrderRevisions != getPatternRevisions(song, static_cast<int>(o) - 1)) {
+			checkpoints_.erase(checkpoints_.begin() + static_cast<std::ptrdiff_t>(o), checkpoints_.end());
+			break;
+		}
+	}
 
-			switch (it->source) {
-			case SoundSource::FM:
-			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolFM[uch] && step.hasVolume() && vol < bt_defs::NSTEP_FM_VOLUME) {
-					isSetVolFM[uch] = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeFM(ch, vol);
-				}
-				// Instrument
-				if (!isSetInstFM[uch] && step.hasInstrument()) {
-					if (auto inst = std::dynamic_pointer_cast<InstrumentFM>(
-								instMan_.lock()->getInstrumentSharedPtr(step.getInstrumentNumber()))) {
-						isSetInstFM[uch] = true;
-						if (isPrevPos)
-							opnaCtrl_->setInstrumentFM(ch, inst);
-					}
-				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::FM, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Arpeggio:
-						if (!isSetArpFM[uch]) {
-							isSetArpFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setArpeggioEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::PortamentoUp:
-						if (!isSetPrtFM[uch]) {
-							isSetPrtFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectFM(ch, eff.value);
-						}
-						break;
-					case EffectType::PortamentoDown:
-						if (!isSetPrtFM[uch]) {
-							isSetPrtFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectFM(ch, -eff.value);
-						}
-						break;
-					case EffectType::TonePortamento:
-						if (!isSetPrtFM[uch]) {
-							isSetPrtFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectFM(ch, eff.value, true);
-						}
-						break;
-					case EffectType::Vibrato:
-						if (!isSetVibFM[uch]) {
-							isSetVibFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setVibratoEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Tremolo:
-						if (!isSetTreFM[uch]) {
-							isSetTreFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setTremoloEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Pan:
-						if (-1 < eff.value && eff.value < 4 && !isSetPanFM[uch]) {
-							isSetPanFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPanFM(ch, eff.value);
-						}
-						break;
-					case EffectType::VolumeSlide:
-						if (!isSetVolSldFM[uch]) {
-							isSetVolSldFM[uch] = true;
-							if (isPrevPos) {
-								int hi = eff.value >> 4;
-								int low = eff.value & 0x0f;
-								if (hi && !low) opnaCtrl_->setVolumeSlideFM(ch, hi, true);	// Slide up
-								else if (!hi) opnaCtrl_->setVolumeSlideFM(ch, low, false);	// Slide down
-							}
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::Detune:
-						if (!isSetDtnFM[uch]) {
-							isSetDtnFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setDetuneFM(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::FineDetune:
-						if (!isSetFiDtnFM[uch]) {
-							isSetFiDtnFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setFineDetuneFM(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::FBControl:
-						if (!isSetFBCtrlFM[uch]) {
-							isSetFBCtrlFM[uch] = true;
-							if (isPrevPos) {
-								if (-1 < eff.value && eff.value < 8) opnaCtrl_->setFBControlFM(ch, eff.value);
-							}
-						}
-						break;
-					case EffectType::TLControl:
-						if (!isSetTLCtrlFM[uch]) {
-							isSetTLCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 8;
-								int val = eff.value & 0x00ff;
-								if (0 < op && op < 5 && -1 < val && val < 128)
-									opnaCtrl_->setTLControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::MLControl:
-						if (!isSetMLCtrlFM[uch]) {
-							isSetMLCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 4;
-								int val = eff.value & 0x0f;
-								if (0 < op && op < 5 && -1 < val && val < 16)
-									opnaCtrl_->setMLControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::ARControl:
-						if (!isSetARCtrlFM[uch]) {
-							isSetARCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 8;
-								int val = eff.value & 0x00ff;
-								if (0 < op && op < 5 && -1 < val && val < 32)
-									opnaCtrl_->setARControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::DRControl:
-						if (!isSetDRCtrlFM[uch]) {
-							isSetDRCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 8;
-								int val = eff.value & 0x00ff;
-								if (0 < op && op < 5 && -1 < val && val < 32)
-									opnaCtrl_->setDRControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::RRControl:
-						if (!isSetRRCtrlFM[uch]) {
-							isSetRRCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 4;
-								int val = eff.value & 0x0f;
-								if (0 < op && op < 5 && -1 < val && val < 16)
-									opnaCtrl_->setRRControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::Brightness:
-						if (!isSetBrightFM[uch]) {
-							isSetBrightFM[uch] = true;
-							if (isPrevPos) {
-								if (0 < eff.value) opnaCtrl_->setBrightnessFM(ch, eff.value - 0x80);
-							}
-						}
-						break;
-					case EffectType::XVolumeSlide:
-						if (!isSetXVolSldFM[uch]) {
-							isSetXVolSldFM[uch] = true;
-							if (isPrevPos) {
-								int factor = (eff.value >> 4) - (eff.value & 0x0f);
-								opnaCtrl_->setXVolumeSlideFM(ch, factor);
-							}
-						}
-						break;
-					default:
-						break;
-					}
-				}
+	while (checkpoints_.size() <= uorder) {
+		int prevOrder = static_cast<int>(checkpoints_.size()) - 1;
+		ChannelStateCheckpoint ckpt{ getPatternRevisions(song, prevOrder), checkpoints_.back().snapshot };
+		int size = static_cast<int>(getPatternSizeFromOrderNumber(curSongNum_, prevOrder));
+		for (int step = 0; step < size; ++step) {
+			readStepToSnapshot(ckpt.snapshot, song, prevOrder, step, true);
+		}
+		checkpoints_.push_back(std::move(ckpt));
+	}
+
+	return checkpoints_[uorder].snapshot;
+}
+
+std::vector<uint64_t> PlaybackManager::getPatternRevisions(Song& song, int order) const
+{
+	std::vector<uint64_t> revs;
+	revs.reserve(songStyle_.trackAttribs.size());
+	for (const auto& attrib : songStyle_.trackAttribs) {
+		revs.push_back(song.getTrack(attrib.number).getPatternFromOrderNumber(order).getRevision());
+	}
+	return revs;
+}
+
+void PlaybackManager::readStepToSnapshot(ChannelStateSnapshot& snapshot, Song& song, int order, int step, bool isPrevPos)
+{
+	// Stamps are numbered in reverse of the searching order from the current step:
+	// later steps, later tracks, volume, instrument and then effects from the last column
+	const size_t nTracks = songStyle_.trackAttribs.size();
+	const uint64_t stepStamp = (snapshot.readStepCount + 1) * nTracks * 8;
+	auto& globals = snapshot.globalSettings;
+
+	for (size_t t = 0; t < nTracks; ++t) {
+		const TrackAttribute& attrib = songStyle_.trackAttribs[t];
+		Pattern& pattern = song.getTrack(attrib.number).getPatternFromOrderNumber(order);
+		const Step& st = pattern.getStep(step);
+		const uint64_t trackStamp = stepStamp + t * 8;
+		auto& settings = snapshot.trackSettings[t];
+		auto update = [t](RetrievedSetting& setting, uint64_t stamp, const Effect& eff) {
+			setting.stamp = stamp;
+			setting.track = t;
+			setting.eff = eff;
+		};
+
+		// Effects
+		const Pattern::ValidatedEffects& effs = pattern.getValidatedEffects(step, attrib.source);
+		for (size_t i = 0; i < effs.size(); ++i) {
+			const Effect& eff = effs[i];
+			const uint64_t stamp = trackStamp + i;
+			switch (eff.type) {
+			case EffectType::Arpeggio:			update(settings[RetArpeggio], stamp, eff);		break;
+			case EffectType::PortamentoUp:
+			case EffectType::PortamentoDown:
+			case EffectType::TonePortamento:	update(settings[RetPortamento], stamp, eff);	break;
+			case EffectType::Vibrato:			update(settings[RetVibrato], stamp, eff);		break;
+			case EffectType::Tremolo:			update(settings[RetTremolo], stamp, eff);		break;
+			case EffectType::VolumeSlide:		update(settings[RetVolumeSlide], stamp, eff);	break;
+			case EffectType::Detune:			update(settings[RetDetune], stamp, eff);		break;
+			case EffectType::FineDetune:		update(settings[RetFineDetune], stamp, eff);	break;
+			case EffectType::FBControl:			update(settings[RetFBControl], stamp, eff);		break;
+			case EffectType::TLControl:			update(settings[RetTLControl], stamp, eff);		break;
+			case EffectType::MLControl:			update(settings[RetMLControl], stamp, eff);		break;
+			case EffectType::ARControl:			update(settings[RetARControl], stamp, eff);		break;
+			case EffectType::DRControl:			update(settings[RetDRControl], stamp, eff);		break;
+			case EffectType::RRControl:			update(settings[RetRRControl], stamp, eff);		break;
+			case EffectType::Brightness:		update(settings[RetBrightness], stamp, eff);	break;
+			case EffectType::XVolumeSlide:		update(settings[RetXVolumeSlide], stamp, eff);	break;
+			case EffectType::Pan:
+				if (-1 < eff.value && eff.value < 4) update(settings[RetPan], stamp, eff);
 				break;
-			}
-			case SoundSource::SSG:
-			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolSSG[uch] && step.hasVolume() && vol < bt_defs::NSTEP_SSG_VOLUME) {
-					isSetVolSSG[uch] = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeSSG(ch, vol);
-				}
-				// Instrument
-				if (!isSetInstSSG[uch] && step.hasInstrument()) {
-					if (auto inst = std::dynamic_pointer_cast<InstrumentSSG>(
-								instMan_.lock()->getInstrumentSharedPtr(step.getInstrumentNumber()))) {
-						isSetInstSSG[uch] = true;
-						if (isPrevPos)
-							opnaCtrl_->setInstrumentSSG(ch, inst);
-					}
-				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::SSG, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Arpeggio:
-						if (!isSetArpSSG[uch]) {
-							isSetArpSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setArpeggioEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::PortamentoUp:
-						if (!isSetPrtSSG[uch]) {
-							isSetPrtSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectSSG(ch, eff.value);
-						}
-						break;
-					case EffectType::PortamentoDown:
-						if (!isSetPrtSSG[uch]) {
-							isSetPrtSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectSSG(ch, -eff.value);
-						}
-						break;
-					case EffectType::TonePortamento:
-						if (!isSetPrtSSG[uch]) {
-							isSetPrtSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectSSG(ch, eff.value, true);
-						}
-						break;
-					case EffectType::Vibrato:
-						if (!isSetVibSSG[uch]) {
-							isSetVibSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setVibratoEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Tremolo:
-						if (!isSetTreSSG[uch]) {
-							isSetTreSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setTremoloEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::VolumeSlide:
-						if (!isSetVolSldSSG[uch]) {
-							isSetVolSldSSG[uch] = true;
-							if (isPrevPos) {
-								int hi = eff.value >> 4;
-								int low = eff.value & 0x0f;
-								if (hi && !low) opnaCtrl_->setVolumeSlideSSG(ch, hi, true);	// Slide up
-								else if (!hi) opnaCtrl_->setVolumeSlideSSG(ch, low, false);	// Slide down
-							}
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::Detune:
-						if (!isSetDtnSSG[uch]) {
-							isSetDtnSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setDetuneSSG(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::FineDetune:
-						if (!isSetFiDtnSSG[uch]) {
-							isSetFiDtnSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setFineDetuneSSG(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::ToneNoiseMix:
-						if (-1 < eff.value && eff.value < 4 && !isSetTNMixSSG[uch]) {
-							isSetTNMixSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setToneNoiseMixSSG(ch, eff.value);
-						}
-						break;
-					case EffectType::NoisePitch:
-						if (-1 < eff.value && eff.value < 32 && !isSetNoisePitchSSG) {
-							isSetNoisePitchSSG = true;
-							if (isPrevPos) opnaCtrl_->setNoisePitchSSG(ch, eff.value);
-						}
-						break;
-					case EffectType::HardEnvHighPeriod:
-						if (!isSetHardEnvPeriodHighSSG) {
-							isSetHardEnvPeriodHighSSG = true;
-							if (isPrevPos) opnaCtrl_->setHardEnvelopePeriod(ch, true, eff.value);
-						}
-						break;
-					case EffectType::HardEnvLowPeriod:
-						if (!isSetHardEnvPeriodLowSSG) {
-							isSetHardEnvPeriodLowSSG = true;
-							if (isPrevPos) opnaCtrl_->setHardEnvelopePeriod(ch, false, eff.value);
-						}
-						break;
-					case EffectType::AutoEnvelope:
-						if (!isSetAutoEnvSSG) {
-							isSetAutoEnvSSG = true;
-							if (isPrevPos) opnaCtrl_->setAutoEnvelopeSSG(ch, (eff.value >> 4) - 8, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::XVolumeSlide:
-						if (!isSetXVolSldSSG[uch]) {
-							isSetXVolSldSSG[uch] = true;
-							if (isPrevPos) {
-								int factor = (eff.value >> 4) - (eff.value & 0x0f);
-								opnaCtrl_->setXVolumeSlideSSG(ch, factor);
-							}
-						}
-						break;
-					default:
-						break;
-					}
-				}
+			case EffectType::ToneNoiseMix:
+				if (-1 < eff.value && eff.value < 4) update(settings[RetToneNoiseMix], stamp, eff);
 				break;
-			}
-			case SoundSource::RHYTHM:
-			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolRhythm[uch] && step.hasVolume() && vol < bt_defs::NSTEP_RHYTHM_VOLUME) {
-					isSetVolRhythm[uch] = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeRhythm(ch, vol);
-				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::RHYTHM, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Pan:
-						if (-1 < eff.value && eff.value < 4 && !isSetPanRhythm[uch]) {
-							isSetPanRhythm[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPanRhythm(ch, eff.value);
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::MasterVolume:
-						if (-1 < eff.value && eff.value < 64 && !isSetMVolRhythm) {
-							isSetMVolRhythm = true;
-							if (isPrevPos) opnaCtrl_->setMasterVolumeRhythm(eff.value);
-						}
-						break;
-					default:
-						break;
-					}
-				}
+			case EffectType::SpeedTempoChange:
+				update(globals[eff.value < 0x20 ? RetSpeed : RetTempo], stamp, eff);
 				break;
-			}
-			case SoundSource::ADPCM:
-			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolADPCM && step.hasVolume() && vol < bt_defs::NSTEP_ADPCM_VOLUME) {
-					isSetVolADPCM = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeADPCM(vol);
-				}
-				// Instrument
-				if (!isSetInstADPCM && step.hasInstrument()) {
-					if (auto inst = std::dynamic_pointer_cast<InstrumentADPCM>(
-								instMan_.lock()->getInstrumentSharedPtr(step.getInstrumentNumber()))) {
-						isSetInstADPCM = true;
-						if (isPrevPos)
-							opnaCtrl_->setInstrumentADPCM(inst);
-					}
-				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::ADPCM, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Arpeggio:
-						if (!isSetArpADPCM) {
-							isSetArpADPCM = true;
-							if (isPrevPos) opnaCtrl_->setArpeggioEffectADPCM(eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::PortamentoUp:
-						if (!isSetPrtADPCM) {
-							isSetPrtADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectADPCM(eff.value);
-						}
-						break;
-					case EffectType::PortamentoDown:
-						if (!isSetPrtADPCM) {
-							isSetPrtADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectADPCM(-eff.value);
-						}
-						break;
-					case EffectType::TonePortamento:
-						if (!isSetPrtADPCM) {
-							isSetPrtADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectADPCM(eff.value, true);
-						}
-						break;
-					case EffectType::Vibrato:
-						if (!isSetVibADPCM) {
-							isSetVibADPCM = true;
-							if (isPrevPos) opnaCtrl_->setVibratoEffectADPCM(eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Tremolo:
-						if (!isSetTreADPCM) {
-							isSetTreADPCM = true;
-							if (isPrevPos) opnaCtrl_->setTremoloEffectADPCM(eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Pan:
-						if (-1 < eff.value && eff.value < 4 && !isSetPanADPCM) {
-							isSetPanADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPanADPCM(eff.value);
-						}
-						break;
-					case EffectType::VolumeSlide:
-						if (!isSetVolSldADPCM) {
-							isSetVolSldADPCM = true;
-							if (isPrevPos) {
-								int hi = eff.value >> 4;
-								int low = eff.value & 0x0f;
-								if (hi && !low) opnaCtrl_->setVolumeSlideADPCM(hi, true);	// Slide up
-								else if (!hi) opnaCtrl_->setVolumeSlideADPCM(low, false);	// Slide down
-							}
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::Detune:
-						if (!isSetDtnADPCM) {
-							isSetDtnADPCM = true;
-							if (isPrevPos) opnaCtrl_->setDetuneADPCM(eff.value - 0x80);
-						}
-						break;
-					case EffectType::FineDetune:
-						if (!isSetFiDtnADPCM) {
-							isSetFiDtnADPCM = true;
-							if (isPrevPos) opnaCtrl_->setFineDetuneADPCM(eff.value - 0x80);
-						}
-						break;
-					case EffectType::XVolumeSlide:
-						if (!isSetXVolSldADPCM) {
-							isSetXVolSldADPCM = true;
-							if (isPrevPos) {
-								int factor = (eff.value >> 4) - (eff.value & 0x0f);
-								opnaCtrl_->setXVolumeSlideADPCM(factor);
-							}
-						}
-						break;
-					default:
-						break;
-					}
-				}
+			case EffectType::Groove:
+				if (eff.value < static_cast<int>(checkpointGrooveCnt_)) update(globals[RetGroove], stamp, eff);
+				break;
+			case EffectType::NoisePitch:
+				if (-1 < eff.value && eff.value < 32) update(globals[RetNoisePitch], stamp, eff);
+				break;
+			case EffectType::HardEnvHighPeriod:	update(globals[RetHardEnvHighPeriod], stamp, eff);	break;
+			case EffectType::HardEnvLowPeriod:	update(globals[RetHardEnvLowPeriod], stamp, eff);	break;
+			case EffectType::AutoEnvelope:		update(globals[RetAutoEnvelope], stamp, eff);		break;
+			case EffectType::MasterVolume:
+				if (-1 < eff.value && eff.value < 64) update(globals[RetMasterVolume], stamp, eff);
+				break;
+			default:
 				break;
 			}
+		}
+
+		// Instrument
+		if (st.hasInstrument()) {
+			size_t n = static_cast<size_t>(st.getInstrumentNumber());
+			int type = (n < checkpointInstTypes_.size()) ? checkpointInstTypes_[n] : -1;
+			bool isValid = false;
+			switch (attrib.source) {
+			case SoundSource::FM:		isValid = (type == static_cast<int>(InstrumentType::FM));		break;
+			case SoundSource::SSG:		isValid = (type == static_cast<int>(InstrumentType::SSG));		break;
+			case SoundSource::ADPCM:	isValid = (type == static_cast<int>(InstrumentType::ADPCM));	break;
+			default:	break;
 			}
+			if (isValid) update(settings[RetInstrument], trackStamp + 4, { EffectType::NoEffect, static_cast<int>(n) });
 		}
 
-		// Move position
-		isPrevPos = true;
-		if (--pos.step < 0) {
-			if (--pos.order < 0) break;
-			pos.step = static_cast<int>(getPatternSizeFromOrderNumber(curSongNum_, pos.order)) - 1;
+		// Volume
+		if (st.hasVolume()) {
+			int vol = st.getVolume();
+			int volLim = 0;
+			switch (attrib.source) {
+			case SoundSource::FM:		volLim = bt_defs::NSTEP_FM_VOLUME;		break;
+			case SoundSource::SSG:		volLim = bt_defs::NSTEP_SSG_VOLUME;		break;
+			case SoundSource::RHYTHM:	volLim = bt_defs::NSTEP_RHYTHM_VOLUME;	break;
+			case SoundSource::ADPCM:	volLim = bt_defs::NSTEP_ADPCM_VOLUME;	break;
+			}
+			if (vol < volLim) update(settings[RetVolume], trackStamp + 5, { EffectType::NoEffect, vol });
+		}
+
+		// Echo buffer
+		if (isPrevPos && attrib.source != SoundSource::RHYTHM) {
+			EchoBuffer& echoBuf = snapshot.echoBuffers[t];
+			int noteNum = st.getNoteNumber();
+			if (st.hasGeneralNote()) {
+				echoBuf.push(Note(noteNum));
+			}
+			else if (Step::NOTE_ECHO3 <= noteNum && noteNum <= Step::NOTE_ECHO0) {
+				size_t n = static_cast<size_t>(Step::NOTE_ECHO0 - noteNum);
+				if (n < echoBuf.size()) {
+					Note note = echoBuf[n];
+					echoBuf.push(note);
+				}
+			}
 		}
 	}
 
-	// Sequence reset
-	for (size_t ch = 0; ch < fmch; ++ch) {
-		opnaCtrl_->haltSequencesFM(static_cast<int>(ch));
+	++snapshot.readStepCount;
+}
+
+void PlaybackManager::replaySettingFM(size_t type, int ch, const Effect& eff)
+{
+	switch (type) {
+	case RetVolume:
+		opnaCtrl_->setVolumeFM(ch, eff.value);
+		break;
+	case RetInstrument:
+		if (auto inst = std::dynamic_pointer_cast<InstrumentFM>(instMan_.lock()->getInstrumentSharedPtr(eff.value)))
+			opnaCtrl_->setInstrumentFM(ch, inst);
+		break;
+	case RetArpeggio:
+		opnaCtrl_->setArpeggioEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetPortamento:
+		switch (eff.type) {
+		case EffectType::PortamentoUp:		opnaCtrl_->setPortamentoEffectFM(ch, eff.value);		break;
+		case EffectType::PortamentoDown:	opnaCtrl_->setPortamentoEffectFM(ch, -eff.value);		break;
+		case EffectType::TonePortamento:	opnaCtrl_->setPortamentoEffectFM(ch, eff.value, true);	break;
+		default:	break;
+		}
+		break;
+	case RetVibrato:
+		opnaCtrl_->setVibratoEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetTremolo:
+		opnaCtrl_->setTremoloEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetPan:
+		opnaCtrl_->setPanFM(ch, eff.value);
+		break;
+	case RetVolumeSlide:
+	{
+		int hi = eff.value >> 4;
+		int low = eff.value & 0x0f;
+		if (hi && !low) opnaCtrl_->setVolumeSlideFM(ch, hi, true);	// Slide up
+		else if (!hi) opnaCtrl_->setVolumeSlideFM(ch, low, false);	// Slide down
+		break;
 	}
-	for (size_t ch = 0; ch < 3; ++ch) {
-		opnaCtrl_->haltSequencesSSG(static_cast<int>(ch));
+	case RetDetune:
+		opnaCtrl_->setDetuneFM(ch, eff.value - 0x80);
+		break;
+	case RetFineDetune:
+		opnaCtrl_->setFineDetuneFM(ch, eff.value - 0x80);
+		break;
+	case RetFBControl:
+		if (-1 < eff.value && eff.value < 8) opnaCtrl_->setFBControlFM(ch, eff.value);
+		break;
+	case RetTLControl:
+	{
+		int op = eff.value >> 8;
+		int val = eff.value & 0x00ff;
+		if (0 < op && op < 5 && -1 < val && val < 128)
+			opnaCtrl_->setTLControlFM(ch, op - 1, val);
+		break;
+	}
+	case RetMLControl:
+	{
+		int op = eff.value >> 4;
+		int val = eff.value & 0x0f;
+		if (0 < op && op < 5 && -1 < val && val < 16)
+			opnaCtrl_->setMLControlFM(ch, op - 1, val);
+		break;
+	}
+	case RetARControl:
+	{
+		int op = eff.value >> 8;
+		int val = eff.value & 0x00ff;
+		if (0 < op && op < 5 && -1 < val && val < 32)
+			opnaCtrl_->setARControlFM(ch, op - 1, val);
+		break;
+	}
+	case RetDRControl:
+	{
+		int op = eff.value >> 8;
+		int val = eff.value & 0x00ff;
+		if (0 < op && op < 5 && -1 < val && val < 32)
+			opnaCtrl_->setDRControlFM(ch, op - 1, val);
+		break;
+	}
+	case RetRRControl:
+	{
+		int op = eff.value >> 4;
+		int val = eff.value & 0x0f;
+		if (0 < op && op < 5 && -1 < val && val < 16)
+			opnaCtrl_->setRRControlFM(ch, op - 1, val);
+		break;
+	}
+	case RetBrightness:
+		if (0 < eff.value) opnaCtrl_->setBrightnessFM(ch, eff.value - 0x80);
+		break;
+	case RetXVolumeSlide:
+		opnaCtrl_->setXVolumeSlideFM(ch, (eff.value >> 4) - (eff.value & 0x0f));
+		break;
+	default:
+		break;
+	}
+}
+
+void PlaybackManager::replaySettingSSG(size_t type, int ch, const Effect& eff)
+{
+	switch (type) {
+	case RetVolume:
+		opnaCtrl_->setVolumeSSG(ch, eff.value);
+		break;
+	case RetInstrument:
+		if (auto inst = std::dynamic_pointer_cast<InstrumentSSG>(instMan_.lock()->getInstrumentSharedPtr(eff.value)))
+			opnaCtrl_->setInstrumentSSG(ch, inst);
+		break;
+	case RetArpeggio:
+		opnaCtrl_->setArpeggioEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetPortamento:
+		switch (eff.type) {
+		case EffectType::PortamentoUp:		opnaCtrl_->setPortamentoEffectSSG(ch, eff.value);		break;
+		case EffectType::PortamentoDown:	opnaCtrl_->setPortamentoEffectSSG(ch, -eff.value);		break;
+		case EffectType::TonePortamento:	opnaCtrl_->setPortamentoEffectSSG(ch, eff.value, true);	break;
+		default:	break;
+		}
+		break;
+	case RetVibrato:
+		opnaCtrl_->setVibratoEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetTremolo:
+		opnaCtrl_->setTremoloEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetVolumeSlide:
+	{
+		int hi = eff.value >> 4;
+		int low = eff.value & 0x0f;
+		if (hi && !low) opnaCtrl_->setVolumeSlideSSG(ch, hi, true);	// Slide up
+		else if (!hi) opnaCtrl_->setVolumeSlideSSG(ch, low, false);	// Slide down
+		break;
+	}
+	case RetDetune:
+		opnaCtrl_->setDetuneSSG(ch, eff.value - 0x80);
+		break;
+	case RetFineDetune:
+		opnaCtrl_->setFineDetuneSSG(ch, eff.value - 0x80);
+		break;
+	case RetToneNoiseMix:
+		opnaCtrl_->setToneNoiseMixSSG(ch, eff.value);
+		break;
+	case RetXVolumeSlide:
+		opnaCtrl_->setXVolumeSlideSSG(ch, (eff.value >> 4) - (eff.value & 0x0f));
+		break;
+	default:
+		break;
+	}
+}
+
+void PlaybackManager::replaySettingRhythm(size_t type, int ch, const Effect& eff)
+{
+	switch (type) {
+	case RetVolume:
+		opnaCtrl_->setVolumeRhythm(ch, eff.value);
+		break;
+	case RetPan:
+		opnaCtrl_->setPanRhythm(ch, eff.value);
+		break;
+	default:
+		break;
+	}
+}
+
+void PlaybackManager::replaySettingADPCM(size_t type, const Effect& eff)
+{
+	switch (type) {
+	case RetVolume:
+		opnaCtrl_->setVolumeADPCM(eff.value);
+		break;
+	case RetInstrument:
+		if (auto inst = std::dynamic_pointer_cast<InstrumentADPCM>(instMan_.lock()->getInstrumentSharedPtr(eff.value)))
+			opnaCtrl_->setInstrumentADPCM(inst);
+		break;
+	case RetArpeggio:
+		opnaCtrl_->setArpeggioEffectADPCM(eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetPortamento:
+		switch (eff.type) {
+		case EffectType::PortamentoUp:		opnaCtrl_->setPortamentoEffectADPCM(eff.value);			break;
+		case EffectType::PortamentoDown:	opnaCtrl_->setPortamentoEffectADPCM(-eff.value);		break;
+		case EffectType::TonePortamento:	opnaCtrl_->setPortamentoEffectADPCM(eff.value, true);	break;
+		default:	break;
+		}
+		break;
+	case RetVibrato:
+		opnaCtrl_->setVibratoEffectADPCM(eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetTremolo:
+		opnaCtrl_->setTremoloEffectADPCM(eff.value >> 4, eff.value & 0x0f);
+		break;
+	case RetPan:
+		opnaCtrl_->setPanADPCM(eff.value);
+		break;
+	case RetVolumeSlide:
+	{
+		int hi = eff.value >> 4;
+		int low = eff.value & 0x0f;
+		if (hi && !low) opnaCtrl_->setVolumeSlideADPCM(hi, true);	// Slide up
+		else if (!hi) opnaCtrl_->setVolumeSlideADPCM(low, false);	// Slide down
+		break;
+	}
+	case RetDetune:
+		opnaCtrl_->setDetuneADPCM(eff.value - 0x80);
+		break;
+	case RetFineDetune:
+		opnaCtrl_->setFineDetuneADPCM(eff.value - 0x80);
+		break;
+	case RetXVolumeSlide:
+		opnaCtrl_->setXVolumeSlideADPCM((eff.value >> 4) - (eff.value & 0x0f));
+		break;
+	default:
+		break;
+	}
+}
+
+void PlaybackManager::replaySettingGlobal(size_t type, int ch, const Effect& eff)
+{
+	switch (type) {
+	case RetSpeed:
+		effSpeedChange(eff.value);
+		break;
+	case RetTempo:
+		effTempoChange(eff.value);
+		break;
+	case RetGroove:
+		effGrooveChange(eff.value);
+		break;
+	case RetNoisePitch:
+		opnaCtrl_->setNoisePitchSSG(ch, eff.value);
+		break;
+	case RetHardEnvHighPeriod:
+		opnaCtrl_->setHardEnvelopePeriod(ch, true, eff.value);
+		break;
+	case RetHardEnvLowPeriod:
+		opnaCtrl_->setHardEnvelopePeriod(ch, false, eff.value);
+		break;
+	case RetAutoEnvelope:
+		opnaCtrl_->setAutoEnvelopeSSG(ch, (eff.value >> 4) - 8, eff.value & 0x0f);
+		break;
+	case RetMasterVolume:
+		opnaCtrl_->setMasterVolumeRhythm(eff.value);
+		break;
+	default:
+		break;
 	}
-	opnaCtrl_->haltSequencesADPCM();
 }
 
 size_t PlaybackManager::getOrderSize(int songNum) const
@@ -26,11 +26,13 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
 #include "module.hpp"
 #include "effect.hpp"
+#include "echo_buffer.hpp"
 #include "enum_hash.hpp"
 #include "bamboo_tracker_defs.hpp"
 
@@ -69,6 +71,7 @@ private:
 class PlaybackManager
 {
 public:
+	/// Pass null \c opnaCtrl to make a dry-run manager which only runs position and speed logic.
 	PlaybackManager(std::shared_ptr<OPNAController> opnaCtrl,
 					std::weak_ptr<InstrumentsManager> instMan,
 					std::weak_ptr<TickCounter> tickCounter,
@@ -100,6 +103,7 @@ public:
 
 private:
 	std::shared_ptr<OPNAController> opnaCtrl_;
+	const bool isDryRun_;
 	std::weak_ptr<InstrumentsManager> instMan_;
 	std::weak_ptr<TickCounter> tickCounter_;
 	std::weak_ptr<Module> mod_;
@@ -134,6 +138,9 @@ private:
 	void checkValidPosition();
 
 	void stepProcess();
+	void stepProcessDryRun();
+	/// Steps of each track read in the current step process
+	std::vector<const Step*> playingSteps_;
 
 	void executeFMStepEvents(const Step& step, int ch, bool calledByNoteDelay = false);
 	void executeSSGStepEvents(const Step& step, int ch, bool calledByNoteDelay = false);
@@ -236,6 +243,53 @@ private:
 	bool isRetrieveChannel_;
 	void retrieveChannelStates();
 
+	enum RetrievedTrackSetting : size_t
+	{
+		RetVolume, RetInstrument, RetArpeggio, RetPortamento, RetVibrato, RetTremolo, RetPan,
+		RetVolumeSlide, RetDetune, RetFineDetune, RetFBControl, RetTLControl, RetMLControl,
+		RetARControl, RetDRControl, RetRRControl, RetBrightness, RetXVolumeSlide, RetToneNoiseMix,
+		N_RET_TRACK_SETTING
+	};
+	enum RetrievedGlobalSetting : size_t
+	{
+		RetSpeed, RetTempo, RetGroove, RetNoisePitch, RetHardEnvHighPeriod, RetHardEnvLowPeriod,
+		RetAutoEnvelope, RetMasterVolume, N_RET_GLOBAL_SETTING
+	};
+	/// Setting read from a step, which is replayed to retrieve channel states.
+	struct RetrievedSetting
+	{
+		/// Newer settings have larger stamps. 0 means that the setting has not been read.
+		uint64_t stamp = 0;
+		size_t track = 0;	///< Index of the track attributes.
+		Effect eff{ EffectType::NoEffect, 0 };	///< Volume and instrument number are stored in \c value.
+	};
+	/// Latest settings and echo buffers read from the song beginning to a step.
+	struct ChannelStateSnapshot
+	{
+		std::vector<std::array<RetrievedSetting, N_RET_TRACK_SETTING>> trackSettings;
+		std::array<RetrievedSetting, N_RET_GLOBAL_SETTING> globalSettings;
+		std::vector<EchoBuffer> echoBuffers;
+		uint64_t readStepCount = 0;
+	};
+	/// Snapshot at the beginning of an order.
+	struct ChannelStateCheckpoint
+	{
+		std::vector<uint64_t> prevOrderRevisions;	///< Pattern revisions in the previous order.
+		ChannelStateSnapshot snapshot;
+	};
+	/// Checkpoints of each order made lazily, discarded from the first order edited after made.
+	std::vector<ChannelStateCheckpoint> checkpoints_;
+	size_t checkpointGrooveCnt_;
+	std::vector<int> checkpointInstTypes_;
+	const ChannelStateSnapshot& getChannelStateCheckpoint(Song& song, int order);
+	std::vector<uint64_t> getPatternRevisions(Song& song, int order) const;
+	void readStepToSnapshot(ChannelStateSnapshot& snapshot, Song& song, int order, int step, bool isPrevPos);
+	void replaySettingFM(size_t type, int ch, const Effect& eff);
+	void replaySettingSSG(size_t type, int ch, const Effect& eff);
+	void replaySettingRhythm(size_t type, int ch, const Effect& eff);
+	void replaySettingADPCM(size_t type, const Effect& eff);
+	void replaySettingGlobal(size_t type, int ch, const Effect& eff);
+
 	size_t getOrderSize(int songNum) const;
 	size_t getPatternSizeFromOrderNumber(int songNum, int orderNum) const;
 };
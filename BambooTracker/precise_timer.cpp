@@ -24,7 +24,40 @@
  */
 
 #include "precise_timer.hpp"
-#include <chrono>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+constexpr int DEFAULT_SPIN_US = 500;
+
+void raiseCurrentThreadPriority()
+{
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+	// Fails without privilege, and the timer works in normal priority in that case
+	sched_param param {};
+	param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+	pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+}
+}
+
+PreciseTimer::PreciseTimer()
+	: isContinue_(false),
+	  periodNs_(1000000),
+	  periodDiv_(1),
+	  periodChanged_(false),
+	  isRealtime_(false),
+	  spin_(std::chrono::microseconds(DEFAULT_SPIN_US)),
+	  jitterSumUs_(0.)
+{
+}
 
 PreciseTimer::~PreciseTimer()
 {
@@ -38,18 +71,43 @@ void PreciseTimer::setFunction(std::function<void()> func)
 
 void PreciseTimer::setInterval(const int microsec)
 {
-	time_.store(microsec);
+	std::lock_guard<std::mutex> lock(mutex_);
+	periodNs_ = static_cast<uint64_t>(microsec) * 1000;
+	periodDiv_ = 1;
+	periodChanged_ = true;
+}
+
+void PreciseTimer::setFrequency(const uint32_t hz)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	periodNs_ = 1000000000;
+	periodDiv_ = hz;
+	periodChanged_ = true;
+}
+
+void PreciseTimer::setRealtimePriority(bool enabled)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	isRealtime_ = enabled;
+}
+
+void PreciseTimer::setSpinThreshold(const int microsec)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	spin_ = std::chrono::microseconds(microsec);
 }
 
 void PreciseTimer::start()
 {
+	if (isContinue_.load()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stats_ = Statistics();
+		jitterSumUs_ = 0.;
+	}
 	isContinue_.store(true);
-	thread_ = std::thread([&] {
-		while (isContinue_.load()) {
-			std::this_thread::sleep_for(std::chrono::microseconds(time_.load()));
-			func_();
-		}
-	});
+	thread_ = std::thread([&] { run(); });
 }
 
 void PreciseTimer::stop()
@@ -59,3 +117,94 @@ void PreciseTimer::stop()
 		thread_.join();
 	}
 }
+
+PreciseTimer::Statistics PreciseTimer::getStatistics() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
+
+void PreciseTimer::run()
+{
+	uint64_t periodNs, periodDiv;
+	std::chrono::nanoseconds spin;
+	auto loadSettings = [&] {
+		periodNs = periodNs_ ? periodNs_ : 1;
+		periodDiv = periodDiv_ ? periodDiv_ : 1;
+		spin = spin_;
+		periodChanged_ = false;
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		loadSettings();
+		if (isRealtime_) raiseCurrentThreadPriority();
+	}
+
+	// Deadline of the n-th tick is anchor + n * periodNs / periodDiv [ns].
+	// The anchor moves by whole periodNs so that the product does not overflow.
+	Clock::time_point anchor = Clock::now();
+	Clock::time_point last = anchor;
+	uint64_t n = 1;
+	auto deadlineOf = [&](uint64_t i) {
+		return anchor + std::chrono::nanoseconds(i * periodNs / periodDiv);
+	};
+
+	while (isContinue_.load()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (periodChanged_) {
+				// Continue from the last deadline in the new period
+				loadSettings();
+				anchor = last;
+				n = 1;
+			}
+			else {
+				spin = spin_;
+			}
+		}
+		while (n > periodDiv) {
+			anchor += std::chrono::nanoseconds(periodNs);
+			n -= periodDiv;
+		}
+
+		// Sleep until shortly before the deadline, and spin for the rest
+		const Clock::time_point deadline = deadlineOf(n);
+		if (deadline - Clock::now() > spin) std::this_thread::sleep_until(deadline - spin);
+		Clock::time_point now;
+		while ((now = Clock::now()) < deadline) std::this_thread::yield();
+		const Clock::duration lateness = now - deadline;
+
+		func_();
+		last = deadline;
+		++n;
+
+		// Deadlines which passed during the function
+		uint64_t skipped = 0;
+		now = Clock::now();
+		if (deadlineOf(n) <= now) {
+			auto elapsed = static_cast<uint64_t>(
+							   std::chrono::duration_cast<std::chrono::nanoseconds>(now - anchor).count());
+			uint64_t due = elapsed * periodDiv / periodNs + 1 - n;
+			if (due > MAX_CATCH_UP) {
+				skipped = due - MAX_CATCH_UP;
+				n += skipped;
+			}
+		}
+
+		record(lateness, skipped);
+	}
+}
+
+void PreciseTimer::record(Clock::duration lateness, uint64_t skipped)
+{
+	double us = std::chrono::duration<double, std::micro>(lateness).count();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	++stats_.ticks;
+	stats_.skipped += skipped;
+	jitterSumUs_ += us;
+	stats_.meanJitterUs = jitterSumUs_ / stats_.ticks;
+	if (stats_.maxJitterUs < us) stats_.maxJitterUs = us;
+	stats_.lastDriftUs = us;
+}
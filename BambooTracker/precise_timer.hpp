@@ -25,24 +25,69 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <atomic>
 #include <thread>
+#include <mutex>
+#include <chrono>
 
+/**
+ * @brief Calls a function on its own thread at absolute steady_clock deadlines.
+ *
+ * Deadlines are computed from the start time and the tick count, so neither
+ * the duration of the function nor oversleep of the OS accumulates as drift.
+ * The thread sleeps until shortly before each deadline and spins for the rest.
+ * Deadlines which passed while the function was running are caught up
+ * by calling it back-to-back up to MAX_CATCH_UP times, and the rest are skipped.
+ */
 class PreciseTimer
 {
 public:
+	struct Statistics
+	{
+		uint64_t ticks = 0;			// Number of calls.
+		uint64_t skipped = 0;		// Number of skipped deadlines.
+		double meanJitterUs = 0.;	// Mean of absolute lateness.
+		double maxJitterUs = 0.;	// Maximum lateness.
+		double lastDriftUs = 0.;	// Lateness of the last call.
+	};
+
+	PreciseTimer();
 	~PreciseTimer();
 
 	void setFunction(std::function<void()> func);
 	void setInterval(const int microsec);
+	/// Set the period to exactly 1/hz second.
+	void setFrequency(const uint32_t hz);
+	/// Raise the priority of the timer thread from the next start.
+	void setRealtimePriority(bool enabled);
+	/// Set the length spun instead of slept before each deadline.
+	void setSpinThreshold(const int microsec);
 
 	void start();
 	void stop();
 
+	Statistics getStatistics() const;
+
+	static constexpr int MAX_CATCH_UP = 4;
+
 private:
-	std::atomic_int time_;
+	using Clock = std::chrono::steady_clock;
+
 	std::function<void()> func_;
 	std::thread thread_;
 	std::atomic_bool isContinue_;
+
+	mutable std::mutex mutex_;
+	// Period is periodNs_ / periodDiv_ nanoseconds
+	uint64_t periodNs_, periodDiv_;
+	bool periodChanged_;
+	bool isRealtime_;
+	std::chrono::nanoseconds spin_;
+	Statistics stats_;
+	double jitterSumUs_;
+
+	void run();
+	void record(Clock::duration lateness, uint64_t skipped);
 };
@@ -24,189 +24,107 @@
  */
 
 #include "song_length_calculator.hpp"
-#include <unordered_set>
-#include <unordered_map>
 #include <utility>
-#include <vector>
 #include "module.hpp"
-#include "effect.hpp"
-#include "enum_hash.hpp"
+#include "playback.hpp"
+#include "tick_counter.hpp"
 
-namespace
+double SongPlaybackTiming::ticksToSecond(size_t ticks) const
 {
-inline double calculateStrictStepTicks(int rate, int tempo, int speed)
-{
-	return 2.5 * rate * speed / tempo;
+	return static_cast<double>(ticks) / tickRate;
 }
+
+size_t SongPlaybackTiming::ticksToSamples(size_t ticks, uint32_t sampleRate) const
+{
+	// Same accumulation of fractional interrupt counts as the exporters
+	double dblIntrCnt = static_cast<double>(sampleRate) / static_cast<double>(tickRate);
+	size_t intrCnt = static_cast<size_t>(dblIntrCnt);
+	double intrCntDiff = dblIntrCnt - intrCnt;
+	double intrCntRest = 0;
+	size_t samples = 0;
+	for (size_t i = 0; i < ticks; ++i) {
+		intrCntRest += intrCntDiff;
+		size_t extraIntrCnt = static_cast<size_t>(intrCntRest);
+		intrCntRest -= extraIntrCnt;
+		samples += intrCnt + extraIntrCnt;
+	}
+	return samples;
 }
 
-SongLengthCalculator::SongLengthCalculator(Module& mod, int songNum)
+SongLengthCalculator::SongLengthCalculator(std::shared_ptr<Module> mod, int songNum)
 	: mod_(mod), songNum_(songNum)
 {
 }
 
-double SongLengthCalculator::approximateLengthBySecond() const
+SongPlaybackTiming SongLengthCalculator::calculateTiming(size_t loopCnt) const
 {
-	Song& song = mod_.getSong(songNum_);
-	std::unordered_set<int> visitedOrder;
-	double tickCnt = 0.;
-
-	const int rate = static_cast<int>(mod_.getTickFrequency());
-	int tempo = song.getTempo();
-	int speed = song.getSpeed();
-	std::vector<int> groove = mod_.getGroove(song.getGroove());
-	double stepTicks = calculateStrictStepTicks(rate, tempo, speed);
-	size_t grooveIdx = 0;
-	bool isTempo = song.isUsedTempo();
-
-	std::vector<TrackAttribute> attribs = song.getTrackAttributes();
-	int orderNum = 0;
-	int stepNum = 0;
-	int maxOrder = static_cast<int>(song.getOrderSize());
-
-	while (!visitedOrder.count(orderNum)) {
-		visitedOrder.insert(orderNum);
-
-		int maxStep = static_cast<int>(song.getPatternSizeFromOrderNumber(orderNum));
-		std::unordered_map<EffectType, int> jumpEffMap;
-		for (; stepNum < maxStep; ++stepNum) {
-			std::unordered_map<EffectType, int> speedEffMap;
-			// Load effects
-			for (const TrackAttribute& attrib : attribs) {
-				Step& step = song.getTrack(attrib.number).getPatternFromOrderNumber(orderNum).getStep(stepNum);
-				for (int e = 0; e < Step::N_EFFECT; ++e) {
-					const Effect&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(e));
-					switch (eff.type) {
-					case EffectType::SpeedTempoChange:
-					case EffectType::Groove:
-						speedEffMap[eff.type] = eff.value;
-						break;
-					case EffectType::PositionJump:
-					case EffectType::SongEnd:
-					case EffectType::PatternBreak:
-						if (stepNum == maxStep - 1) jumpEffMap[eff.type] = eff.value;	// Read only last step
-						break;
-					default:
-						break;
-					}
-				}
-			}
-
-			// Update playback state
-			auto&& it = speedEffMap.find(EffectType::SpeedTempoChange);
-			if (it != speedEffMap.end()) {
-				if (it->second < 0x20) {
-					if (speed != it->second) {
-						speed = it->second;
-						isTempo = true;
-						stepTicks = calculateStrictStepTicks(rate, tempo, speed);
-					}
-				}
-				else if (tempo != it->second) {
-					tempo = it->second;
-					isTempo = true;
-					stepTicks = calculateStrictStepTicks(rate, tempo, speed);
-				}
-			}
-			for (const auto& eff : speedEffMap) {
-				switch (eff.first) {
-				case EffectType::Groove:
-					if (eff.second < static_cast<int>(mod_.getGrooveCount())) {
-						groove = mod_.getGroove(eff.second);
-						isTempo = false;
-						grooveIdx = 0;
-					}
-					break;
-				default:
-					break;
-				}
-			}
+	SongPlaybackTiming timing;
+	timing.tickRate = mod_->getTickFrequency();
+	timing.loopOrder = -1;
+	timing.loopStep = -1;
+
+	// Playback manager without OPNA controller only runs position and speed logic
+	auto tickCounter = std::make_shared<TickCounter>();
+	tickCounter->setInterruptRate(timing.tickRate);
+	PlaybackManager playback(nullptr, std::weak_ptr<InstrumentsManager>(), tickCounter, mod_, false);
+	playback.setSong(mod_, songNum_);
+
+	// Tick and step counts when each position is reached first
+	Song& song = mod_->getSong(songNum_);
+	size_t orderCnt = song.getOrderSize();
+	std::vector<std::vector<std::pair<size_t, size_t>>> arrivals(orderCnt);
+	for (size_t i = 0; i < orderCnt; ++i) {
+		arrivals[i].assign(song.getPatternSizeFromOrderNumber(static_cast<int>(i)),
+						   { SongPlaybackTiming::NOT_REACHED, 0 });
+	}
+	timing.orderTicks.assign(orderCnt, SongPlaybackTiming::NOT_REACHED);
+
+	size_t tickCnt = 0;
+	size_t stepCnt = 0;
+	size_t loopPassCnt = 0;
+	playback.startPlayFromStart();
+	for (; ; ++tickCnt) {
+		if (playback.streamCountUp()) continue;	// Not head of step
+
+		int order = playback.getPlayingOrderNumber();
+		int step = playback.getPlayingStepNumber();
+		if (order == -1 && step == -1) {	// Song end
+			timing.introTicks = tickCnt;
+			timing.introSteps = stepCnt;
+			break;
+		}
 
-			// Add step ticks
-			if (isTempo) {
-				tickCnt += stepTicks;
+		if (!timing.hasLoop()) {
+			auto& arrival = arrivals.at(static_cast<size_t>(order)).at(static_cast<size_t>(step));
+			if (arrival.first == SongPlaybackTiming::NOT_REACHED) {
+				arrival = std::make_pair(tickCnt, stepCnt);
+				size_t& orderTick = timing.orderTicks[static_cast<size_t>(order)];
+				if (orderTick == SongPlaybackTiming::NOT_REACHED) orderTick = tickCnt;
 			}
-			else {
-				tickCnt += groove[grooveIdx];
-				++grooveIdx %= groove.size();
+			else {	// The first revisited position is the loop point
+				timing.loopOrder = order;
+				timing.loopStep = step;
+				timing.introTicks = arrival.first;
+				timing.introSteps = arrival.second;
 			}
 		}
-
-		// Update order position
-		++orderNum %= maxOrder;
-		stepNum = 0;
-		for (auto eff : jumpEffMap) {
-			switch (eff.first) {
-			case EffectType::PositionJump:
-				if (eff.second < maxOrder) {
-					orderNum = eff.second;
-				}
-				break;
-			case EffectType::SongEnd:
-				orderNum = 0;	// To break order loop
-				break;
-			case EffectType::PatternBreak:
-				if (eff.second < static_cast<int>(song.getPatternSizeFromOrderNumber(orderNum))) {
-					stepNum = eff.second;
-				}
-				break;
-			default:
-				break;
-			}
+		if (timing.hasLoop() && order == timing.loopOrder && step == timing.loopStep
+				&& ++loopPassCnt >= loopCnt) {
+			break;
 		}
-	}
-
-	// Calculate time by seconds
-	return tickCnt / rate;
-}
 
-void SongLengthCalculator::totalStepCount(size_t &introSize, size_t &loopSize) const
-{
-	Song& song = mod_.getSong(songNum_);
-	std::vector<TrackAttribute> attribs = song.getTrackAttributes();
-	size_t totalStepCnt = 0;
-	std::unordered_map<int, size_t> stepCntLogMap;
-	int lastOrder = static_cast<int>(song.getOrderSize()) - 1;
-	int curOrder = 0;
-
-	for (int curStep = 0; !stepCntLogMap.count(curOrder); ) {
-		// Count up
-		size_t ptnFullSize = song.getPatternSizeFromOrderNumber(curOrder);
-		stepCntLogMap[curOrder] = totalStepCnt;
-		totalStepCnt += (ptnFullSize - curStep);
+		++stepCnt;
+	}
+	playback.stopPlaySong();
 
-		// Check next order position
-		const int odr = std::exchange(curOrder, (curOrder + 1) % (lastOrder + 1));
-		curStep = 0;
-		for (const auto& attrib : attribs) {
-			const Step& step = song.getTrack(attrib.number)
-							   .getPatternFromOrderNumber(odr).getStep(ptnFullSize - 1);
-			for (int i = 0; i < Step::N_EFFECT; ++i) {
-				Effect&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(i));
-				switch (eff.type) {
-				case EffectType::PositionJump:
-					if (eff.value <= lastOrder) {
-						curOrder = eff.value;
-						curStep = 0;
-					}
-					break;
-				case EffectType::SongEnd:	// No loop
-					introSize = totalStepCnt;
-					loopSize = 0;
-					return;
-				case EffectType::PatternBreak:
-					if (eff.value < static_cast<int>(song.getPatternSizeFromOrderNumber(curOrder))) {
-						curStep = eff.value;
-					}
-					break;
-				default:
-					break;
-				}
-			}
-		}
+	if (timing.hasLoop() && !loopCnt) {
+		timing.totalTicks = timing.introTicks;
+		timing.totalSteps = timing.introSteps;
+	}
+	else {
+		timing.totalTicks = tickCnt;
+		timing.totalSteps = stepCnt;
 	}
 
-	// Calculate counts
-	introSize = stepCntLogMap[curOrder];
-	loopSize = totalStepCnt - introSize;
+	return timing;
 }
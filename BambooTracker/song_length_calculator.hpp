@@ -26,17 +26,42 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
 
 class Module;
 
+/// Playback timing measured by running the sequencer without chip output.
+struct SongPlaybackTiming
+{
+	static constexpr size_t NOT_REACHED = std::numeric_limits<size_t>::max();
+
+	uint32_t tickRate;
+	/// Position where the song loops, -1 if the song ends by the song end effect
+	int loopOrder, loopStep;
+	/// Ticks and steps played before the loop position is reached (whole song if no loop)
+	size_t introTicks, introSteps;
+	/// Ticks and steps played until the requested loop count is reached
+	size_t totalTicks, totalSteps;
+	/// Tick when each order is reached first, or NOT_REACHED
+	std::vector<size_t> orderTicks;
+
+	bool hasLoop() const noexcept { return loopOrder != -1; }
+	double ticksToSecond(size_t ticks) const;
+	/// Sample count which the VGM and S98 exporters elapse in the given ticks
+	size_t ticksToSamples(size_t ticks, uint32_t sampleRate) const;
+};
+
 class SongLengthCalculator
 {
 public:
-	SongLengthCalculator(Module& mod, int songNum);
-	double approximateLengthBySecond() const;
-	void totalStepCount(size_t& introSize, size_t& loopSize) const;
+	SongLengthCalculator(std::shared_ptr<Module> mod, int songNum);
+	/// Run the playback logic until the song ends or passes the loop position \c loopCnt times.
+	SongPlaybackTiming calculateTiming(size_t loopCnt) const;
 
 private:
-	Module& mod_;
+	std::shared_ptr<Module> mod_;
 	const int songNum_;
 };
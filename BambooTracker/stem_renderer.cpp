@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "stem_renderer.hpp"
+#include <algorithm>
+#include "io/wav_container.hpp"
+
+StemRenderer::StemRenderer(std::unique_ptr<chip::OPNA> chip, SongType type, const std::vector<TrackAttribute>& attribs)
+	: chip_(std::move(chip)),
+	  fmSlotMasks_{},
+	  ssgMask_(0),
+	  rhythmMask_(0),
+	  hasAdpcm_(false)
+{
+	for (const TrackAttribute& attrib : attribs) {
+		int ch = attrib.channelInSource;
+		switch (attrib.source) {
+		case SoundSource::FM:
+		{
+			uint8_t slotMask = 0xf;
+			if (type == SongType::FM3chExpanded) {
+				// FM3-OP1 to OP4 are tracks 2, 6, 7 and 8
+				switch (ch) {
+				case 2:	slotMask = 0x1;	break;
+				case 6:	slotMask = 0x2;	ch = 2;	break;
+				case 7:	slotMask = 0x4;	ch = 2;	break;
+				case 8:	slotMask = 0x8;	ch = 2;	break;
+				default:	break;
+				}
+			}
+			fmSlotMasks_[ch] |= slotMask;
+			break;
+		}
+		case SoundSource::SSG:		ssgMask_ |= static_cast<uint8_t>(1 << ch);		break;
+		case SoundSource::RHYTHM:	rhythmMask_ |= static_cast<uint8_t>(1 << ch);	break;
+		case SoundSource::ADPCM:	hasAdpcm_ = true;								break;
+		}
+	}
+}
+
+bool StemRenderer::render(const RegisterEvents& events, size_t length,
+						  io::WavContainer& container, const std::atomic_bool& isCanceled)
+{
+	auto write = [&](const chip::RegisterEventLogger::Event& event) {
+		uint8_t value = event.value;
+		if (filter(event.offset, value)) {
+			chip_->setImmediateWriteMode(event.isImmediate);
+			chip_->setRegister(event.offset, value);
+		}
+	};
+	size_t i = 0;
+
+	const size_t bufSize = static_cast<size_t>(chip_->getRate()) * chip_->getMaxDuration() / 1000;
+	std::vector<int16_t> buf(bufSize << 1);
+	size_t pos = 0;
+	size_t bufRest = bufSize;	// Split samples as BambooTracker::exportToWav does
+	while (pos < length) {
+		if (isCanceled) return false;
+
+		for (; i < events.size() && events[i].sample <= pos; ++i) write(events[i]);
+
+		size_t next = (i < events.size()) ? std::min(events[i].sample, length) : length;
+		size_t count = std::min(next - pos, bufRest);
+		if (!chip_->mix(buf.data(), count)) return false;
+		container.appendSample(buf.data(), count);
+		pos += count;
+		if (!(bufRest -= count)) bufRest = bufSize;
+	}
+
+	return true;
+}
+
+bool StemRenderer::filter(uint32_t offset, uint8_t& value) const
+{
+	switch (offset) {
+	case 0x28:	// FM key on/off
+	{
+		int ch = (value & 4) ? (value & 3) + 3 : (value & 3);
+		uint8_t slotMask = ((value & 3) != 3) ? fmSlotMasks_[ch] : 0;
+		value &= static_cast<uint8_t>((slotMask << 4) | 0x0f);
+		return true;
+	}
+	case 0x08:	// SSG volume
+	case 0x09:
+	case 0x0a:
+		if (!(ssgMask_ & (1 << (offset - 0x08)))) value = 0;
+		return true;
+	case 0x10:	// Rhythm key on/off
+		if (value & 0x80) return true;
+		value &= rhythmMask_;
+		return value != 0;
+	case 0x100:	// ADPCM control
+		if (!hasAdpcm_) value &= 0x7f;
+		return true;
+	default:
+		return true;
+	}
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "song.hpp"
+#include "chip/opna.hpp"
+#include "chip/register_write_logger.hpp"
+
+namespace io
+{
+class WavContainer;
+}
+
+/**
+ * @brief Renders some tracks by replaying the register writes of the whole song.
+ *
+ * Key-on and volume writes of the other tracks are masked before they reach the chip,
+ * so the chip sounds only the given tracks.
+ */
+class StemRenderer
+{
+public:
+	using RegisterEvents = std::vector<chip::RegisterEventLogger::Event>;
+
+	StemRenderer(std::unique_ptr<chip::OPNA> chip, SongType type, const std::vector<TrackAttribute>& attribs);
+
+	/**
+	 * @brief Render the track.
+	 * @param events Register writes in order of time.
+	 * @param length The number of samples to render.
+	 * @return false if rendering fails or is canceled.
+	 */
+	bool render(const RegisterEvents& events, size_t length,
+				io::WavContainer& container, const std::atomic_bool& isCanceled);
+
+private:
+	std::unique_ptr<chip::OPNA> chip_;
+	uint8_t fmSlotMasks_[6];	// FM operators keyed on by the tracks, by channel number in register
+	uint8_t ssgMask_, rhythmMask_;
+	bool hasAdpcm_;
+
+	bool filter(uint32_t offset, uint8_t& value) const;
+};
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+WorkerPool::WorkerPool(size_t threadCount)
+	: threadCount_(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+bool WorkerPool::run(size_t jobCount, const JobFunction& job, const std::function<bool()>& checkFunc,
+					 const std::function<void(size_t)>& progressFunc) const
+{
+	std::atomic_size_t next(0);
+	std::atomic_bool isCanceled(false);
+	size_t finished = 0;
+	std::mutex mutex;
+	std::condition_variable cv;
+
+	auto work = [&] {
+		for (size_t i = next++; i < jobCount; i = next++) {
+			if (!isCanceled) job(i, isCanceled);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				++finished;
+			}
+			cv.notify_one();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	size_t nThreads = std::min(threadCount_, jobCount);
+	for (size_t i = 0; i < nThreads; ++i) workers.emplace_back(work);
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		size_t reported = 0;
+		while (!cv.wait_for(lock, std::chrono::milliseconds(50), [&] { return finished == jobCount; })) {
+			size_t cnt = finished;
+			lock.unlock();
+			if (progressFunc && cnt != reported) progressFunc(reported = cnt);
+			if (checkFunc && checkFunc()) isCanceled = true;
+			lock.lock();
+		}
+	}
+	for (auto& worker : workers) worker.join();
+	if (progressFunc) progressFunc(jobCount);
+
+	return !isCanceled;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 BambooTracker contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Runs independent jobs on worker threads.
+ *
+ * The calling thread only waits for the jobs and polls the callbacks,
+ * so callbacks which touch the GUI stay on the GUI thread.
+ */
+class WorkerPool
+{
+public:
+	/// Called on a worker thread with the job index and the cancellation flag.
+	using JobFunction = std::function<void(size_t, const std::atomic_bool&)>;
+
+	/// @param threadCount The number of worker threads. 0 uses the number of hardware threads.
+	explicit WorkerPool(size_t threadCount = 0);
+
+	size_t getThreadCount() const noexcept { return threadCount_; }
+
+	/**
+	 * @brief Run jobs 0 to @p jobCount - 1 and wait for them.
+	 * @param checkFunc Called periodically on the calling thread. Return true to cancel the jobs.
+	 * @param progressFunc Called on the calling thread with the number of finished jobs.
+	 * @return false if the jobs were canceled.
+	 */
+	bool run(size_t jobCount, const JobFunction& job, const std::function<bool()>& checkFunc,
+			 const std::function<void(size_t)>& progressFunc = nullptr) const;
+
+private:
+	size_t threadCount_;
+};